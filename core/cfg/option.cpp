@@ -25,6 +25,8 @@ namespace config {
 // Dynarec
 
 Option<bool> DynarecEnabled("Dynarec.Enabled", true);
+Option<bool> DynarecIdleSkip("Dynarec.IdleSkip", true);
+Option<bool> DynarecPerfMap("Dynarec.PerfMap");
 Option<int> Sh4Clock("Sh4Clock", 200);
 
 // General
@@ -56,6 +58,8 @@ Option<bool> AutoLatency("aica.AutoLatency",
 		false
 #endif
 		);
+Option<bool> AudioDynamicRate("aica.DynamicRate", false);
+Option<int> AudioTargetLatency("aica.TargetLatency", 50);
 
 OptionString AudioBackend("backend", "auto", "audio");
 AudioVolumeOption AudioVolume;
@@ -69,10 +73,12 @@ Option<bool> Widescreen("rend.WideScreen");
 Option<bool> SuperWidescreen("rend.SuperWideScreen");
 Option<bool> ShowFPS("rend.ShowFPS");
 Option<bool> RenderToTextureBuffer("rend.RenderToTextureBuffer");
+Option<int> ReadbackLatency("rend.ReadbackLatency", 0);
 Option<bool> TranslucentPolygonDepthMask("rend.TranslucentPolygonDepthMask");
 Option<bool> ModifierVolumes("rend.ModifierVolumes", true);
 Option<int> TextureUpscale("rend.TextureUpscale", 1);
 Option<int> MaxFilteredTextureSize("rend.MaxFilteredTextureSize", 256);
+Option<int> TextureCacheBudget("rend.TextureCacheBudget", 1024);
 Option<float> ExtraDepthScale("rend.ExtraDepthScale", 1.f);
 Option<bool> CustomTextures("rend.CustomTextures");
 Option<bool> DumpTextures("rend.DumpTextures");
@@ -107,6 +113,8 @@ Option<bool> DupeFrames("rend.DupeFrames", false);
 Option<int> PerPixelLayers("rend.PerPixelLayers", 32);
 Option<bool> NativeDepthInterpolation("rend.NativeDepthInterpolation", false);
 Option<bool> EmulateFramebuffer("rend.EmulateFramebuffer", false);
+Option<bool> AsyncPipelines("rend.AsyncPipelines", false);
+Option<bool> BulkVramTracking("rend.BulkVramTracking", false);
 #ifdef VIDEO_ROUTING
 Option<bool, false> VideoRouting("rend.VideoRouting", false);
 Option<bool, false> VideoRoutingScale("rend.VideoRoutingScale", false);
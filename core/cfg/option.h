@@ -356,6 +356,8 @@ using OptionString = Option<std::string>;
 // Dynarec
 
 extern Option<bool> DynarecEnabled;
+extern Option<bool> DynarecIdleSkip;
+extern Option<bool> DynarecPerfMap;
 #ifndef LIBRETRO
 extern Option<int> Sh4Clock;
 #endif
@@ -380,6 +382,8 @@ constexpr bool LimitFPS = true;
 extern Option<bool> DSPEnabled;
 extern Option<int> AudioBufferSize;	//In samples ,*4 for bytes
 extern Option<bool> AutoLatency;
+extern Option<bool> AudioDynamicRate;
+extern Option<int> AudioTargetLatency;	// in ms
 
 extern OptionString AudioBackend;
 
@@ -437,6 +441,7 @@ extern Option<bool> Widescreen;
 extern Option<bool> SuperWidescreen;
 extern Option<bool> ShowFPS;
 extern Option<bool> RenderToTextureBuffer;
+extern Option<int> ReadbackLatency;	// frames, 0 for synchronous readbacks
 extern Option<bool> TranslucentPolygonDepthMask;
 extern Option<bool> ModifierVolumes;
 constexpr bool Clipping = true;
@@ -445,6 +450,7 @@ extern Option<int> TextureUpscale;
 extern Option<int> MaxFilteredTextureSize;
 extern Option<int> PerPixelLayers;
 #endif
+extern Option<int> TextureCacheBudget;	// MB, 0 for no limit
 extern Option<float> ExtraDepthScale;
 extern Option<bool> CustomTextures;
 extern Option<bool> DumpTextures;
@@ -469,6 +475,8 @@ extern Option<bool> ThreadedRendering;
 extern Option<bool> DupeFrames;
 extern Option<bool> NativeDepthInterpolation;
 extern Option<bool> EmulateFramebuffer;
+extern Option<bool> AsyncPipelines;
+extern Option<bool> BulkVramTracking;
 #ifdef VIDEO_ROUTING
 extern Option<bool, false> VideoRouting;
 extern Option<bool, false> VideoRoutingScale;
@@ -84,6 +84,7 @@ uint32_t pico_timer_add(pico_time expire, void (*timer)(pico_time, void *), void
 uint32_t pico_timer_add_hashed(pico_time expire, void (*timer)(pico_time, void *), void *arg, uint32_t hash);
 void pico_timer_cancel_hashed(uint32_t hash);
 void pico_timer_cancel(uint32_t id);
+int32_t pico_timer_next_expire(void);
 uint32_t pico_rand(void);
 void pico_rand_feed(uint32_t feed);
 void pico_to_lowercase(char *str);
@@ -619,6 +619,25 @@ static void pico_check_timers(void)
     }
 }
 
+/* Returns the number of ms until the next timer expires, or -1 if there is no timer. */
+int32_t pico_timer_next_expire(void)
+{
+    struct pico_timer_ref *tref = heap_first(Timers);
+    pico_time now;
+    if (!tref)
+        return -1;
+
+    now = PICO_TIME_MS();
+    /* timers only fire once their expiration time is in the past */
+    if (tref->expire < now)
+        return 0;
+
+    if (tref->expire - now >= 0x7fffffff)
+        return 0x7fffffff;
+
+    return (int32_t)(tref->expire - now + 1);
+}
+
 void MOCKABLE pico_timer_cancel(uint32_t id)
 {
     uint32_t i;
@@ -42,7 +42,9 @@
 #include "serialize.h"
 #include "hw/pvr/pvr.h"
 #include "profiler/fc_profiler.h"
+#include "profiler/guest_profiler.h"
 #include "oslib/storage.h"
+#include "oslib/perf_jit.h"
 #include <chrono>
 
 settings_t settings;
@@ -458,6 +460,8 @@ void dc_reset(bool hard)
 		memwatch::reset();
 	}
 	sh4_sched_reset(hard);
+	if (hard)
+		guest_profiler::reset();
 	pvr::reset(hard);
 	aica::reset(hard);
 	sh4_cpu.Reset(true);
@@ -702,6 +706,8 @@ void Emulator::loadGame(const char *path, LoadProgress *progress)
 
 void Emulator::runInternal()
 {
+	FC_PROFILE_SCOPE;
+
 	if (singleStep)
 	{
 		sh4_cpu.Step();
@@ -736,6 +742,8 @@ void Emulator::unloadGame()
 	try {
 		stop();
 	} catch (...) { }
+	guest_profiler::stop();
+	guest_profiler::setSymbols({});
 	if (state == Loaded || state == Error)
 	{
 		if (state == Loaded && config::AutoSaveState && !settings.content.path.empty()
@@ -770,6 +778,7 @@ void Emulator::term()
 		aica::term();
 		pvr::term();
 		mem_Term();
+		perfjit::close();
 
 		addrspace::release();
 		state = Terminated;
@@ -964,12 +973,15 @@ void Emulator::start()
 		INFO_LOG(DYNAREC, "Using Interpreter");
 	}
 
+	// Rollbacks restore VRAM without going through the fault handler
+	addrspace::setBulkVramTracking(config::BulkVramTracking && !config::GGPOEnable);
 	memwatch::protect();
 
 	if (config::ThreadedRendering)
 	{
 		const std::lock_guard<std::mutex> lock(mutex);
 		threadResult = std::async(std::launch::async, [this] {
+				fc_profiler::setThreadName("emulation");
 				InitAudio();
 
 				try {
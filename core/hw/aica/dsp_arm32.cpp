@@ -24,6 +24,7 @@
 #include "aica.h"
 #include "aica_if.h"
 #include "oslib/virtmem.h"
+#include "oslib/perf_jit.h"
 
 #ifdef _M_ARM
 #pragma push_macro("MemoryBarrier")
@@ -316,6 +317,7 @@ public:
 		virtmem::flush_cache(
 			GetBuffer()->GetStartAddress<char*>(), GetBuffer()->GetEndAddress<char*>(),
 			GetBuffer()->GetStartAddress<void*>(), GetBuffer()->GetEndAddress<void*>());
+		perfjit::addCode(GetBuffer()->GetStartAddress<void*>(), GetBuffer()->GetSizeInBytes(), "aica:dsp");
 	}
 
 private:
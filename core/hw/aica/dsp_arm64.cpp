@@ -25,6 +25,7 @@
 #include "aica.h"
 #include "aica_if.h"
 #include "oslib/virtmem.h"
+#include "oslib/perf_jit.h"
 #include <aarch64/macro-assembler-aarch64.h>
 using namespace vixl::aarch64;
 
@@ -345,6 +346,7 @@ public:
 		virtmem::flush_cache(
 			GetBuffer()->GetStartAddress<char*>() + rx_offset, GetBuffer()->GetEndAddress<char*>() + rx_offset,
 			GetBuffer()->GetStartAddress<void*>(), GetBuffer()->GetEndAddress<void*>());
+		perfjit::addCode(GetBuffer()->GetStartAddress<char*>() + rx_offset, GetBuffer()->GetSizeInBytes(), "aica:dsp");
 	}
 
 private:
@@ -26,6 +26,7 @@
 #include "aica.h"
 #include "aica_if.h"
 #include "oslib/virtmem.h"
+#include "oslib/perf_jit.h"
 
 namespace aica::dsp
 {
@@ -356,6 +357,7 @@ public:
 
 		ret();
 		ready();
+		perfjit::addCode(getCode(), getSize(), "aica:dsp");
 	}
 
 private:
@@ -26,6 +26,7 @@
 #include "aica.h"
 #include "aica_if.h"
 #include "oslib/virtmem.h"
+#include "oslib/perf_jit.h"
 
 namespace aica
 {
@@ -333,6 +334,7 @@ public:
 
 		ret();
 		ready();
+		perfjit::addCode(getCode(), getSize(), "aica:dsp");
 	}
 
 private:
@@ -26,6 +26,9 @@
 #include "hw/aica/aica_if.h"
 #include "oslib/virtmem.h"
 #include "arm_mem.h"
+#include "oslib/perf_jit.h"
+#include <algorithm>
+#include <unordered_map>
 
 #if 0
 // for debug
@@ -120,6 +123,16 @@ static_assert(sizeof(ArmOpBits) == sizeof(u32), "sizeof(ArmOpBits) == sizeof(u32
 
 static std::vector<ArmOp> block_ops;
 static u8 cpuBitsSet[256];
+// Jumps to blocks that haven't been compiled yet, by entry point index
+static std::unordered_multimap<u32, void *> pendingLinks;
+
+static inline u32 entryIndex(u32 pc) {
+	// Note that we mask with the max aica size (8 MB), which is
+	// also the size of the EntryPoints table. This way the dynarec
+	// main loop doesn't have to worry about the actual aica
+	// ram size. The aica ram always wraps to 8 MB anyway.
+	return (pc & (ARAM_SIZE_MAX - 1)) / 4;
+}
 
 //findfirstset -- used in LDM/STM handling
 #ifdef _MSC_VER
@@ -573,17 +586,18 @@ void compile()
 
 	//setup local pc counter
 	u32 pc = arm_Reg[R15_ARM_NEXT].I;
+	const u32 startPc = pc;
 
 	//update the block table
-	// Note that we mask with the max aica size (8 MB), which is
-	// also the size of the EntryPoints table. This way the dynarec
-	// main loop doesn't have to worry about the actual aica
-	// ram size. The aica ram always wraps to 8 MB anyway.
-	EntryPoints[(pc & (ARAM_SIZE_MAX - 1)) / 4] = (void (*)())writeToExec(rv);
+	EntryPoints[entryIndex(pc)] = (void (*)())writeToExec(rv);
 
 	block_ops.clear();
+	// addresses decoded so far, to avoid following branches in loops
+	std::vector<u32> blockPcs;
+	std::vector<u32> exits;
 
 	u32 cycles = 0;
+	u32 guestOps = 0;
 
 	arm_printf("ARM7 Block %x", pc);
 	//the ops counter is used to terminate the block (max op count for a single block is 32 currently)
@@ -592,6 +606,8 @@ void compile()
 	{
 		//Read opcode ...
 		u32 opcd = *(u32*)&aica_ram[pc & ARAM_MASK];
+		blockPcs.push_back(pc);
+		guestOps++;
 
 #if 0
 		std::ostringstream ostr;
@@ -620,6 +636,25 @@ void compile()
 			//Branch ?
 			if (last_op.flags & ArmOp::OP_SETS_PC)
 			{
+				bool directBranch = (last_op.op_type == ArmOp::B || last_op.op_type == ArmOp::BL)
+						&& last_op.arg[0].isImmediate();
+				if (directBranch && last_op.condition == ArmOp::AL && ops < 31
+						&& std::find(blockPcs.begin(), blockPcs.end(), last_op.arg[0].getImmediate()) == blockPcs.end())
+				{
+					// Unconditional branch: continue the block at the target address
+					if (last_op.op_type == ArmOp::BL)
+					{
+						ArmOp armop(ArmOp::MOV, ArmOp::AL);
+						armop.rd = ArmOp::Operand(RN_LR);
+						armop.arg[0] = ArmOp::Operand(pc);
+						block_ops.push_back(armop);
+					}
+					pc = last_op.arg[0].getImmediate();
+					arm_printf("ARM: following branch to %06X", pc);
+					continue;
+				}
+				if (directBranch)
+					exits.push_back(last_op.arg[0].getImmediate());
 				if (last_op.condition != ArmOp::AL)
 				{
 					// insert a "mov armNextPC, pc + 4" before the jump if not taken
@@ -627,6 +662,7 @@ void compile()
 					armop.rd = ArmOp::Operand(R15_ARM_NEXT);
 					armop.arg[0] = ArmOp::Operand(pc);
 					block_ops.push_back(armop);
+					exits.push_back(pc);
 				}
 				if (last_op.op_type == ArmOp::BL)
 				{
@@ -651,20 +687,46 @@ void compile()
 			armop.rd = ArmOp::Operand(R15_ARM_NEXT);
 			armop.arg[0] = ArmOp::Operand(pc);
 			block_ops.push_back(armop);
+			exits.push_back(pc);
 			arm_printf("ARM: %06X: Block split", pc);
 		}
 	}
 
 	block_ssa_pass();
 
-	arm7backend_compile(block_ops, cycles);
+	arm7backend_compile(block_ops, exits, cycles);
+
+	// Link the blocks jumping to this one
+	auto range = pendingLinks.equal_range(entryIndex(startPc));
+	for (auto it = range.first; it != range.second; ++it)
+		arm7backend_link(it->second, writeToExec(rv));
+	pendingLinks.erase(range.first, range.second);
 
+	if (perfjit::enabled())
+	{
+		char name[64];
+		snprintf(name, sizeof(name), "arm7:%06X,c:%d,s:%d", startPc & ARAM_MASK, cycles, guestOps);
+		perfjit::addCode(writeToExec(rv), (u32)(icPtr - (u8 *)rv), name);
+	}
 	arm_printf("arm7rec_compile done: %p,%p", rv, icPtr);
 }
 
+void *getLinkTarget(u32 pc)
+{
+	void (*code)() = EntryPoints[entryIndex(pc)];
+	return code == arm_compilecode ? nullptr : (void *)code;
+}
+
+void addLinkSite(u32 pc, void *site)
+{
+	pendingLinks.emplace(entryIndex(pc), site);
+}
+
 void flush()
 {
 	icPtr = ICache;
+	// all the code is discarded, including the jumps waiting to be linked
+	pendingLinks.clear();
 	arm7backend_flush();
 	verify(arm_compilecode != nullptr);
 	for (u32 i = 0; i < std::size(EntryPoints); i++)
@@ -456,10 +456,19 @@ static inline void *execToWrite(void * addr) {
 	return (char *)addr - rx_offset;
 }
 
+// Block linking
+// Returns the (executable) code of the block at the given pc, or nullptr if it hasn't been compiled yet
+void *getLinkTarget(u32 pc);
+// Registers a patchable jump (writable address) to be linked when the block at the given pc is compiled
+void addLinkSite(u32 pc, void *site);
+
 } // namespace recompiler
 
-void arm7backend_compile(const std::vector<ArmOp>& block_ops, u32 cycles);
+// exits are the guest addresses the block may jump to. They are linked directly to the corresponding blocks.
+void arm7backend_compile(const std::vector<ArmOp>& block_ops, const std::vector<u32>& exits, u32 cycles);
 void arm7backend_flush();
+// Patches the jump at site to go to target
+void arm7backend_link(void *site, void *target);
 
 extern void (*arm_compilecode)();
 using arm_mainloop_t = void (*)(reg_pair *arm_regs, void (*entrypoints[])());
@@ -422,7 +422,22 @@ static void emitFallback(const ArmOp& op)
 	call((void *)recompiler::interpret);
 }
 
-void arm7backend_compile(const std::vector<ArmOp>& block_ops, u32 cycles)
+// Jumps to the block at the given pc if it's compiled. Otherwise jumps to the dispatcher until the block is linked.
+static void linkJump(u32 pc)
+{
+	void *target = recompiler::getLinkTarget(pc);
+	if (target != nullptr)
+	{
+		jump(target);
+	}
+	else
+	{
+		jump((void *)arm_dispatch);
+		recompiler::addLinkSite(pc, ass.GetCursorAddress<u8 *>() - 4);
+	}
+}
+
+void arm7backend_compile(const std::vector<ArmOp>& block_ops, const std::vector<u32>& exits, u32 cycles)
 {
 	ass = Arm32Assembler((u8 *)recompiler::currentCode(), recompiler::spaceLeft());
 
@@ -475,6 +490,27 @@ void arm7backend_compile(const std::vector<ArmOp>& block_ops, u32 cycles)
 	}
 	storeFlags();
 
+	if (!exits.empty())
+	{
+		// Jump directly to the next block unless the timeslice is over or an interrupt is pending
+		Label dispatch;
+		loadReg(r3, CYCL_CNT);
+		loadReg(r0, R15_ARM_NEXT);
+		loadReg(r1, INTR_PEND);
+		ass.Cmp(r3, 0);
+		ass.B(le, &dispatch);
+		ass.Cmp(r1, 0);
+		ass.B(ne, &dispatch);
+		for (u32 exitPc : exits)
+		{
+			Label next;
+			ass.Cmp(r0, exitPc);
+			ass.B(ne, &next);
+			linkJump(exitPc);
+			ass.Bind(&next);
+		}
+		ass.Bind(&dispatch);
+	}
 	jump((void *)arm_dispatch);
 
 	ass.Finalize();
@@ -484,6 +520,16 @@ void arm7backend_compile(const std::vector<ArmOp>& block_ops, u32 cycles)
 	regalloc = nullptr;
 }
 
+void arm7backend_link(void *site, void *target)
+{
+	u32 *code = (u32 *)site;
+	verify((*code & 0xff000000) == 0xea000000);	// b
+	void *execSite = recompiler::writeToExec(site);
+	ptrdiff_t offset = (u8 *)target - ((u8 *)execSite + 8);
+	*code = 0xea000000 | ((offset >> 2) & 0xffffff);
+	virtmem::flush_cache(execSite, (u8 *)execSite + 3, site, (u8 *)site + 3);
+}
+
 void arm7backend_flush()
 {
 	if (!recompiler::empty())
@@ -567,7 +567,7 @@ class Arm7Compiler : public MacroAssembler
 public:
 	Arm7Compiler() : MacroAssembler((u8 *)recompiler::currentCode(), recompiler::spaceLeft()) {}
 
-	void compile(const std::vector<ArmOp>& block_ops, u32 cycles)
+	void compile(const std::vector<ArmOp>& block_ops, const std::vector<u32>& exits, u32 cycles)
 	{
 		JITWriteProtect(false);
 		Ldr(w1, arm_reg_operand(CYCL_CNT));
@@ -624,6 +624,37 @@ public:
 		ptrdiff_t offset = reinterpret_cast<uintptr_t>(arm_dispatch) - GetBuffer()->GetStartAddress<uintptr_t>();
 		Label arm_dispatch_label;
 		BindToOffset(&arm_dispatch_label, offset);
+		if (!exits.empty())
+		{
+			// Jump directly to the next block unless the timeslice is over or an interrupt is pending
+			Label dispatch;
+			Ldr(w3, arm_reg_operand(CYCL_CNT));
+			Ldp(w0, w1, arm_reg_operand(R15_ARM_NEXT));	// load Next PC, interrupt
+			Tbnz(w3, 31, &dispatch);
+			Cbnz(w1, &dispatch);
+			for (u32 exitPc : exits)
+			{
+				Label next;
+				Cmp(w0, exitPc);
+				B(&next, ne);
+				void *target = recompiler::getLinkTarget(exitPc);
+				if (target == nullptr)
+				{
+					B(&arm_dispatch_label);
+					// patched when the target block is compiled
+					recompiler::addLinkSite(exitPc, GetCursorAddress<u8 *>() - kInstructionSize);
+				}
+				else
+				{
+					Label target_label;
+					BindToOffset(&target_label, reinterpret_cast<uintptr_t>(target)
+							- reinterpret_cast<uintptr_t>(recompiler::writeToExec(GetBuffer()->GetStartAddress<void *>())));
+					B(&target_label);
+				}
+				Bind(&next);
+			}
+			Bind(&dispatch);
+		}
 		B(&arm_dispatch_label);
 
 		FinalizeCode();
@@ -750,10 +781,22 @@ void AArch64ArmRegAlloc::StoreReg(int host_reg, Arm7Reg armreg)
 	assembler.Str(getReg(host_reg), arm_reg_operand(armreg));
 }
 
-void arm7backend_compile(const std::vector<ArmOp>& block_ops, u32 cycles)
+void arm7backend_compile(const std::vector<ArmOp>& block_ops, const std::vector<u32>& exits, u32 cycles)
 {
 	Arm7Compiler assembler;
-	assembler.compile(block_ops, cycles);
+	assembler.compile(block_ops, exits, cycles);
+}
+
+void arm7backend_link(void *site, void *target)
+{
+	u32 *code = (u32 *)site;
+	verify((*code & 0xfc000000) == 0x14000000);	// b imm26
+	void *execSite = recompiler::writeToExec(site);
+	ptrdiff_t offset = (u8 *)target - (u8 *)execSite;
+	JITWriteProtect(false);
+	*code = 0x14000000 | ((offset >> 2) & 0x3ffffff);
+	virtmem::flush_cache(execSite, (u8 *)execSite + kInstructionSize, site, (u8 *)site + kInstructionSize);
+	JITWriteProtect(true);
 }
 
 void arm7backend_flush()
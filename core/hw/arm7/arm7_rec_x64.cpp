@@ -806,7 +806,7 @@ class Arm7Compiler : public Xbyak::CodeGenerator
 public:
 	Arm7Compiler() : Xbyak::CodeGenerator(recompiler::spaceLeft(), recompiler::currentCode()) { }
 
-	void compile(const std::vector<ArmOp>& block_ops, u32 cycles)
+	void compile(const std::vector<ArmOp>& block_ops, const std::vector<u32>& exits, u32 cycles)
 	{
 		regalloc = new X64ArmRegAlloc(*this, block_ops);
 
@@ -871,6 +871,32 @@ public:
 		}
 		endConditional(condLabel);
 
+		if (!exits.empty())
+		{
+			// Jump directly to the next block unless the timeslice is over or an interrupt is pending
+			Xbyak::Label dispatch;
+			cmp(dword[rip + &arm_Reg[CYCL_CNT]], 0);
+			jle(dispatch);
+			cmp(dword[rip + &arm_Reg[INTR_PEND]], 0);
+			jne(dispatch);
+			mov(ecx, dword[rip + &arm_Reg[R15_ARM_NEXT]]);
+			for (u32 exitPc : exits)
+			{
+				Xbyak::Label next;
+				cmp(ecx, exitPc);
+				jne(next);
+				void *target = recompiler::getLinkTarget(exitPc);
+				if (target == nullptr)
+				{
+					// patched when the target block is compiled
+					recompiler::addLinkSite(exitPc, (void *)getCurr());
+					target = (void *)arm_dispatch;
+				}
+				jmp(target, T_NEAR);
+				L(next);
+			}
+			L(dispatch);
+		}
 		jmp((void*)arm_dispatch);
 
 		ready();
@@ -995,18 +1021,29 @@ void X64ArmRegAlloc::StoreReg(int host_reg, Arm7Reg armreg)
 	assembler.mov(dword[rip + &arm_Reg[(u32)armreg].I], getReg32(host_reg));
 }
 
-void arm7backend_compile(const std::vector<ArmOp>& block_ops, u32 cycles)
+void arm7backend_compile(const std::vector<ArmOp>& block_ops, const std::vector<u32>& exits, u32 cycles)
 {
 	void* protStart = recompiler::currentCode();
 	size_t protSize = recompiler::spaceLeft();
 	virtmem::jit_set_exec(protStart, protSize, false);
 
 	Arm7Compiler assembler;
-	assembler.compile(block_ops, cycles);
+	assembler.compile(block_ops, exits, cycles);
 
 	virtmem::jit_set_exec(protStart, protSize, true);
 }
 
+void arm7backend_link(void *site, void *target)
+{
+	// jmp rel32
+	u8 *code = (u8 *)site;
+	verify(code[0] == 0xe9);
+	virtmem::jit_set_exec(code, 5, false);
+	s32 rel = (s32)((u8 *)target - (code + 5));
+	memcpy(code + 1, &rel, sizeof(rel));
+	virtmem::jit_set_exec(code, 5, true);
+}
+
 void arm7backend_flush()
 {
 	void* protStart = recompiler::currentCode();
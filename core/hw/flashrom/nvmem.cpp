@@ -32,6 +32,7 @@ namespace nvmem
 {
 
 static MemChip *sys_rom;
+static std::unique_ptr<MemChip> preloadedBios;
 static WritableChip *sys_nvmem;
 
 static std::string getRomPrefix()
@@ -290,7 +291,17 @@ bool loadFiles()
 	loadFlash();
 	if (!settings.platform.isAtomiswave())
 	{
-		if (sys_rom->Load(getRomPrefix(), "%boot.bin;%boot.bin.bin;%bios.bin;%bios.bin.bin", "bootrom"))
+		bool loaded;
+		if (preloadedBios && settings.platform.isConsole())
+		{
+			delete sys_rom;
+			sys_rom = preloadedBios.release();
+			loaded = true;
+		}
+		else {
+			loaded = sys_rom->Load(getRomPrefix(), "%boot.bin;%boot.bin.bin;%bios.bin;%bios.bin.bin", "bootrom");
+		}
+		if (loaded)
 		{
 			if (config::GGPOEnable)
 				sys_rom->digest(settings.network.md5.bios);
@@ -303,6 +314,14 @@ bool loadFiles()
 	return true;
 }
 
+void preloadBios()
+{
+	verify(settings.platform.isConsole());
+	preloadedBios = std::make_unique<RomChip>(settings.platform.bios_size);
+	if (!preloadedBios->Load(getRomPrefix(), "%boot.bin;%boot.bin.bin;%bios.bin;%bios.bin.bin", "bootrom"))
+		preloadedBios.reset();
+}
+
 void saveFiles()
 {
 	if (settings.naomi.slave || settings.naomi.drivingSimSlave)
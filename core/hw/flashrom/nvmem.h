@@ -40,6 +40,9 @@ void reloadAWBios();
 
 bool loadFiles();
 void saveFiles();
+// Loads the Dreamcast BIOS once and keeps it for the next loadFiles().
+// Processes forked afterwards share its pages with their parent.
+void preloadBios();
 bool loadHle();
 
 }
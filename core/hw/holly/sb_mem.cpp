@@ -261,6 +261,69 @@ void DYNACALL WriteMem_area0(u32 paddr, T data)
 	INFO_LOG(MEMORY, "Write to area0_32 not implemented [Unassigned], addr=%x,data=%x,size=%d", addr, data, sz);
 }
 
+// Area 0 regions called directly by the dynarec when the address is constant
+
+template<typename T, u32 System>
+T DYNACALL ReadMem_gdromRegs(u32 paddr)
+{
+	if constexpr (System == DC_PLATFORM_DREAMCAST)
+		return (T)ReadMem_gdrom(paddr & 0x01FFFFFF, sizeof(T));
+	else
+		return (T)ReadMem_naomi(paddr & 0x01FFFFFF, sizeof(T));
+}
+
+template<typename T, u32 System>
+void DYNACALL WriteMem_gdromRegs(u32 paddr, T data)
+{
+	if constexpr (System == DC_PLATFORM_DREAMCAST)
+		WriteMem_gdrom(paddr & 0x01FFFFFF, data, sizeof(T));
+	else
+		WriteMem_naomi(paddr & 0x01FFFFFF, data, sizeof(T));
+}
+
+template<typename T>
+T DYNACALL ReadMem_sbRegs(u32 paddr) {
+	return (T)sb_ReadMem(paddr);
+}
+template<typename T>
+void DYNACALL WriteMem_sbRegs(u32 paddr, T data) {
+	sb_WriteMem(paddr, data);
+}
+
+static u32 DYNACALL ReadMem_pvrRegs(u32 paddr) {
+	return pvr_ReadReg(paddr);
+}
+static void DYNACALL WriteMem_pvrRegs(u32 paddr, u32 data) {
+	pvr_WriteReg(paddr, data);
+}
+
+template<typename T>
+T DYNACALL ReadMem_aicaRegs(u32 paddr) {
+	return aica::readAicaReg<T>(paddr & 0x01FFFFFF);
+}
+template<typename T>
+void DYNACALL WriteMem_aicaRegs(u32 paddr, T data) {
+	aica::writeAicaReg(paddr & 0x01FFFFFF, data);
+}
+
+template<typename T>
+T DYNACALL ReadMem_rtcRegs(u32 paddr) {
+	return aica::readRtcReg<T>(paddr & 0x01FFFFFF);
+}
+template<typename T>
+void DYNACALL WriteMem_rtcRegs(u32 paddr, T data) {
+	aica::writeRtcReg(paddr & 0x01FFFFFF, data);
+}
+
+template<typename T>
+T DYNACALL ReadMem_aicaRam(u32 paddr) {
+	return ReadMemArr<T>(&aica::aica_ram[0], paddr & ARAM_MASK);
+}
+template<typename T>
+void DYNACALL WriteMem_aicaRam(u32 paddr, T data) {
+	WriteMemArr(&aica::aica_ram[0], paddr & ARAM_MASK, data);
+}
+
 //Init/Res/Term
 void sh4_area0_Init()
 {
@@ -293,37 +356,54 @@ void sh4_area0_Term()
 static addrspace::handler area0_handler;
 static addrspace::handler area0_mirror_handler;
 
-void map_area0_init()
+template<u32 System>
+static void registerArea0Handlers()
 {
-#define registerHandler(system, mirror) addrspace::registerHandler \
-		(ReadMem_area0<u8, system, mirror>, ReadMem_area0<u16, system, mirror>, ReadMem_area0<u32, system, mirror>,	\
-		 WriteMem_area0<u8, system, mirror>, WriteMem_area0<u16, system, mirror>, WriteMem_area0<u32, system, mirror>)
+#define registerHandler(mirror) addrspace::registerHandler \
+		(ReadMem_area0<u8, System, mirror>, ReadMem_area0<u16, System, mirror>, ReadMem_area0<u32, System, mirror>,	\
+		 WriteMem_area0<u8, System, mirror>, WriteMem_area0<u16, System, mirror>, WriteMem_area0<u32, System, mirror>)
 
+	area0_handler = registerHandler(false);
+	area0_mirror_handler = registerHandler(true);
+#undef registerHandler
+
+	// The mirror only differs for the boot ROM and flash
+	for (addrspace::handler handler : { area0_handler, area0_mirror_handler })
+	{
+		// GD-ROM / Naomi/AW cart registers first since they're within the SB register range
+		addrspace::registerRegion(handler, 0x01FFFFFF, 0x005F7000, 0x005F70FF,
+				ReadMem_gdromRegs<u8, System>, ReadMem_gdromRegs<u16, System>, ReadMem_gdromRegs<u32, System>,
+				WriteMem_gdromRegs<u8, System>, WriteMem_gdromRegs<u16, System>, WriteMem_gdromRegs<u32, System>);
+		addrspaceRegisterRegionTemplate(handler, 0x01FFFFFF, 0x005F6800, 0x005F7CFF, ReadMem_sbRegs, WriteMem_sbRegs);
+		addrspace::registerRegion(handler, 0x01FFFFFF, 0x005F8000, 0x005F9FFF,
+				nullptr, nullptr, ReadMem_pvrRegs, nullptr, nullptr, WriteMem_pvrRegs);
+		addrspaceRegisterRegionTemplate(handler, 0x01FFFFFF, 0x00700000, 0x00707FFF, ReadMem_aicaRegs, WriteMem_aicaRegs);
+		addrspaceRegisterRegionTemplate(handler, 0x01FFFFFF, 0x00710000, 0x0071000B, ReadMem_rtcRegs, WriteMem_rtcRegs);
+		addrspaceRegisterRegionTemplate(handler, 0x01FFFFFF, 0x00800000, 0x00FFFFFF, ReadMem_aicaRam, WriteMem_aicaRam);
+	}
+}
+
+void map_area0_init()
+{
 	switch (settings.platform.system)
 	{
 	case DC_PLATFORM_DREAMCAST:
 	default:
-		area0_handler = registerHandler(DC_PLATFORM_DREAMCAST, false);
-		area0_mirror_handler = registerHandler(DC_PLATFORM_DREAMCAST, true);
+		registerArea0Handlers<DC_PLATFORM_DREAMCAST>();
 		break;
 	case DC_PLATFORM_NAOMI:
-		area0_handler = registerHandler(DC_PLATFORM_NAOMI, false);
-		area0_mirror_handler = registerHandler(DC_PLATFORM_NAOMI, true);
+		registerArea0Handlers<DC_PLATFORM_NAOMI>();
 		break;
 	case DC_PLATFORM_NAOMI2:
-		area0_handler = registerHandler(DC_PLATFORM_NAOMI2, false);
-		area0_mirror_handler = registerHandler(DC_PLATFORM_NAOMI2, true);
+		registerArea0Handlers<DC_PLATFORM_NAOMI2>();
 		break;
 	case DC_PLATFORM_ATOMISWAVE:
-		area0_handler = registerHandler(DC_PLATFORM_ATOMISWAVE, false);
-		area0_mirror_handler = registerHandler(DC_PLATFORM_ATOMISWAVE, true);
+		registerArea0Handlers<DC_PLATFORM_ATOMISWAVE>();
 		break;
 	case DC_PLATFORM_SYSTEMSP:
-		area0_handler = registerHandler(DC_PLATFORM_SYSTEMSP, false);
-		area0_mirror_handler = registerHandler(DC_PLATFORM_SYSTEMSP, true);
+		registerArea0Handlers<DC_PLATFORM_SYSTEMSP>();
 		break;
 	}
-#undef registerHandler
 }
 void map_area0(u32 base)
 {
@@ -4,9 +4,14 @@
 #include "hw/pvr/elan.h"
 #include "hw/sh4/dyna/blockmanager.h"
 #include "hw/sh4/sh4_mem.h"
+#include "log/BitSet.h"
 #include "oslib/oslib.h"
 #include "oslib/virtmem.h"
+#include "rend/TexCache.h"
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <vector>
 
 namespace addrspace
 {
@@ -30,6 +35,31 @@ static WriteMem32FP* WF32[HANDLER_COUNT];
 //upper 8b of the address
 static void* memInfo_ptr[0x100];
 
+//handler regions with specialized access functions
+struct Region
+{
+	u32 mask;
+	u32 start;
+	u32 end;
+
+	ReadMem8FP*   read8;
+	ReadMem16FP*  read16;
+	ReadMem32FP*  read32;
+
+	WriteMem8FP*  write8;
+	WriteMem16FP* write16;
+	WriteMem32FP* write32;
+};
+static std::vector<Region> regions[HANDLER_COUNT];
+
+static const Region *findRegion(u32 id, u32 addr)
+{
+	for (const Region& region : regions[id])
+		if ((addr & region.mask) >= region.start && (addr & region.mask) <= region.end)
+			return &region;
+	return nullptr;
+}
+
 #define MAP_RAM_START_OFFSET  0
 #define MAP_VRAM_START_OFFSET (MAP_RAM_START_OFFSET+RAM_SIZE)
 #define MAP_ARAM_START_OFFSET (MAP_VRAM_START_OFFSET+VRAM_SIZE)
@@ -45,13 +75,20 @@ void *readConst(u32 addr, bool& ismem, u32 sz)
 	{
 		ismem = false;
 		const uintptr_t id = iirf;
+		const Region *region = findRegion(id, addr);
 		switch (sz)
 		{
 		case 1:
+			if (region != nullptr && region->read8 != nullptr)
+				return (void *)region->read8;
 			return (void *)RF8[id];
 		case 2:
+			if (region != nullptr && region->read16 != nullptr)
+				return (void *)region->read16;
 			return (void *)RF16[id];
 		case 4:
+			if (region != nullptr && region->read32 != nullptr)
+				return (void *)region->read32;
 			return (void *)RF32[id];
 		default:
 			die("Invalid size");
@@ -78,13 +115,20 @@ void *writeConst(u32 addr, bool& ismem, u32 sz)
 	{
 		ismem = false;
 		const uintptr_t id = iirf;
+		const Region *region = findRegion(id, addr);
 		switch (sz)
 		{
 		case 1:
+			if (region != nullptr && region->write8 != nullptr)
+				return (void *)region->write8;
 			return (void *)WF8[id];
 		case 2:
+			if (region != nullptr && region->write16 != nullptr)
+				return (void *)region->write16;
 			return (void *)WF16[id];
 		case 4:
+			if (region != nullptr && region->write32 != nullptr)
+				return (void *)region->write32;
 			return (void *)WF32[id];
 		default:
 			die("Invalid size");
@@ -246,6 +290,15 @@ handler registerHandler(
 	return rv;
 }
 
+void registerRegion(handler Handler, u32 mask, u32 start, u32 end,
+		ReadMem8FP *read8, ReadMem16FP *read16, ReadMem32FP *read32,
+		WriteMem8FP *write8, WriteMem16FP *write16, WriteMem32FP *write32)
+{
+	assert(Handler < lastRegisteredHandler);
+	assert(start <= end);
+	regions[Handler].push_back({ mask, start, end, read8, read16, read32, write8, write16, write32 });
+}
+
 static u32 FindMask(u32 msk)
 {
 	u32 s=-1;
@@ -315,6 +368,10 @@ void init()
 	//clear meminfo table
 	memset(memInfo_ptr, 0, sizeof(memInfo_ptr));
 
+	//clear regions
+	for (auto& handlerRegions : regions)
+		handlerRegions.clear();
+
 	//reset registration index
 	lastRegisteredHandler = 0;
 
@@ -407,8 +464,12 @@ static void termMappings()
 	}
 }
 
+static bool bulkVramTracking;
+
 void initMappings()
 {
+	// Remapping the memory stops the bulk tracking. It's enabled again when the emulator starts.
+	setBulkVramTracking(false);
 	termMappings();
 	// Fallback to statically allocated buffers, this results in slow-ops being generated.
 	if (ram_base == nullptr)
@@ -466,8 +527,23 @@ void initMappings()
 			(u32)(ARAM_SIZE / 1_MB), &aica::aica_ram[0]);
 }
 
+// The 512 MB guest address space followed by the writable aica ram view (see initMappings)
+constexpr size_t MAPPED_SIZE = 512_MB + ARAM_SIZE_MAX;
+
+bool unshare()
+{
+	// Without virtual memory, the guest memory is private and copied on write
+	if (ram_base == nullptr)
+		return true;
+	if (!virtmem::renew_shared_memory(ram_base, MAPPED_SIZE))
+		return false;
+	initMappings();
+	return true;
+}
+
 void release()
 {
+	setBulkVramTracking(false);
 	if (ram_base != nullptr)
 	{
 		virtmem::destroy();
@@ -480,9 +556,12 @@ void release()
 	}
 }
 
-void protectVram(u32 addr, u32 size)
+// One bit per protected VRAM page
+static std::atomic<u64> protectedVram[VRAM_SIZE_MAX / PAGE_SIZE / 64];
+VramTrackingStats vramTrackingStats;
+
+static void lockVram(u32 addr, u32 size)
 {
-	addr &= VRAM_MASK;
 	if (virtmemEnabled())
 	{
 		virtmem::region_lock(ram_base + 0x04000000 + addr, size);	// P0
@@ -500,9 +579,8 @@ void protectVram(u32 addr, u32 size)
 	}
 }
 
-void unprotectVram(u32 addr, u32 size)
+static void unlockVram(u32 addr, u32 size)
 {
-	addr &= VRAM_MASK;
 	if (virtmemEnabled())
 	{
 		virtmem::region_unlock(ram_base + 0x04000000 + addr, size);		// P0
@@ -520,6 +598,132 @@ void unprotectVram(u32 addr, u32 size)
 	}
 }
 
+static void setVramProtected(u32 addr, u32 size, bool protect)
+{
+	for (u32 page = addr / PAGE_SIZE; page < (addr + size) / PAGE_SIZE; page++)
+	{
+		const u64 bit = 1ull << (page % 64);
+		if (protect)
+			protectedVram[page / 64].fetch_or(bit, std::memory_order_relaxed);
+		else
+			protectedVram[page / 64].fetch_and(~bit, std::memory_order_relaxed);
+	}
+}
+
+static bool isVramProtected(u32 page) {
+	return (protectedVram[page / 64].load(std::memory_order_relaxed) >> (page % 64)) & 1;
+}
+
+void protectVram(u32 addr, u32 size)
+{
+	addr &= VRAM_MASK;
+	setVramProtected(addr, size, true);
+	if (!bulkVramTracking)
+		lockVram(addr, size);
+}
+
+void unprotectVram(u32 addr, u32 size)
+{
+	addr &= VRAM_MASK;
+	setVramProtected(addr, size, false);
+	if (!bulkVramTracking)
+		unlockVram(addr, size);
+}
+
+static bool trackVramWrites(bool enable)
+{
+	if (virtmemEnabled())
+	{
+		u8 *p0 = ram_base + 0x04000000;
+		// wraps when only 8MB VRAM
+		const u32 size = VRAM_SIZE == 0x800000 ? VRAM_SIZE * 2 : VRAM_SIZE;
+		if (!enable) {
+			virtmem::dirty_tracking_stop(p0, size);
+			return true;
+		}
+		return virtmem::dirty_tracking_start(p0, size);
+	}
+	else
+	{
+		if (!enable) {
+			virtmem::dirty_tracking_stop(&vram[0], VRAM_SIZE);
+			return true;
+		}
+		return virtmem::dirty_tracking_start(&vram[0], VRAM_SIZE);
+	}
+}
+
+bool setBulkVramTracking(bool enable)
+{
+	if (enable && !virtmem::dirty_tracking_init())
+		enable = false;
+	if (enable == bulkVramTracking)
+		return enable;
+
+	if (enable)
+	{
+		if (!trackVramWrites(true))
+			return false;
+	}
+	else
+	{
+		// Pages written since the last check would be missed once relocked
+		checkVramWrites();
+	}
+	// Switch the pages currently protected to the new method
+	for (u32 page = 0; page < VRAM_SIZE / PAGE_SIZE; page++)
+	{
+		if (!isVramProtected(page))
+			continue;
+		if (enable)
+			unlockVram(page * PAGE_SIZE, PAGE_SIZE);
+		else
+			lockVram(page * PAGE_SIZE, PAGE_SIZE);
+	}
+	if (!enable)
+		trackVramWrites(false);
+	bulkVramTracking = enable;
+	INFO_LOG(VMEM, "VRAM write tracking: %s", enable ? "asynchronous write-protect" : "page faults");
+
+	return enable;
+}
+
+void checkVramWrites()
+{
+	if (!bulkVramTracking)
+		return;
+	auto start = std::chrono::steady_clock::now();
+
+	// VRAM is only written by the emulation thread, and by the renderer which invalidates the pages it writes.
+	// The written pages are write-protected again by the query.
+	u64 dirty[VRAM_SIZE_MAX / PAGE_SIZE / 64] {};
+	if (virtmemEnabled())
+	{
+		virtmem::dirty_tracking_query(ram_base + 0x04000000, VRAM_SIZE, dirty);	// P0
+		if (VRAM_SIZE == 0x800000)
+			// wraps when only 8MB VRAM
+			virtmem::dirty_tracking_query(ram_base + 0x04000000 + VRAM_SIZE, VRAM_SIZE, dirty);	// P0 wrap
+	}
+	else
+	{
+		virtmem::dirty_tracking_query(&vram[0], VRAM_SIZE, dirty);
+	}
+
+	for (u32 i = 0; i < VRAM_SIZE / PAGE_SIZE / 64; i++)
+	{
+		u64 written = dirty[i] & protectedVram[i].load(std::memory_order_relaxed);
+		while (written != 0)
+		{
+			u32 page = i * 64 + Common::LeastSignificantSetBit(written);
+			written &= written - 1;
+			VramLockedWriteOffset(page * PAGE_SIZE);
+			vramTrackingStats.dirtyPages++;
+		}
+	}
+	vramTrackingStats.checkTime += (u32)std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now() - start).count();
+}
+
 u32 getVramOffset(void *addr)
 {
 	if (virtmemEnabled())
@@ -31,6 +31,20 @@ handler registerHandler(ReadMem8FP *read8, ReadMem16FP *read16, ReadMem32FP *rea
 									(read<u8>, read<u16>, read<u32>,	\
 									write<u8>, write<u16>, write<u32>)
 
+// Register a region of a handler with its own access functions, selected by readConst/writeConst
+// when the address is known at compile time so that the dynarec can call them directly.
+// The region contains the addresses for which (address & mask) is in [start, end].
+// A null function falls back to the handler function of the same size.
+// Regions are matched in registration order.
+void registerRegion(handler Handler, u32 mask, u32 start, u32 end,
+		ReadMem8FP *read8, ReadMem16FP *read16, ReadMem32FP *read32,
+		WriteMem8FP *write8, WriteMem16FP *write16, WriteMem32FP *write32);
+
+#define addrspaceRegisterRegionTemplate(handler, mask, start, end, read, write) addrspace::registerRegion \
+									(handler, mask, start, end,	\
+									read<u8>, read<u16>, read<u32>,	\
+									write<u8>, write<u16>, write<u32>)
+
 void mapHandler(handler Handler, u32 start, u32 end);
 void mapBlock(void* base, u32 start, u32 end, u32 mask);
 void mirrorMapping(u32 new_region, u32 start, u32 size);
@@ -64,6 +78,9 @@ template<typename T> void DYNACALL writet(u32 addr, T data);
 //should be called at start up to ensure it will succeed
 bool reserve();
 void release();
+// Gives a forked process its own guest memory, initialized to zero.
+// Without this, a process forked from an initialized emulator would share it with its parent.
+bool unshare();
 
 //dynarec helpers
 void *readConst(u32 addr, bool& ismem, u32 sz);
@@ -81,4 +98,34 @@ void protectVram(u32 addr, u32 size);
 void unprotectVram(u32 addr, u32 size);
 u32 getVramOffset(void *addr);
 
+// Writes to protected VRAM pages are either trapped by the fault handler (write-protected pages)
+// or resolved by the host kernel and detected in bulk when checkVramWrites() is called.
+// Returns true if bulk tracking is supported and enabled.
+bool setBulkVramTracking(bool enable);
+// Invalidates the protected VRAM pages written since the last call. Only needed with bulk tracking.
+void checkVramWrites();
+
+struct VramTrackingStats
+{
+	void newFrame()
+	{
+		lastTrappedWrites = trappedWrites;
+		lastDirtyPages = dirtyPages;
+		lastCheckTime = checkTime;
+		trappedWrites = 0;
+		dirtyPages = 0;
+		checkTime = 0;
+	}
+
+	// current frame
+	u32 trappedWrites = 0;	// protected pages written, trapped by the fault handler (one signal each)
+	u32 dirtyPages = 0;		// protected pages written, found by checkVramWrites() (one kernel-handled fault each)
+	u32 checkTime = 0;		// time spent in checkVramWrites(), in microseconds
+	// last frame
+	u32 lastTrappedWrites = 0;
+	u32 lastDirtyPages = 0;
+	u32 lastCheckTime = 0;
+};
+extern VramTrackingStats vramTrackingStats;
+
 } // namespace addrspace
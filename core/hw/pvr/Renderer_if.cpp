@@ -9,6 +9,7 @@
 #include "hw/sh4/sh4_if.h"
 #include "profiler/fc_profiler.h"
 #include "network/ggpo.h"
+#include "hw/mem/addrspace.h"
 
 #include <mutex>
 #include <deque>
@@ -357,6 +358,8 @@ void rend_start_render()
 {
 	render_called = true;
 	pend_rend = false;
+	// Written pages must be flagged before the context is queued
+	addrspace::checkVramWrites();
 
 	TA_context *ctx = nullptr;
 	u32 addresses[MAX_PASSES];
@@ -463,6 +466,7 @@ void rend_vblank()
 		fb_dirty = false;
 	}
 	render_called = false;
+	addrspace::checkVramWrites();
 	check_framebuffer_write();
 	emu.vblank();
 }
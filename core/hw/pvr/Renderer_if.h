@@ -68,6 +68,9 @@ struct Renderer
 	virtual void DrawOSD(bool clear_screen) { }
 
 	virtual BaseTextureCacheData *GetTexture(TSP tsp, TCW tcw) { return nullptr; }
+
+	// Additional statistics displayed next to the FPS counter
+	virtual std::string GetOSDStats() { return std::string(); }
 };
 
 extern Renderer* renderer;
@@ -59,11 +59,13 @@
 #include "hw/sh4/sh4_mmr.h"
 #include "serialize.h"
 #include "elan_struct.h"
+#include "elan_batch.h"
 #include "network/ggpo.h"
 #include "cfg/option.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <array>
 
 namespace elan {
 
@@ -579,19 +581,20 @@ static void SetEnvMapUV(Vertex& vtx)
 	}
 }
 
-template<typename T>
-static glm::vec3 getNormal(const T& vtx)
-{
-	return { (int8_t)vtx.header.nx / 127.f, (int8_t)vtx.header.ny / 127.f, (int8_t)vtx.header.nz / 127.f };
-}
+// (int8_t)n / 127.f
+static const std::array<float, 256> normalComponents = []() {
+	std::array<float, 256> lut;
+	for (int i = 0; i < 256; i++)
+		lut[i] = (int8_t)i / 127.f;
+	return lut;
+}();
 
 template<typename T>
 static void setNormal(Vertex& vd, const T& vs)
 {
-	glm::vec3 normal = getNormal(vs);
-	vd.nx = normal.x;
-	vd.ny = normal.y;
-	vd.nz = normal.z;
+	vd.nx = normalComponents[vs.header.nx];
+	vd.ny = normalComponents[vs.header.ny];
+	vd.nz = normalComponents[vs.header.nz];
 }
 
 static void setModelColors(glm::vec4& baseCol0, glm::vec4& offsetCol0, glm::vec4& baseCol1, glm::vec4& offsetCol1)
@@ -608,91 +611,117 @@ static void setModelColors(glm::vec4& baseCol0, glm::vec4& offsetCol0, glm::vec4
 		offsetCol1 = gmpSpecularColor1;
 }
 
+// packColor(unpackColor(c)) for a single 8-bit component
+static const std::array<u8, 256> colorComponents = []() {
+	std::array<u8, 256> lut;
+	for (int i = 0; i < 256; i++)
+		lut[i] = (u8)(int)(std::min(1.f, (float)i / 255.f) * 255.f);
+	return lut;
+}();
+
+static u32 convertColor(u32 argb)
+{
+	u32 a = colorComponents[argb >> 24];
+	u32 r = colorComponents[(argb >> 16) & 0xff];
+	u32 g = colorComponents[(argb >> 8) & 0xff];
+	u32 b = colorComponents[argb & 0xff];
+	if (packColor == packColorRGBA)
+		return r | (g << 8) | (b << 16) | (a << 24);
+	else
+		return (a << 24) | (r << 16) | (g << 8) | b;
+}
+
+// Packed vertex colors, constant for the whole list unless the vertices have their own base colors
+// and the global model parameters don't override them.
+struct ModelColors
+{
+	ModelColors()
+	{
+		glm::vec4 baseCol0(1);
+		glm::vec4 offsetCol0(0);
+		glm::vec4 baseCol1(1);
+		glm::vec4 offsetCol1(0);
+		setModelColors(baseCol0, offsetCol0, baseCol1, offsetCol1);
+		col = packColor(baseCol0);
+		spc = packColor(offsetCol0);
+		col1 = packColor(baseCol1);
+		spc1 = packColor(offsetCol1);
+		vertexCol0 = curGmp == nullptr || !curGmp->paramSelect.d0;
+		vertexCol1 = curGmp == nullptr || !curGmp->paramSelect.d1;
+	}
+
+	u32 col;
+	u32 spc;
+	u32 col1;
+	u32 spc1;
+	bool vertexCol0;
+	bool vertexCol1;
+};
+
+static void setColors(Vertex& vd, const ModelColors& colors)
+{
+	*(u32 *)vd.col = colors.col;
+	*(u32 *)vd.spc = colors.spc;
+	*(u32 *)vd.col1 = colors.col1;
+	*(u32 *)vd.spc1 = colors.spc1;
+}
+
+template<typename T>
+static void setVertexColors(const T& vs, Vertex& vd, const ModelColors& colors)
+{
+	*(u32 *)vd.col = colors.vertexCol0 ? convertColor(vs.rgb.argb0) : colors.col;
+	*(u32 *)vd.spc = colors.spc;
+	*(u32 *)vd.col1 = colors.vertexCol1 ? convertColor(vs.rgb.argb1) : colors.col1;
+	*(u32 *)vd.spc1 = colors.spc1;
+}
+
 template <typename T>
-static void convertVertex(const T& vs, Vertex& vd);
+static void convertVertex(const T& vs, Vertex& vd, const ModelColors& colors);
 
 template<>
-void convertVertex(const N2_VERTEX& vs, Vertex& vd)
+void convertVertex(const N2_VERTEX& vs, Vertex& vd, const ModelColors& colors)
 {
 	setCoords(vd, vs.x, vs.y, vs.z);
 	setNormal(vd, vs);
 	SetEnvMapUV(vd);
-	glm::vec4 baseCol0(1);
-	glm::vec4 offsetCol0(0);
-	glm::vec4 baseCol1(1);
-	glm::vec4 offsetCol1(0);
-	setModelColors(baseCol0, offsetCol0, baseCol1, offsetCol1);
-
-	*(u32 *)vd.col = packColor(baseCol0);
-	*(u32 *)vd.spc = packColor(offsetCol0);
-	*(u32 *)vd.col1 = packColor(baseCol1);
-	*(u32 *)vd.spc1 = packColor(offsetCol1);
+	setColors(vd, colors);
 }
 
 template<>
-void convertVertex(const N2_VERTEX_VR& vs, Vertex& vd)
+void convertVertex(const N2_VERTEX_VR& vs, Vertex& vd, const ModelColors& colors)
 {
 	setCoords(vd, vs.x, vs.y, vs.z);
 	setNormal(vd, vs);
 	SetEnvMapUV(vd);
-	glm::vec4 baseCol0 = unpackColor(vs.rgb.argb0);
-	glm::vec4 offsetCol0(0);
-	glm::vec4 baseCol1 = unpackColor(vs.rgb.argb1);
-	glm::vec4 offsetCol1(0);
-	setModelColors(baseCol0, offsetCol0, baseCol1, offsetCol1);
-	*(u32 *)vd.col = packColor(baseCol0);
-	*(u32 *)vd.spc = packColor(offsetCol0);
-	*(u32 *)vd.col1 = packColor(baseCol1);
-	*(u32 *)vd.spc1 = packColor(offsetCol1);
+	setVertexColors(vs, vd, colors);
 }
 
 template<>
-void convertVertex(const N2_VERTEX_VU& vs, Vertex& vd)
+void convertVertex(const N2_VERTEX_VU& vs, Vertex& vd, const ModelColors& colors)
 {
 	setCoords(vd, vs.x, vs.y, vs.z);
 	setNormal(vd, vs);
 	setUV(vs, vd);
-	glm::vec4 baseCol0(1);
-	glm::vec4 offsetCol0(0);
-	glm::vec4 baseCol1(1);
-	glm::vec4 offsetCol1(0);
-	setModelColors(baseCol0, offsetCol0, baseCol1, offsetCol1);
-	*(u32 *)vd.col = packColor(baseCol0);
-	*(u32 *)vd.spc = packColor(offsetCol0);
-	*(u32 *)vd.col1 = packColor(baseCol1);
-	*(u32 *)vd.spc1 = packColor(offsetCol1);
+	setColors(vd, colors);
 }
 
 template<>
-void convertVertex(const N2_VERTEX_VUR& vs, Vertex& vd)
+void convertVertex(const N2_VERTEX_VUR& vs, Vertex& vd, const ModelColors& colors)
 {
 	setCoords(vd, vs.x, vs.y, vs.z);
 	setNormal(vd, vs);
 	setUV(vs, vd);
-	glm::vec4 baseCol0 = unpackColor(vs.rgb.argb0);
-	glm::vec4 offsetCol0(0);
-	glm::vec4 baseCol1 = unpackColor(vs.rgb.argb1);
-	glm::vec4 offsetCol1(0);
-	setModelColors(baseCol0, offsetCol0, baseCol1, offsetCol1);
-	*(u32 *)vd.col = packColor(baseCol0);
-	*(u32 *)vd.spc = packColor(offsetCol0);
-	*(u32 *)vd.col1 = packColor(baseCol1);
-	*(u32 *)vd.spc1 = packColor(offsetCol1);
+	setVertexColors(vs, vd, colors);
 }
 
 template<>
-void convertVertex(const N2_VERTEX_VUB& vs, Vertex& vd)
+void convertVertex(const N2_VERTEX_VUB& vs, Vertex& vd, const ModelColors& colors)
 {
 	setCoords(vd, vs.x, vs.y, vs.z);
 	setNormal(vd, vs);
 	setUV(vs, vd);
-	glm::vec4 baseCol0(1);
-	glm::vec4 offsetCol0(0);
-	glm::vec4 baseCol1(1);
-	glm::vec4 offsetCol1(0);
-	setModelColors(baseCol0, offsetCol0, baseCol1, offsetCol1);
-	*(u32 *)vd.col = packColor(baseCol0);
-	*(u32 *)vd.col1 = packColor(baseCol1);
+	*(u32 *)vd.col = colors.col;
+	*(u32 *)vd.col1 = colors.col1;
 	// Stuff the bump map normals and parameters in the specular colors
 	vd.spc[0] = vs.bump.tangent.x;
 	vd.spc[1] = vs.bump.tangent.y;
@@ -714,17 +743,10 @@ void convertVertex(const N2_VERTEX_VUB& vs, Vertex& vd)
 //			);
 }
 
-template <typename T>
-static void boundingBox(const T* vertices, u32 count, glm::vec3& min, glm::vec3& max)
+static VertexBatch vertexBatch;
+
+static void transformBoundingBox(glm::vec3& min, glm::vec3& max)
 {
-	min = { 1e38f, 1e38f, 1e38f };
-	max = { -1e38f, -1e38f, -1e38f };
-	for (u32 i = 0; i < count; i++)
-	{
-		glm::vec3 pos{ vertices[i].x, vertices[i].y, vertices[i].z };
-		min = glm::min(min, pos);
-		max = glm::max(max, pos);
-	}
 	glm::vec4 center((min + max) / 2.f, 1);
 	glm::vec4 extents(max - glm::vec3(center), 0);
 	// transform
@@ -739,12 +761,14 @@ static void boundingBox(const T* vertices, u32 count, glm::vec3& min, glm::vec3&
 	max = glm::vec3(center) + newExtent;
 }
 
+// Also computes the near plane distance of each vertex, used by the clippers
 template <typename T>
 static bool isBetweenNearAndFar(const T* vertices, u32 count, bool& needNearClipping)
 {
-	glm::vec3 min;
-	glm::vec3 max;
-	boundingBox(vertices, count, min, max);
+	vertexBatch.process(vertices, count, curMatrix, nearPlane);
+	glm::vec3 min = vertexBatch.getMin();
+	glm::vec3 max = vertexBatch.getMax();
+	transformBoundingBox(min, max);
 	if (min.z > -nearPlane || max.z < -farPlane)
 		return false;
 
@@ -753,28 +777,30 @@ static bool isBetweenNearAndFar(const T* vertices, u32 count, bool& needNearClip
 	if (std::isnan(pmin.x) || std::isnan(pmin.y) || std::isnan(pmax.x) || std::isnan(pmax.y))
 		return false;
 
-	needNearClipping = max.z > -nearPlane;
+	// The bounding box may cross the near plane even though no vertex is behind it
+	needNearClipping = max.z > -nearPlane && vertexBatch.isBehindNearPlane();
 
 	return true;
 }
 
+// Vertices of the current list, sent to the TA context at once
+static std::vector<Vertex> outVertices;
+
 class TriangleStripClipper
 {
 public:
 	TriangleStripClipper(bool enabled) : enabled(enabled) {}
 
-	void add(const Vertex& vtx)
+	void add(const Vertex& vtx, float dist)
 	{
 		if (enabled)
 		{
-			float z = vtx.x * curMatrix[0][2] + vtx.y * curMatrix[1][2] + vtx.z * curMatrix[2][2] + curMatrix[3][2];
-			float dist = -z - nearPlane;
 			clip(vtx, dist);
 			count++;
 		}
 		else
 		{
-			ta_add_vertex(vtx);
+			outVertices.push_back(vtx);
 		}
 	}
 
@@ -782,9 +808,9 @@ private:
 	void sendVertex(const Vertex& r)
 	{
 		if (dupeNext)
-			ta_add_vertex(r);
+			outVertices.push_back(r);
 		dupeNext = false;
-		ta_add_vertex(r);
+		outVertices.push_back(r);
 	}
 
 	// Three-Dimensional Homogeneous Clipping of Triangle Strips
@@ -904,36 +930,43 @@ private:
 	bool dupeNext = false;
 };
 
+// Near plane distances must have been computed by isBetweenNearAndFar()
 template <typename T>
 static void sendVertices(const ICHList *list, const T* vtx, bool needClipping)
 {
 	Vertex taVtx;
 	verify(list->vertexSize() > 0);
 
+	const ModelColors colors;
 	Vertex fanCenterVtx{};
+	float fanCenterDist = 0.f;
 	Vertex fanLastVtx{};
+	float fanLastDist = 0.f;
 	bool stripStart = true;
 	int outStripIndex = 0;
 	TriangleStripClipper clipper(needClipping);
+	outVertices.clear();
 
 	for (u32 i = 0; i < list->vtxCount; i++)
 	{
-		convertVertex(*vtx, taVtx);
+		convertVertex(*vtx, taVtx, colors);
+		const float dist = vertexBatch.getNearDistance(i);
 
 		if (stripStart)
 		{
 			// Center vertex if triangle fan
 			//verify(vtx->header.isFirstOrSecond()); This fails for some strips: strip=1 fan=0 (soul surfer)
 			fanCenterVtx = taVtx;
+			fanCenterDist = dist;
 			if (outStripIndex > 0)
 			{
 				// use degenerate triangles to link strips
-				clipper.add(fanLastVtx);
-				clipper.add(taVtx);
+				clipper.add(fanLastVtx, fanLastDist);
+				clipper.add(taVtx, dist);
 				outStripIndex += 2;
 				if (outStripIndex & 1)
 				{
-					clipper.add(taVtx);
+					clipper.add(taVtx, dist);
 					outStripIndex++;
 				}
 			}
@@ -942,27 +975,29 @@ static void sendVertices(const ICHList *list, const T* vtx, bool needClipping)
 		else if (vtx->header.isFan())
 		{
 			// use degenerate triangles to link strips
-			clipper.add(fanLastVtx);
-			clipper.add(fanCenterVtx);
+			clipper.add(fanLastVtx, fanLastDist);
+			clipper.add(fanCenterVtx, fanCenterDist);
 			outStripIndex += 2;
 			if (outStripIndex & 1)
 			{
-				clipper.add(fanCenterVtx);
+				clipper.add(fanCenterVtx, fanCenterDist);
 				outStripIndex++;
 			}
 			// Triangle fan
-			clipper.add(fanCenterVtx);
-			clipper.add(fanLastVtx);
+			clipper.add(fanCenterVtx, fanCenterDist);
+			clipper.add(fanLastVtx, fanLastDist);
 			outStripIndex += 2;
 		}
-		clipper.add(taVtx);
+		clipper.add(taVtx, dist);
 		outStripIndex++;
 		fanLastVtx = taVtx;
+		fanLastDist = dist;
 		if (vtx->header.endOfStrip)
 			stripStart = true;
 
 		vtx++;
 	}
+	ta_add_vertices(outVertices.data(), (u32)outVertices.size());
 }
 
 class ModifierVolumeClipper
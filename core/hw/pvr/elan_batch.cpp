@@ -0,0 +1,173 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "elan_batch.h"
+
+#if HOST_CPU == CPU_X86 || HOST_CPU == CPU_X64
+#include <xmmintrin.h>
+#define ELAN_BATCH_SSE
+#elif HOST_CPU == CPU_ARM64 || (HOST_CPU == CPU_ARM && defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define ELAN_BATCH_NEON
+#endif
+
+namespace elan {
+
+static inline const float *vertexAt(const float *positions, size_t stride, u32 index) {
+	return (const float *)((const u8 *)positions + stride * index);
+}
+
+void VertexBatch::processScalar(const float *positions, size_t stride, u32 count, const glm::mat4& modelMatrix, float nearPlane)
+{
+	if (nearDist.size() < count)
+		nearDist.resize(count);
+	min = { 1e38f, 1e38f, 1e38f };
+	max = { -1e38f, -1e38f, -1e38f };
+	behindNear = false;
+	for (u32 i = 0; i < count; i++)
+	{
+		const float *v = vertexAt(positions, stride, i);
+		glm::vec3 pos{ v[0], v[1], v[2] };
+		min = glm::min(min, pos);
+		max = glm::max(max, pos);
+		float z = pos.x * modelMatrix[0][2] + pos.y * modelMatrix[1][2] + pos.z * modelMatrix[2][2] + modelMatrix[3][2];
+		nearDist[i] = -z - nearPlane;
+		behindNear |= nearDist[i] < 0;
+	}
+}
+
+#if defined(ELAN_BATCH_SSE) || defined(ELAN_BATCH_NEON)
+
+void VertexBatch::process(const float *positions, size_t stride, u32 count, const glm::mat4& modelMatrix, float nearPlane)
+{
+	if (nearDist.size() < count)
+		nearDist.resize(count);
+	float *dist = nearDist.data();
+	const u32 batchCount = count & ~3;
+	float minOut[3][4];
+	float maxOut[3][4];
+	bool behind = false;
+
+	// Four vertices at a time, one register per coordinate
+#ifdef ELAN_BATCH_SSE
+	__m128 vmin[3] { _mm_set1_ps(1e38f), _mm_set1_ps(1e38f), _mm_set1_ps(1e38f) };
+	__m128 vmax[3] { _mm_set1_ps(-1e38f), _mm_set1_ps(-1e38f), _mm_set1_ps(-1e38f) };
+	const __m128 mx = _mm_set1_ps(modelMatrix[0][2]);
+	const __m128 my = _mm_set1_ps(modelMatrix[1][2]);
+	const __m128 mz = _mm_set1_ps(modelMatrix[2][2]);
+	const __m128 mw = _mm_set1_ps(modelMatrix[3][2]);
+	const __m128 nearv = _mm_set1_ps(nearPlane);
+	const __m128 signMask = _mm_set1_ps(-0.f);
+	int behindMask = 0;
+	for (u32 i = 0; i < batchCount; i += 4)
+	{
+		const float *v0 = vertexAt(positions, stride, i);
+		const float *v1 = vertexAt(positions, stride, i + 1);
+		const float *v2 = vertexAt(positions, stride, i + 2);
+		const float *v3 = vertexAt(positions, stride, i + 3);
+		__m128 pos[3] {
+			_mm_setr_ps(v0[0], v1[0], v2[0], v3[0]),
+			_mm_setr_ps(v0[1], v1[1], v2[1], v3[1]),
+			_mm_setr_ps(v0[2], v1[2], v2[2], v3[2]),
+		};
+		for (int c = 0; c < 3; c++)
+		{
+			// (pos < min ? pos : min) ignores NaNs like glm::min
+			vmin[c] = _mm_min_ps(pos[c], vmin[c]);
+			vmax[c] = _mm_max_ps(pos[c], vmax[c]);
+		}
+		__m128 z = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(pos[0], mx), _mm_mul_ps(pos[1], my)), _mm_mul_ps(pos[2], mz)), mw);
+		__m128 d = _mm_sub_ps(_mm_xor_ps(z, signMask), nearv);
+		_mm_storeu_ps(&dist[i], d);
+		behindMask |= _mm_movemask_ps(_mm_cmplt_ps(d, _mm_setzero_ps()));
+	}
+	behind = behindMask != 0;
+	for (int c = 0; c < 3; c++)
+	{
+		_mm_storeu_ps(minOut[c], vmin[c]);
+		_mm_storeu_ps(maxOut[c], vmax[c]);
+	}
+#else
+	float32x4_t vmin[3] { vdupq_n_f32(1e38f), vdupq_n_f32(1e38f), vdupq_n_f32(1e38f) };
+	float32x4_t vmax[3] { vdupq_n_f32(-1e38f), vdupq_n_f32(-1e38f), vdupq_n_f32(-1e38f) };
+	const float32x4_t mx = vdupq_n_f32(modelMatrix[0][2]);
+	const float32x4_t my = vdupq_n_f32(modelMatrix[1][2]);
+	const float32x4_t mz = vdupq_n_f32(modelMatrix[2][2]);
+	const float32x4_t mw = vdupq_n_f32(modelMatrix[3][2]);
+	const float32x4_t nearv = vdupq_n_f32(nearPlane);
+	uint32x4_t behindMask = vdupq_n_u32(0);
+	for (u32 i = 0; i < batchCount; i += 4)
+	{
+		const float *v0 = vertexAt(positions, stride, i);
+		const float *v1 = vertexAt(positions, stride, i + 1);
+		const float *v2 = vertexAt(positions, stride, i + 2);
+		const float *v3 = vertexAt(positions, stride, i + 3);
+		float32x4_t pos[3];
+		for (int c = 0; c < 3; c++)
+		{
+			const float lanes[4] { v0[c], v1[c], v2[c], v3[c] };
+			pos[c] = vld1q_f32(lanes);
+			// vminq/vmaxq propagate NaNs, glm::min/max don't
+			vmin[c] = vbslq_f32(vcltq_f32(pos[c], vmin[c]), pos[c], vmin[c]);
+			vmax[c] = vbslq_f32(vcgtq_f32(pos[c], vmax[c]), pos[c], vmax[c]);
+		}
+		// no fused multiply-add to match the scalar code
+		float32x4_t z = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_f32(pos[0], mx), vmulq_f32(pos[1], my)), vmulq_f32(pos[2], mz)), mw);
+		float32x4_t d = vsubq_f32(vnegq_f32(z), nearv);
+		vst1q_f32(&dist[i], d);
+		behindMask = vorrq_u32(behindMask, vcltq_f32(d, vdupq_n_f32(0.f)));
+	}
+	u32 behindLanes[4];
+	vst1q_u32(behindLanes, behindMask);
+	behind = (behindLanes[0] | behindLanes[1] | behindLanes[2] | behindLanes[3]) != 0;
+	for (int c = 0; c < 3; c++)
+	{
+		vst1q_f32(minOut[c], vmin[c]);
+		vst1q_f32(maxOut[c], vmax[c]);
+	}
+#endif
+	for (int c = 0; c < 3; c++)
+	{
+		min[c] = std::min(std::min(minOut[c][0], minOut[c][1]), std::min(minOut[c][2], minOut[c][3]));
+		max[c] = std::max(std::max(maxOut[c][0], maxOut[c][1]), std::max(maxOut[c][2], maxOut[c][3]));
+	}
+
+	// Remaining vertices
+	for (u32 i = batchCount; i < count; i++)
+	{
+		const float *v = vertexAt(positions, stride, i);
+		glm::vec3 pos{ v[0], v[1], v[2] };
+		min = glm::min(min, pos);
+		max = glm::max(max, pos);
+		float z = pos.x * modelMatrix[0][2] + pos.y * modelMatrix[1][2] + pos.z * modelMatrix[2][2] + modelMatrix[3][2];
+		dist[i] = -z - nearPlane;
+		behind |= dist[i] < 0;
+	}
+	behindNear = behind;
+}
+
+#else
+
+void VertexBatch::process(const float *positions, size_t stride, u32 count, const glm::mat4& modelMatrix, float nearPlane)
+{
+	processScalar(positions, stride, count, modelMatrix, nearPlane);
+}
+
+#endif
+
+}
@@ -0,0 +1,56 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "types.h"
+#include <glm/glm.hpp>
+#include <vector>
+
+namespace elan {
+
+//
+// Positions of an ICHList processed in a single pass before the vertices are sent to the TA:
+// bounding box of the untransformed positions and signed distance of each vertex to the near plane
+// (negative if the vertex is behind the near plane).
+//
+class VertexBatch
+{
+public:
+	template<typename T>
+	void process(const T *vertices, u32 count, const glm::mat4& modelMatrix, float nearPlane) {
+		process(&vertices->x, sizeof(T), count, modelMatrix, nearPlane);
+	}
+	// Positions are x, y, z floats, stride is in bytes
+	void process(const float *positions, size_t stride, u32 count, const glm::mat4& modelMatrix, float nearPlane);
+	// Reference implementation
+	void processScalar(const float *positions, size_t stride, u32 count, const glm::mat4& modelMatrix, float nearPlane);
+
+	const glm::vec3& getMin() const { return min; }
+	const glm::vec3& getMax() const { return max; }
+	float getNearDistance(u32 index) const { return nearDist[index]; }
+	// true if at least one vertex is behind the near plane
+	bool isBehindNearPlane() const { return behindNear; }
+
+private:
+	std::vector<float> nearDist;
+	glm::vec3 min;
+	glm::vec3 max;
+	bool behindNear = false;
+};
+
+}
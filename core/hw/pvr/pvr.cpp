@@ -25,6 +25,7 @@
 #include "serialize.h"
 #include "pvr_mem.h"
 #include "elan.h"
+#include "ta.h"
 
 // ta.cpp
 extern u8 ta_fsm[2049];	//[2048] stores the current state
@@ -44,6 +45,7 @@ void reset(bool hard)
 	spg_Reset(hard);
 	if (hard)
 		rend_reset();
+	ta_sq_reset();
 	tactx_Term();
 	elan::reset(hard);
 	if (hard)
@@ -62,6 +64,7 @@ void init()
 
 void term()
 {
+	ta_sq_reset();
 	tactx_Term();
 	spg_Term();
 	elan::term();
@@ -69,6 +72,7 @@ void term()
 
 void serialize(Serializer& ser)
 {
+	ta_sq_flush();
 	YUV_serialize(ser);
 
 	ser << pvr_regs;
@@ -89,6 +93,7 @@ void serialize(Serializer& ser)
 
 void deserialize(Deserializer& deser)
 {
+	ta_sq_reset();
 	YUV_deserialize(deser);
 
 	deser >> pvr_regs;
@@ -11,7 +11,13 @@
 #include "hw/holly/holly_intc.h"
 #include "serialize.h"
 
-static u32 pvr_map32(u32 offset32);
+#if HOST_CPU == CPU_X86 || HOST_CPU == CPU_X64
+#include <emmintrin.h>
+#define YUV_SSE
+#elif HOST_CPU == CPU_ARM64 || (HOST_CPU == CPU_ARM && defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define YUV_NEON
+#endif
 
 RamRegion vram;
 
@@ -47,10 +53,10 @@ void YUV_init()
 	YUV_index = 0;
 }
 
-static void YUV_Block8x8(const u8* inuv, const u8* iny, u8* out)
+static void YUV_Block8x8(const u8* inuv, const u8* iny, u8* out, u32 stride)
 {
 	u8* line_out_0=out+0;
-	u8* line_out_1=out+YUV_x_size*2;
+	u8* line_out_1=out+stride;
 
 	for (int y=0;y<8;y+=2)
 	{
@@ -78,29 +84,80 @@ static void YUV_Block8x8(const u8* inuv, const u8* iny, u8* out)
 		iny+=8;
 		inuv+=4;
 
-		line_out_0+=YUV_x_size*4-8*2;
-		line_out_1+=YUV_x_size*4-8*2;
+		line_out_0+=stride*2-8*2;
+		line_out_1+=stride*2-8*2;
 	}
 }
 
-static void YUV_Block384(const u8 *in, u8 *out)
+void YUV_Block384Scalar(const u8 *in, u8 *out, u32 stride)
 {
 	const u8 *inuv = in;
 	const u8 *iny = in + 128;
 	u8* p_out = out;
 
-	YUV_Block8x8(inuv+ 0,iny+  0,p_out);                    //(0,0)
-	YUV_Block8x8(inuv+ 4,iny+64,p_out+8*2);                 //(8,0)
-	YUV_Block8x8(inuv+32,iny+128,p_out+YUV_x_size*8*2);     //(0,8)
-	YUV_Block8x8(inuv+36,iny+192,p_out+YUV_x_size*8*2+8*2); //(8,8)
+	YUV_Block8x8(inuv+ 0,iny+  0,p_out,stride);                 //(0,0)
+	YUV_Block8x8(inuv+ 4,iny+64,p_out+8*2,stride);              //(8,0)
+	YUV_Block8x8(inuv+32,iny+128,p_out+stride*8,stride);        //(0,8)
+	YUV_Block8x8(inuv+36,iny+192,p_out+stride*8+8*2,stride);    //(8,8)
 }
 
+#if defined(YUV_SSE)
+
+void YUV_Block384(const u8 *in, u8 *out, u32 stride)
+{
+	const u8 *inu = in;
+	const u8 *inv = in + 64;
+	const u8 *iny = in + 128;
+	for (int y = 0; y < 16; y++, out += stride)
+	{
+		// u and v are shared by 2 lines
+		const int uvOffset = (y / 2) * 8;
+		// left and right 8x8 luma blocks
+		const u8 *yLeft = iny + (y / 8) * 128 + (y % 8) * 8;
+		const __m128i luma = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)yLeft), _mm_loadl_epi64((const __m128i *)(yLeft + 64)));
+		const __m128i uv = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)&inu[uvOffset]), _mm_loadl_epi64((const __m128i *)&inv[uvOffset]));
+		// U Y V Y
+		_mm_storeu_si128((__m128i *)&out[0], _mm_unpacklo_epi8(uv, luma));
+		_mm_storeu_si128((__m128i *)&out[16], _mm_unpackhi_epi8(uv, luma));
+	}
+}
+
+#elif defined(YUV_NEON)
+
+void YUV_Block384(const u8 *in, u8 *out, u32 stride)
+{
+	const u8 *inu = in;
+	const u8 *inv = in + 64;
+	const u8 *iny = in + 128;
+	for (int y = 0; y < 16; y++, out += stride)
+	{
+		// u and v are shared by 2 lines
+		const int uvOffset = (y / 2) * 8;
+		// left and right 8x8 luma blocks
+		const u8 *yLeft = iny + (y / 8) * 128 + (y % 8) * 8;
+		const uint8x16_t luma = vcombine_u8(vld1_u8(yLeft), vld1_u8(yLeft + 64));
+		const uint8x8x2_t uv = vzip_u8(vld1_u8(&inu[uvOffset]), vld1_u8(&inv[uvOffset]));
+		// U Y V Y
+		const uint8x16x2_t uyvy = vzipq_u8(vcombine_u8(uv.val[0], uv.val[1]), luma);
+		vst1q_u8(&out[0], uyvy.val[0]);
+		vst1q_u8(&out[16], uyvy.val[1]);
+	}
+}
+
+#else
+
+void YUV_Block384(const u8 *in, u8 *out, u32 stride) {
+	YUV_Block384Scalar(in, out, stride);
+}
+
+#endif
+
 static void YUV_ConvertMacroBlock(const u8 *datap)
 {
 	//do shit
 	TA_YUV_TEX_CNT++;
 
-	YUV_Block384(datap, &vram[YUV_dest]);
+	YUV_Block384(datap, &vram[YUV_dest], YUV_x_size * 2);
 
 	YUV_dest+=32;
 
@@ -288,7 +345,7 @@ void DYNACALL TAWriteSQ(u32 address, const SQBuffer *sqb)
 
 #define VRAM_BANK_BIT 0x400000
 
-static u32 pvr_map32(u32 offset32)
+u32 pvr_map32(u32 offset32)
 {
 	//64b wide bus is achieved by interleaving the banks every 32 bits
 	const u32 static_bits = VRAM_MASK - (VRAM_BANK_BIT * 2 - 1) + 3;
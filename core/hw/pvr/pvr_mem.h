@@ -12,12 +12,22 @@ void pvr_WriteReg(u32 paddr, u32 data);
 
 void DYNACALL TAWrite(u32 address, const SQBuffer *data, u32 count);
 void DYNACALL TAWriteSQ(u32 address, const SQBuffer *sqb);
+// Batches the store queue bursts sent to the TA until ta_sq_end() is called. Used by the dynarec.
+void ta_sq_begin();
+// Processes the batched bursts and stops batching
+void ta_sq_end();
 
 void YUV_init();
 void YUV_serialize(Serializer& ser);
 void YUV_deserialize(Deserializer& deser);
 void YUV_reset();
+// Converts a 384-byte 4:2:0 macroblock to 16x16 4:2:2 texels. stride is the size of an output line in bytes.
+void YUV_Block384(const u8 *in, u8 *out, u32 stride);
+// Reference implementation
+void YUV_Block384Scalar(const u8 *in, u8 *out, u32 stride);
 
+// Returns the 64-bit vram offset of a 32-bit path address
+u32 pvr_map32(u32 offset32);
 // 32-bit vram path handlers
 template<typename T> T DYNACALL pvr_read32p(u32 addr);
 template<typename T> void DYNACALL pvr_write32p(u32 addr, T data);
@@ -3,9 +3,11 @@
 #include "Renderer_if.h"
 #include "ta.h"
 #include "spg.h"
+#include "hw/mem/addrspace.h"
 #include <map>
 
 bool pal_needs_update=true;
+u64 pal_dirty_banks;		// 16-entry palette banks written since the last palette update
 bool fog_needs_update=true;
 
 u8 pvr_regs[pvr_RegSize];
@@ -106,12 +108,20 @@ static const char *regName(u32 paddr)
 		return it->second;
 }
 
+static bool isTaRegister(u32 addr)
+{
+	return addr == STARTRENDER_addr || (addr >= TA_OL_BASE_addr && addr <= TA_NEXT_OPB_INIT_addr);
+}
+
 u32 pvr_ReadReg(u32 addr)
 {
 	if ((addr & pvr_RegMask) != SPG_STATUS_addr)
 		DEBUG_LOG(PVR, "read %s.%c == %x", regName(addr),
 				((addr >> 26) & 7) == 2 ? 'b' : (addr & 0x2000000) ? '1' : '0',
 						PvrReg(addr, u32));
+	if (isTaRegister(addr & pvr_RegMask))
+		// Batched TA data must be processed first
+		ta_sq_flush();
 	return PvrReg(addr,u32);
 }
 
@@ -122,6 +132,10 @@ void pvr_WriteReg(u32 paddr,u32 data)
 			((paddr >> 26) & 7) == 2 ? 'b' : (paddr & 0x2000000) ? '1' : '0',
 					data);
 
+	if (isTaRegister(addr))
+		// Batched TA data must be processed first
+		ta_sq_flush();
+
 	switch (addr)
 	{
 	case ID_addr:
@@ -131,6 +145,8 @@ void pvr_WriteReg(u32 paddr,u32 data)
 
 	case STARTRENDER_addr:
 		//start render
+		taSqStats.newFrame();
+		addrspace::vramTrackingStats.newFrame();
 		rend_start_render();
 		return;
 
@@ -218,8 +234,8 @@ void pvr_WriteReg(u32 paddr,u32 data)
 		break;
 
 	default:
-		if (addr >= PALETTE_RAM_START_addr && PvrReg(addr,u32) != data)
-			pal_needs_update = true;
+		if (addr >= PALETTE_RAM_START_addr && addr <= PALETTE_RAM_END_addr && PvrReg(addr,u32) != data)
+			pal_dirty_banks |= 1ull << ((addr - PALETTE_RAM_START_addr) / 4 / 16);
 		else if (addr >= FOG_TABLE_START_addr && addr <= FOG_TABLE_END_addr && PvrReg(addr,u32) != data)
 			fog_needs_update = true;
 		break;
@@ -205,9 +205,8 @@ static const HollyInterruptID ListEndInterrupt[5]=
 };
 
 
-static void DYNACALL ta_handle_cmd(u32 trans)
+static void DYNACALL ta_handle_cmd(u32 trans, const Ta_Dma *dat)
 {
-	Ta_Dma* dat=(Ta_Dma*)(ta_tad.thd_data-32);
 
 	u32 cmd = trans>>4;
 	trans&=7;
@@ -505,6 +504,7 @@ static void markObjectListBlocks(int renderPass)
 
 void ta_vtx_ListInit(bool continuation)
 {
+	ta_sq_flush();
 	if (!continuation)
 		taRenderPass = 0;
 	else
@@ -521,32 +521,15 @@ void ta_vtx_ListInit(bool continuation)
 
 void ta_vtx_SoftReset()
 {
+	ta_sq_flush();
 	ta_cur_state = TAS_NS;
 }
 
-static void DYNACALL ta_thd_data32_i(const simd256_t *data)
+// Runs the TA state machine for a 32-byte block of the TA data buffer
+static inline void ta_fsm_step(const simd256_t *data)
 {
-	if (ta_ctx == NULL)
-	{
-		INFO_LOG(PVR, "Warning: data sent to TA prior to ListInit. Ignored");
-		return;
-	}
-	if (ta_tad.End() - ta_tad.thd_root >= (ptrdiff_t)TA_DATA_SIZE)
-	{
-		INFO_LOG(PVR, "Warning: TA data buffer overflow");
-		asic_RaiseInterrupt(holly_MATR_NOMEM);
-		return;
-	}
-
-	simd256_t* dst = (simd256_t*)ta_tad.thd_data;
-
 	// First byte is PCW
 	PCW pcw = *(const PCW*)data;
-	
-	// Copy the TA data
-	*dst = *data;
-
-	ta_tad.thd_data += 32;
 
 	//process TA state
 	u32 state_in = (ta_cur_state << 8) | (pcw.ParaType << 5) | ((pcw.obj_ctrl >> 2) & 31);
@@ -562,34 +545,130 @@ static void DYNACALL ta_thd_data32_i(const simd256_t *data)
 	}
 	else
 	{
-		ta_handle_cmd(trans);
+		ta_handle_cmd(trans, (const Ta_Dma *)data);
 	}
 }
 
-void DYNACALL ta_vtx_data32(const SQBuffer *data)
+// Copies a 32-byte block to the TA data buffer and runs the TA state machine.
+// The caller must check that there is a TA context and room in the buffer.
+static inline void ta_thd_step(const simd256_t *data)
 {
-	ta_thd_data32_i((const simd256_t *)data);
+	simd256_t* dst = (simd256_t*)ta_tad.thd_data;
+
+	// Copy the TA data
+	*dst = *data;
+
+	ta_tad.thd_data += 32;
+
+	ta_fsm_step(dst);
 }
 
-void ta_vtx_data(const SQBuffer *data, u32 size)
+// Checks that a block can be added to the TA data buffer
+static inline bool ta_thd_check()
 {
-	while (size >= 4)
+	if (ta_ctx == NULL)
 	{
-		ta_thd_data32_i((simd256_t *)data);
-		data++;
-		ta_thd_data32_i((simd256_t *)data);
-		data++;
-		ta_thd_data32_i((simd256_t *)data);
-		data++;
-		ta_thd_data32_i((simd256_t *)data);
-		data++;
-		size -= 4;
+		INFO_LOG(PVR, "Warning: data sent to TA prior to ListInit. Ignored");
+		return false;
 	}
+	if (ta_tad.End() - ta_tad.thd_root >= (ptrdiff_t)TA_DATA_SIZE)
+	{
+		INFO_LOG(PVR, "Warning: TA data buffer overflow");
+		asic_RaiseInterrupt(holly_MATR_NOMEM);
+		return false;
+	}
+	return true;
+}
+
+static void DYNACALL ta_thd_data32_i(const simd256_t *data)
+{
+	ta_sq_flush();
+	if (ta_thd_check())
+		ta_thd_step(data);
+}
+
+//
+// Store queue bursts of a run of PREF instructions are batched. The dynarec calls ta_sq_begin()
+// before the first PREF of the run and ta_sq_end() after the last one.
+// The bursts are copied to the TA data buffer of the frame right away, so the buffer overflow
+// interrupt is raised at the same point, but the TA state machine processes them at the end of
+// the run, at the end of a list and before anything else accesses the TA state (DMA, TA registers,
+// render start, savestates). List end interrupts are thus raised at the same time as before.
+//
+static bool taSqBatching;
+static u8 *taSqPending;		// first block not processed by the TA state machine yet
+TaSqStats taSqStats;
+
+void ta_sq_begin()
+{
+	ta_sq_flush();
+	// Elan also writes to the TA context
+	taSqBatching = !settings.platform.isNaomi2();
+}
+
+void ta_sq_end()
+{
+	ta_sq_flush();
+	taSqBatching = false;
+}
+
+void ta_sq_flush()
+{
+	if (taSqPending == nullptr)
+		return;
+	const u8 *data = taSqPending;
+	taSqPending = nullptr;
+	taSqStats.batches++;
+	for (; data < ta_tad.thd_data; data += 32)
+		ta_fsm_step((const simd256_t *)data);
+}
 
+void ta_sq_reset()
+{
+	taSqBatching = false;
+	taSqPending = nullptr;
+}
+
+void DYNACALL ta_vtx_data32(const SQBuffer *data)
+{
+	if (!taSqBatching)
+	{
+		ta_thd_data32_i((const simd256_t *)data);
+		return;
+	}
+	if (!ta_thd_check())
+		return;
+	taSqStats.bursts++;
+	if (taSqPending == nullptr)
+		taSqPending = ta_tad.thd_data;
+	*(simd256_t *)ta_tad.thd_data = *(const simd256_t *)data;
+	ta_tad.thd_data += 32;
+	// The second half of a 64-byte vertex may look like an end of list. Processing early is harmless.
+	if (((const PCW *)data)->ParaType == ParamType_End_Of_List)
+		ta_sq_flush();
+}
+
+void ta_vtx_data(const SQBuffer *data, u32 size)
+{
+	ta_sq_flush();
 	while (size > 0)
 	{
-		ta_thd_data32_i((simd256_t *)data);
-		data++;
-		size--;
+		// Number of blocks that fit in the TA data buffer. They are processed without
+		// checking the context and buffer size for each block.
+		// Blocks are still processed one at a time so interrupts are raised at the same point.
+		ptrdiff_t room = 0;
+		if (ta_ctx != nullptr && ta_tad.thd_data != ta_tad.thd_root)
+			room = ((ptrdiff_t)TA_DATA_SIZE - (ta_tad.thd_data - ta_tad.thd_root)) / 32;
+		if (room <= 0)
+		{
+			ta_thd_data32_i((const simd256_t *)data);
+			data++;
+			size--;
+			continue;
+		}
+		u32 count = std::min(size, (u32)room);
+		size -= count;
+		for (; count > 0; count--)
+			ta_thd_step((const simd256_t *)data++);
 	}
 }
@@ -13,6 +13,29 @@ void ta_vtx_SoftReset();
 
 void DYNACALL ta_vtx_data32(const SQBuffer *data);
 void ta_vtx_data(const SQBuffer *data, u32 size);
+// Processes the store queue bursts batched since ta_sq_begin()
+void ta_sq_flush();
+// Discards the batched bursts
+void ta_sq_reset();
+
+struct TaSqStats
+{
+	void newFrame()
+	{
+		lastBursts = bursts;
+		lastBatches = batches;
+		bursts = 0;
+		batches = 0;
+	}
+
+	// current frame
+	u32 bursts = 0;		// batched store queue bursts
+	u32 batches = 0;	// number of times the batched bursts were processed
+	// last frame
+	u32 lastBursts = 0;
+	u32 lastBatches = 0;
+};
+extern TaSqStats taSqStats;
 
 void ta_parse(TA_context *ctx, bool primRestart);
 
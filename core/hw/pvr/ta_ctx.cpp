@@ -1,4 +1,5 @@
 #include "ta_ctx.h"
+#include "ta.h"
 #include "spg.h"
 #include "cfg/option.h"
 #include "Renderer_if.h"
@@ -19,6 +20,7 @@ static TA_context *tactx_Find(u32 addr, bool allocnew = false);
 
 void SetCurrentTARC(u32 addr)
 {
+	ta_sq_flush();
 	if (addr != TACTX_NONE)
 	{
 		if (ta_ctx)
@@ -413,7 +413,7 @@ void DeserializeTAContext(Deserializer& deser);
 
 void ta_add_poly(const PolyParam& pp);
 void ta_add_poly(int listType, const ModifierVolumeParam& mvp);
-void ta_add_vertex(const Vertex& vtx);
+void ta_add_vertices(const Vertex *vertices, u32 count);
 void ta_add_triangle(const ModTriangle& tri);
 int ta_add_matrix(const float *matrix);
 int ta_add_light(const N2LightModel& light);
@@ -1384,10 +1384,10 @@ void ta_add_poly(int listType, const ModifierVolumeParam& mvp)
 	vd_ctx = nullptr;
 }
 
-void ta_add_vertex(const Vertex& vtx)
+void ta_add_vertices(const Vertex *vertices, u32 count)
 {
-	ta_ctx->rend.verts.push_back(vtx);
-	n2CurrentPP->count++;
+	ta_ctx->rend.verts.insert(ta_ctx->rend.verts.end(), vertices, vertices + count);
+	n2CurrentPP->count += count;
 }
 
 void ta_add_triangle(const ModTriangle& tri)
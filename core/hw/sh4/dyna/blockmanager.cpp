@@ -16,6 +16,7 @@
 #include "hw/sh4/sh4_sched.h"
 #include "hw/sh4/modules/mmu.h"
 #include "oslib/virtmem.h"
+#include "oslib/perf_jit.h"
 
 #if defined(__unix__) && defined(DYNA_OPROF)
 #include <opagent.h>
@@ -191,7 +192,12 @@ void bm_AddBlock(RuntimeBlockInfo* blk)
 		}
 	}
 #endif
-
+	if (perfjit::enabled())
+	{
+		char name[64];
+		snprintf(name, sizeof(name), "sh4:%08X,c:%d,s:%d,h:%d", block->addr, block->guest_cycles, block->guest_opcodes, block->host_opcodes);
+		perfjit::addCode(CC_RW2RX((void*)block->code), block->host_code_size, name);
+	}
 }
 
 void bm_DiscardBlock(RuntimeBlockInfo* block)
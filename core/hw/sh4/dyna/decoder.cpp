@@ -18,6 +18,7 @@
 #include "hw/sh4/modules/mmu.h"
 #include "decoder_opcodes.h"
 #include "cfg/option.h"
+#include <bitset>
 
 #define BLOCK_MAX_SH_OPS_SOFT 500
 #define BLOCK_MAX_SH_OPS_HARD 511
@@ -60,6 +61,38 @@ static void Emit(shilop op, shil_param rd = shil_param(), shil_param rs1 = shil_
 	blk->oplist.push_back(sp);
 }
 
+// Store queue writes of a run of PREF instructions in the block are sent to the TA in a single batch
+static void dec_batchStoreQueueRun()
+{
+	if (mmu_enabled())
+		return;
+	int first = -1;
+	int last = -1;
+	int count = 0;
+	for (int i = 0; i < (int)blk->oplist.size(); i++)
+	{
+		const shil_opcode& op = blk->oplist[i];
+		if (op.op != shop_pref || (op.rs1.is_imm() && (op.rs1.imm_value() & 0xFC000000) != 0xE0000000))
+			continue;
+		if (first == -1)
+			first = i;
+		last = i;
+		count++;
+	}
+	if (count < 2)
+		return;
+	shil_opcode op;
+	op.op = shop_sqflush;
+	op.size = 0;
+	op.guest_offs = blk->oplist[last].guest_offs;
+	op.delay_slot = blk->oplist[last].delay_slot;
+	blk->oplist.insert(blk->oplist.begin() + last + 1, op);
+	op.op = shop_sqbatch;
+	op.guest_offs = blk->oplist[first].guest_offs;
+	op.delay_slot = blk->oplist[first].delay_slot;
+	blk->oplist.insert(blk->oplist.begin() + first, op);
+}
+
 static void dec_fallback(u32 op)
 {
 	shil_opcode opcd;
@@ -947,6 +980,105 @@ void dec_updateBlockCycles(RuntimeBlockInfo *block, u16 op)
 	block->guest_cycles += cycleCounter.countCycles(op);
 }
 
+// Small loops waiting for a memory location or a register to change.
+// The block must branch to itself, not write to memory and not modify
+// any register before reading it, so that all iterations are identical.
+// Memory reads must be from system RAM: hardware registers like the TMU counters
+// can change without a scheduled event.
+// A read address that depends on the registers at block entry can't be checked here.
+// It's returned in address and offset (if any) so that it can be checked at runtime.
+static bool dec_isIdleLoop(shil_param& address, shil_param& offset)
+{
+	if (state.JumpAddr != blk->vaddr || blk->guest_opcodes > 8)
+		return false;
+	if (state.BlockType != BET_StaticJump && state.BlockType != BET_Cond_0 && state.BlockType != BET_Cond_1)
+		return false;
+	if (mmu_enabled())
+		return false;
+
+	std::bitset<sh4_reg_count> read;
+	std::bitset<sh4_reg_count> written;
+	// registers holding a constant loaded in the block
+	std::bitset<sh4_reg_count> constant;
+	u32 constValue[sh4_reg_count];
+	for (const shil_opcode& op : blk->oplist)
+	{
+		switch (op.op)
+		{
+		case shop_readm:
+			{
+				u32 addr;
+				if (op.rs1.is_imm())
+					addr = op.rs1._imm;
+				else if (op.rs1.is_r32i() && constant[op.rs1._reg])
+					addr = constValue[op.rs1._reg];
+				else
+				{
+					// Address only known at runtime. Its registers must not be modified in the block.
+					if (!address.is_null() || !op.rs1.is_r32i() || written[op.rs1._reg]
+							|| (op.rs3.is_reg() && (!op.rs3.is_r32i() || written[op.rs3._reg])))
+						return false;
+					address = op.rs1;
+					offset = op.rs3;
+					break;
+				}
+				if (op.rs3.is_imm())
+					addr += op.rs3._imm;
+				else if (op.rs3.is_r32i() && constant[op.rs3._reg])
+					addr += constValue[op.rs3._reg];
+				else if (!op.rs3.is_null())
+					return false;
+				if (!IsOnRam(addr))
+					return false;
+			}
+			break;
+		case shop_mov32:
+		case shop_jcond:
+		case shop_and:
+		case shop_or:
+		case shop_xor:
+		case shop_not:
+		case shop_add:
+		case shop_sub:
+		case shop_shl:
+		case shop_shr:
+		case shop_sar:
+		case shop_swaplb:
+		case shop_swap:
+		case shop_ext_s8:
+		case shop_ext_s16:
+		case shop_test:
+		case shop_seteq:
+		case shop_setge:
+		case shop_setgt:
+		case shop_setae:
+		case shop_setab:
+			break;
+		default:
+			return false;
+		}
+		for (const shil_param *param : { &op.rs1, &op.rs2, &op.rs3 })
+			if (param->is_reg())
+				for (u32 i = 0; i < param->count(); i++)
+					if (!written[param->_reg + i])
+						read[param->_reg + i] = true;
+		for (const shil_param *param : { &op.rd, &op.rd2 })
+			if (param->is_reg())
+				for (u32 i = 0; i < param->count(); i++)
+				{
+					written[param->_reg + i] = true;
+					constant[param->_reg + i] = false;
+				}
+		if (op.op == shop_mov32 && op.rs1.is_imm() && op.rd.is_r32i())
+		{
+			constant[op.rd._reg] = true;
+			constValue[op.rd._reg] = op.rs1._imm;
+		}
+	}
+
+	return (read & written).none();
+}
+
 bool dec_DecodeBlock(RuntimeBlockInfo* rbi,u32 max_cycles)
 {
 	blk=rbi;
@@ -1050,6 +1182,27 @@ bool dec_DecodeBlock(RuntimeBlockInfo* rbi,u32 max_cycles)
 	}
 
 _end:
+	{
+		shil_param idleAddress;
+		shil_param idleOffset;
+		if (dec_isIdleLoop(idleAddress, idleOffset))
+		{
+			if (idleAddress.is_null())
+				// All reads are from RAM
+				idleAddress = mk_imm(0x0C000000);
+			else if (!idleOffset.is_null())
+			{
+				Emit(shop_add, reg_temp, idleAddress, idleOffset);
+				idleAddress = mk_reg(reg_temp);
+			}
+			// Skip to the next scheduled event when the loop branches back to itself
+			if (state.BlockType == BET_StaticJump)
+				Emit(shop_idle, shil_param(), mk_imm(1), mk_imm(1), 0, idleAddress);
+			else
+				Emit(shop_idle, shil_param(), mk_reg(blk->has_jcond ? reg_pc_dyn : reg_sr_T), mk_imm(state.BlockType & 1), 0, idleAddress);
+		}
+		dec_batchStoreQueueRun();
+	}
 	blk->sh4_code_size=state.cpu.rpc-blk->vaddr;
 	blk->NextBlock=state.NextAddr;
 	blk->BranchBlock=state.JumpAddr;
@@ -22,6 +22,10 @@
 	#define shil_compile(code)
 #elif  SHIL_MODE==1
 #include "hw/sh4/sh4_interrupts.h"
+#include "hw/sh4/sh4_sched.h"
+#include "hw/sh4/sh4_mem.h"
+#include "hw/pvr/pvr_mem.h"
+#include "cfg/option.h"
 	//generate structs ...
 	#define SHIL_START
 	#define SHIL_END
@@ -1146,6 +1150,51 @@ shil_compile
 )
 shil_opc_end()
 
+//shop_idle
+shil_opc(idle)
+shil_canonical
+(
+void,f1,(u32 r1,u32 r2,u32 addr),
+	// r1 == r2 if the block is about to branch to itself
+	// addr is the address polled by the loop, which must be in system RAM
+	if (r1 == r2 && IsOnRam(addr) && config::DynarecIdleSkip)
+		sh4_sched_skip_idle();
+)
+shil_compile
+(
+	shil_cf_arg_u32(rs3);
+	shil_cf_arg_u32(rs2);
+	shil_cf_arg_u32(rs1);
+	shil_cf(f1);
+)
+shil_opc_end()
+
+//shop_sqbatch: start of a run of store queue writes
+shil_opc(sqbatch)
+shil_canonical
+(
+void,f1,(),
+	ta_sq_begin();
+)
+shil_compile
+(
+	shil_cf(f1);
+)
+shil_opc_end()
+
+//shop_sqflush: end of a run of store queue writes
+shil_opc(sqflush)
+shil_canonical
+(
+void,f1,(),
+	ta_sq_end();
+)
+shil_compile
+(
+	shil_cf(f1);
+)
+shil_opc_end()
+
 SHIL_END
 
 
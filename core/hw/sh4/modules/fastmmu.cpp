@@ -38,6 +38,72 @@ static TLB_Entry const *lru_entry;
 static u32 lru_mask;
 static u32 lru_address;
 
+// Direct-mapped cache of 4 KB virtual page translations, tagged with the ASID.
+// Shared pages are cached for each ASID they are used with.
+struct TlbCacheEntry {
+	u32 tag;		// virtual page | ASID | TLB_CACHE_VALID
+	u32 ppn;		// physical page address
+	TLB_Entry entry;	// copied since the UTLB slot can be replaced
+	int utlbSlot;	// UTLB slot the translation comes from, or -1
+	u32 utlbGeneration;
+};
+#define TLB_CACHE_SIZE 4096
+#define TLB_CACHE_VALID 0x100
+static TlbCacheEntry tlb_cache[TLB_CACHE_SIZE];
+// Incremented each time a UTLB slot is written. Invalidates the cached translations of the old entry.
+static u32 utlb_generation[64];
+
+static TlbCacheEntry& tlb_cache_entry(u32 address)
+{
+	return tlb_cache[(address >> 12) & (TLB_CACHE_SIZE - 1)];
+}
+
+static u32 tlb_cache_tag(u32 address)
+{
+	return (address & ~0xfff) | CCN_PTEH.ASID | TLB_CACHE_VALID;
+}
+
+static void tlb_cache_add(u32 address, u32 physAddress, const TLB_Entry *entry, u32 mask)
+{
+	// 1 KB pages can't be cached
+	if (mask == mmu_mask[0])
+		return;
+	TlbCacheEntry& cacheEntry = tlb_cache_entry(address);
+	cacheEntry.tag = tlb_cache_tag(address);
+	cacheEntry.ppn = physAddress & ~0xfff;
+	cacheEntry.entry = *entry;
+	if (entry >= &UTLB[0] && entry < &UTLB[std::size(UTLB)])
+	{
+		cacheEntry.utlbSlot = entry - &UTLB[0];
+		cacheEntry.utlbGeneration = utlb_generation[cacheEntry.utlbSlot];
+	}
+	else
+	{
+		// full_table entries aren't modified until the table is flushed
+		cacheEntry.utlbSlot = -1;
+	}
+}
+
+// Invalidate the cached translations of the given virtual address range, whatever their ASID
+static void tlb_cache_invalidate(u32 address, u32 mask)
+{
+	u32 pages = std::max<u32>(1, (~mask + 1) >> 12);
+	if (pages >= TLB_CACHE_SIZE)
+	{
+		memset(tlb_cache, 0, sizeof(tlb_cache));
+		return;
+	}
+	address &= mask;
+	for (u32 i = 0; i < pages; i++, address += 4_KB)
+	{
+		TlbCacheEntry& cacheEntry = tlb_cache_entry(address);
+		if ((cacheEntry.tag & ~0xfff) == (address & ~0xfff))
+			cacheEntry.tag = 0;
+		if (address >> 31 == 0)
+			mmuAddressLUT[address >> 12] = 0;
+	}
+}
+
 struct TLB_LinkedEntry {
 	TLB_Entry entry;
 	TLB_LinkedEntry *next_entry;
@@ -71,6 +137,7 @@ static void flush_cache()
 {
 	full_table_size = 0;
 	memset(entry_buckets, 0, sizeof(entry_buckets));
+	memset(tlb_cache, 0, sizeof(tlb_cache));
 }
 
 template<u32 size>
@@ -180,6 +247,7 @@ bool UTLB_Sync(u32 entry)
 {
 	TLB_Entry& tlb_entry = UTLB[entry];
 	u32 sz = tlb_entry.Data.SZ1 * 2 + tlb_entry.Data.SZ0;
+	utlb_generation[entry]++;
 
 	tlb_entry.Address.VPN &= mmu_mask[sz] >> 10;
 	tlb_entry.Data.PPN &= mmu_mask[sz] >> 10;
@@ -188,6 +256,8 @@ bool UTLB_Sync(u32 entry)
 	lru_mask = mmu_mask[sz];
 	lru_address = tlb_entry.Address.VPN << 10;
 
+	// the new entry takes precedence over cached translations of the same pages
+	tlb_cache_invalidate(lru_address, lru_mask);
 	cache_entry(tlb_entry);
 
 	if (!mmu_enabled() && (tlb_entry.Address.VPN & (0xFC000000 >> 10)) == (0xE0000000 >> 10))
@@ -201,11 +271,22 @@ bool UTLB_Sync(u32 entry)
 
 void ITLB_Sync(u32 entry)
 {
+	// Instruction translations use the UTLB
 }
 
 //Do a full lookup on the UTLB entry's
 MmuError mmu_full_lookup(u32 va, const TLB_Entry** tlb_entry_ret, u32& rv)
 {
+	const TlbCacheEntry& cacheEntry = tlb_cache_entry(va);
+	if (cacheEntry.tag == tlb_cache_tag(va)
+			&& (cacheEntry.utlbSlot < 0 || cacheEntry.utlbGeneration == utlb_generation[cacheEntry.utlbSlot]))
+	{
+		rv = cacheEntry.ppn | (va & 0xfff);
+		if (tlb_entry_ret != nullptr)
+			*tlb_entry_ret = &cacheEntry.entry;
+
+		return MmuError::NONE;
+	}
 	if (lru_entry != NULL)
 	{
 		if (/*lru_entry->Data.V == 1 && */
@@ -218,6 +299,7 @@ MmuError mmu_full_lookup(u32 va, const TLB_Entry** tlb_entry_ret, u32& rv)
 			rv = (lru_entry->Data.PPN << 10) | (va & ~lru_mask);
 			if (tlb_entry_ret != nullptr)
 				*tlb_entry_ret = lru_entry;
+			tlb_cache_add(va, rv, lru_entry, lru_mask);
 
 			return MmuError::NONE;
 		}
@@ -233,6 +315,7 @@ MmuError mmu_full_lookup(u32 va, const TLB_Entry** tlb_entry_ret, u32& rv)
 		lru_entry = *tlb_entry_ret;
 		lru_mask = mask;
 		lru_address = ((*tlb_entry_ret)->Address.VPN << 10);
+		tlb_cache_add(va, rv, lru_entry, mask);
 
 		return MmuError::NONE;
 	}
@@ -242,6 +325,7 @@ MmuError mmu_full_lookup(u32 va, const TLB_Entry** tlb_entry_ret, u32& rv)
 	TLB_Entry& entry = UTLB[CCN_MMUCR.URC];
 	if (wince_resolve_address(va, entry))
 	{
+		utlb_generation[CCN_MMUCR.URC]++;
 		CCN_PTEL.reg_data = entry.Data.reg_data;
 		CCN_PTEA.reg_data = entry.Assistance.reg_data;
 		CCN_PTEH.reg_data = entry.Address.reg_data;
@@ -255,6 +339,7 @@ MmuError mmu_full_lookup(u32 va, const TLB_Entry** tlb_entry_ret, u32& rv)
 
 		rv = (entry.Data.PPN << 10) | (va & ~mmu_mask[sz]);
 
+		tlb_cache_invalidate(va, mmu_mask[sz]);
 		cache_entry(entry);
 
 		p_sh4rcb->cntx.cycle_counter -= 164;
@@ -554,6 +554,16 @@ void DYNACALL WriteMem_p4mmr(u32 addr, T data)
 	INFO_LOG(SH4, "Write to P4 mmr not implemented, addr=%x, data=%x", addr, data);
 }
 
+// Module register banks called directly by the dynarec when the address is constant
+template<typename T, typename Bank, Bank& bank>
+T DYNACALL ReadMem_p4mmrBank(u32 addr) {
+	return bank.template read<T>(addr & 0x1FFFFFFF);
+}
+
+template<typename T, typename Bank, Bank& bank>
+void DYNACALL WriteMem_p4mmrBank(u32 addr, T data) {
+	bank.write(addr & 0x1FFFFFFF, data);
+}
 
 //***********
 //On Chip Ram
@@ -638,6 +648,24 @@ void map_area7_init()
 {
 	p4mmr_handler = addrspaceRegisterHandlerTemplate(ReadMem_p4mmr, WriteMem_p4mmr);
 	area7_ocr_handler = addrspaceRegisterHandlerTemplate(ReadMem_area7_OCR, WriteMem_area7_OCR);
+
+#define registerBank(bank, baseAddr) addrspace::registerRegion(p4mmr_handler, 0x1FFFFFFF, baseAddr, baseAddr + 0xFFFF,	\
+		ReadMem_p4mmrBank<u8, decltype(bank), bank>, ReadMem_p4mmrBank<u16, decltype(bank), bank>,		\
+		ReadMem_p4mmrBank<u32, decltype(bank), bank>,													\
+		WriteMem_p4mmrBank<u8, decltype(bank), bank>, WriteMem_p4mmrBank<u16, decltype(bank), bank>,	\
+		WriteMem_p4mmrBank<u32, decltype(bank), bank>)
+
+	registerBank(ccn, CCN_BASE_addr);
+	registerBank(ubc, UBC_BASE_addr);
+	registerBank(bsc, BSC_BASE_addr);
+	registerBank(dmac, DMAC_BASE_addr);
+	registerBank(cpg, CPG_BASE_addr);
+	registerBank(rtc, RTC_BASE_addr);
+	registerBank(intc, INTC_BASE_addr);
+	registerBank(tmu, TMU_BASE_addr);
+	registerBank(sci, SCI_BASE_addr);
+	registerBank(scif, SCIF_BASE_addr);
+#undef registerBank
 }
 
 void map_area7(u32 base)
@@ -1,6 +1,7 @@
 #include "types.h"
 #include "sh4_if.h"
 #include "sh4_sched.h"
+#include "sh4_interpreter.h"
 #include "serialize.h"
 
 #include <algorithm>
@@ -31,6 +32,7 @@ struct sched_list
 };
 
 static u64 sh4_sched_ffb;
+static u64 sh4_sched_idle_cycles;
 static std::vector<sched_list> sch_list;
 static int sh4_sched_next_id = -1;
 
@@ -71,6 +73,20 @@ void sh4_sched_ffts()
 	sh4_sched_ffb += Sh4cntx.sh4_sched_next;
 }
 
+void sh4_sched_skip_idle()
+{
+	// Nothing can happen before the next event is processed at the end of its timeslice
+	int slices = Sh4cntx.sh4_sched_next / SH4_TIMESLICE;
+	u32 skipped = std::max(0, Sh4cntx.cycle_counter);
+	if (slices > 0)
+	{
+		Sh4cntx.sh4_sched_next -= slices * SH4_TIMESLICE;
+		skipped += slices * SH4_TIMESLICE;
+	}
+	Sh4cntx.cycle_counter = 0;
+	sh4_sched_idle_cycles += skipped;
+}
+
 int sh4_sched_register(int tag, sh4_sched_callback* ssc, void *arg)
 {
 	sched_list t{ ssc, arg, tag, -1, -1};
@@ -186,6 +202,13 @@ void sh4_sched_reset(bool hard)
 {
 	if (hard)
 	{
+		if (sh4_sched_idle_cycles != 0)
+		{
+			u64 now = std::max<u64>(1, sh4_sched_now64());
+			INFO_LOG(SH4, "%s: %.1f s of idle loops skipped (%.1f%%)", settings.content.gameId.c_str(),
+					(double)sh4_sched_idle_cycles / SH4_MAIN_CLOCK, sh4_sched_idle_cycles * 100.0 / now);
+			sh4_sched_idle_cycles = 0;
+		}
 		sh4_sched_ffb = 0;
 		sh4_sched_next_id = -1;
 		for (sched_list& sched : sch_list)
@@ -42,6 +42,12 @@ void sh4_sched_request(int id, int cycles);
 void sh4_sched_tick(int cycles);
 
 void sh4_sched_ffts();
+
+/*
+	Called by idle loops. Fast-forwards to the end of the timeslice
+	in which the next event is scheduled.
+*/
+void sh4_sched_skip_idle();
 void sh4_sched_reset(bool hard);
 
 void sh4_sched_serialize(Serializer& ser);
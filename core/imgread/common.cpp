@@ -2,6 +2,7 @@
 #include "hw/gdrom/gdromv3.h"
 #include "cfg/option.h"
 #include "stdclass.h"
+#include "profiler/fc_profiler.h"
 
 Disc* chd_parse(const char* file, std::vector<u8> *digest);
 Disc* gdi_parse(const char* file, std::vector<u8> *digest);
@@ -192,6 +193,7 @@ static u32 createTrackInfoFirstLast(const Track& track, u32 tracknum)
 
 void libGDR_ReadSector(u8 *buff, u32 startSector, u32 sectorCount, u32 sectorSize)
 {
+	FC_PROFILE_SCOPE;
 	if (disc != nullptr)
 		disc->ReadSectors(startSector, sectorCount, buff, sectorSize);
 }
@@ -0,0 +1,379 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#if defined(__unix__) && !defined(__SWITCH__)
+#include "batch.h"
+#include "types.h"
+#include "emulator.h"
+#include "cfg/cfg.h"
+#include "cfg/option.h"
+#include "log/LogManager.h"
+#include "hw/flashrom/nvmem.h"
+#include "hw/mem/addrspace.h"
+#include "hw/pvr/Renderer_if.h"
+#include "hw/pvr/pvr_mem.h"
+#include "hw/pvr/ta.h"
+#include "stdclass.h"
+#include <xxhash.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+void ParseCommandLine(int argc, char *argv[]);
+
+namespace
+{
+
+struct BatchOptions
+{
+	std::string listPath;
+	std::string reportPath;
+	u32 frames = 3600;
+	u32 jobs = 0;
+	u32 timeout = 0;
+};
+
+// Sent by the worker process through a pipe when it's done
+struct ImageResult
+{
+	enum Status : u32 { Crashed, Ok, Error, Timeout };
+
+	Status status;
+	u32 frames;
+	u32 renderedFrames;
+	double seconds;
+	u64 lastFrameHash;
+	u64 framesHash;	// all frame hashes combined
+	char message[256];
+};
+
+// Same as the null renderer but hashes the display lists and framebuffers
+class BatchRenderer : public Renderer
+{
+public:
+	bool Init() override {
+		return true;
+	}
+	void Term() override { }
+
+	void Process(TA_context* ctx) override {
+		ta_parse(ctx, true);
+	}
+
+	bool Render() override
+	{
+		if (pvrrc.isRTT)
+			return false;
+		u64 hash = XXH64(pvrrc.verts.data(), pvrrc.verts.size() * sizeof(Vertex), 0);
+		frameHash = XXH64(pvrrc.idx.data(), pvrrc.idx.size() * sizeof(u32), hash);
+		return true;
+	}
+
+	void RenderFramebuffer(const FramebufferInfo& info) override
+	{
+		const u32 lineSize = (info.fb_r_size.fb_x_size + info.fb_r_size.fb_modulus) * 4;
+		const u32 offset = info.fb_r_sof1 & VRAM_MASK;
+		const u32 size = std::min(lineSize * (info.fb_r_size.fb_y_size + 1), VRAM_SIZE - offset);
+		frameHash = XXH64(&vram[offset], size, info.fb_r_ctrl.full);
+	}
+
+	bool Present() override
+	{
+		renderedFrames++;
+		return true;
+	}
+
+	u64 frameHash = 0;
+	u32 renderedFrames = 0;
+};
+
+}
+
+bool batch_requested(int argc, char *argv[])
+{
+	for (int i = 1; i < argc; i++)
+		if (!strcmp(argv[i], "-batch") || !strcmp(argv[i], "--batch"))
+			return true;
+	return false;
+}
+
+static bool parseOptions(int argc, char *argv[], BatchOptions& options, std::vector<char *>& otherArgs)
+{
+	otherArgs.push_back(argv[0]);
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		if (arg.size() > 2 && arg.substr(0, 2) == "--")
+			arg = arg.substr(1);
+		if (i + 1 >= argc)
+		{
+			ERROR_LOG(BOOT, "batch: missing value for option %s", argv[i]);
+			return false;
+		}
+		if (arg == "-batch")
+			options.listPath = argv[++i];
+		else if (arg == "-report")
+			options.reportPath = argv[++i];
+		else if (arg == "-frames")
+			options.frames = atoi(argv[++i]);
+		else if (arg == "-jobs")
+			options.jobs = atoi(argv[++i]);
+		else if (arg == "-timeout")
+			options.timeout = atoi(argv[++i]);
+		else if (arg == "-config")
+		{
+			otherArgs.push_back(argv[i]);
+			otherArgs.push_back(argv[++i]);
+		}
+		else
+		{
+			ERROR_LOG(BOOT, "batch: unknown option %s", argv[i]);
+			return false;
+		}
+	}
+	otherArgs.push_back(nullptr);
+	if (options.jobs == 0)
+		options.jobs = std::max(1u, std::thread::hardware_concurrency());
+
+	return true;
+}
+
+static std::vector<std::string> readImageList(const std::string& path)
+{
+	std::vector<std::string> images;
+	std::ifstream list(path);
+	std::string line;
+	while (std::getline(list, line))
+	{
+		line = trim_ws(line);
+		if (!line.empty() && line[0] != '#')
+			images.push_back(line);
+	}
+	return images;
+}
+
+static void loadConfig(std::vector<char *>& args)
+{
+	ParseCommandLine((int)args.size() - 1, args.data());
+	config::Settings::instance().reset();
+	LogManager::Shutdown();
+	bool haveConfig = cfgOpen();
+	LogManager::Init();
+	if (haveConfig)
+		config::Settings::instance().load(false);
+
+	// The emulator runs on the main thread and returns after each frame
+	config::ThreadedRendering.override(false);
+	config::AudioBackend.override("null");
+	settings.aica.muteAudio = true;
+}
+
+// Runs in the worker process
+[[noreturn]] static void runImage(const std::string& path, const BatchOptions& options, int fd)
+{
+	// The log writer thread of the parent doesn't exist in this process
+	// and its locks may be held. The old instance is leaked on purpose.
+	LogManager::Init();
+	if (options.timeout != 0)
+		alarm(options.timeout);
+
+	ImageResult result{};
+	try {
+		// Guest memory is a shared memory file: the worker needs its own
+		if (!addrspace::unshare())
+			throw FlycastException("Failed to allocate the guest memory");
+		BatchRenderer *batchRenderer = new BatchRenderer();
+		renderer = batchRenderer;
+		rend_init_renderer();
+
+		emu.loadGame(path.c_str());
+		emu.start();
+		auto start = std::chrono::steady_clock::now();
+		for (; result.frames < options.frames; result.frames++)
+		{
+			emu.render();
+			result.framesHash = XXH64(&batchRenderer->frameHash, sizeof(u64), result.framesHash);
+		}
+		result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		result.renderedFrames = batchRenderer->renderedFrames;
+		result.lastFrameHash = batchRenderer->frameHash;
+		result.status = ImageResult::Ok;
+	} catch (const std::exception& e) {
+		result.status = ImageResult::Error;
+		strncpy(result.message, e.what(), sizeof(result.message) - 1);
+	}
+	if (write(fd, &result, sizeof(result)) != sizeof(result))
+		_exit(1);
+	// Skip the emulator shutdown, which would save the flash and vmu files
+	_exit(0);
+}
+
+static const char *statusName(ImageResult::Status status)
+{
+	switch (status)
+	{
+	case ImageResult::Ok:
+		return "ok";
+	case ImageResult::Error:
+		return "error";
+	case ImageResult::Timeout:
+		return "timeout";
+	case ImageResult::Crashed:
+	default:
+		return "crash";
+	}
+}
+
+static void writeReport(FILE *f, const std::vector<std::string>& images, const std::vector<ImageResult>& results)
+{
+	fprintf(f, "image,status,frames,rendered,fps,last_frame_hash,frames_hash,message\n");
+	for (size_t i = 0; i < images.size(); i++)
+	{
+		const ImageResult& r = results[i];
+		std::string message = r.message;
+		std::replace(message.begin(), message.end(), '"', '\'');
+		fprintf(f, "\"%s\",%s,%u,%u,%.1f,%016" PRIx64 ",%016" PRIx64 ",\"%s\"\n", images[i].c_str(), statusName(r.status),
+				r.frames, r.renderedFrames, r.seconds != 0 ? r.frames / r.seconds : 0.0,
+				r.lastFrameHash, r.framesHash, message.c_str());
+	}
+}
+
+int batch_run(int argc, char *argv[])
+{
+	BatchOptions options;
+	std::vector<char *> otherArgs;
+	if (!parseOptions(argc, argv, options, otherArgs))
+		return 2;
+	std::vector<std::string> images = readImageList(options.listPath);
+	if (images.empty())
+	{
+		ERROR_LOG(BOOT, "batch: no image found in %s", options.listPath.c_str());
+		return 2;
+	}
+	// Everything done up to this point is shared with the worker processes
+	loadConfig(otherArgs);
+	// The workers are forked from an initialized emulator. The recompiler code buffers
+	// and the BIOS are shared with this process until a worker writes to them.
+	if (!addrspace::reserve())
+	{
+		ERROR_LOG(BOOT, "batch: failed to reserve the address space");
+		return 2;
+	}
+	emu.init();
+	nvmem::preloadBios();
+	NOTICE_LOG(BOOT, "batch: running %d images for %d frames with %d jobs", (int)images.size(), options.frames, options.jobs);
+
+	struct Job
+	{
+		size_t index;
+		int fd;
+	};
+	std::map<pid_t, Job> jobs;
+	std::vector<ImageResult> results(images.size());
+	size_t next = 0;
+	size_t done = 0;
+	auto start = std::chrono::steady_clock::now();
+	while (done < images.size())
+	{
+		while (next < images.size() && jobs.size() < options.jobs)
+		{
+			int fds[2];
+			if (pipe(fds) != 0)
+				die("pipe failed");
+			fflush(stdout);
+			fflush(stderr);
+			pid_t pid = fork();
+			if (pid == -1)
+				die("fork failed");
+			if (pid == 0)
+			{
+				close(fds[0]);
+				for (const auto& job : jobs)
+					close(job.second.fd);
+				runImage(images[next], options, fds[1]);
+			}
+			close(fds[1]);
+			jobs[pid] = { next, fds[0] };
+			next++;
+		}
+		int status;
+		pid_t pid = waitpid(-1, &status, 0);
+		if (pid == -1)
+		{
+			if (errno == EINTR)
+				continue;
+			die("waitpid failed");
+		}
+		auto it = jobs.find(pid);
+		if (it == jobs.end())
+			continue;
+		ImageResult& result = results[it->second.index];
+		if (read(it->second.fd, &result, sizeof(result)) != sizeof(result))
+		{
+			result = {};
+			if (WIFSIGNALED(status))
+			{
+				result.status = WTERMSIG(status) == SIGALRM ? ImageResult::Timeout : ImageResult::Crashed;
+				strncpy(result.message, strsignal(WTERMSIG(status)), sizeof(result.message) - 1);
+			}
+			else {
+				snprintf(result.message, sizeof(result.message), "exit code %d", WEXITSTATUS(status));
+			}
+		}
+		close(it->second.fd);
+		done++;
+		NOTICE_LOG(BOOT, "batch: [%d/%d] %s: %s %s", (int)done, (int)images.size(), images[it->second.index].c_str(),
+				statusName(result.status), result.message);
+		jobs.erase(it);
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	FILE *report = stdout;
+	if (!options.reportPath.empty())
+	{
+		report = fopen(options.reportPath.c_str(), "w");
+		if (report == nullptr)
+		{
+			ERROR_LOG(BOOT, "batch: can't create report file %s", options.reportPath.c_str());
+			report = stdout;
+		}
+	}
+	writeReport(report, images, results);
+	if (report != stdout)
+		fclose(report);
+
+	size_t failed = std::count_if(results.begin(), results.end(), [](const ImageResult& r) {
+		return r.status != ImageResult::Ok;
+	});
+	NOTICE_LOG(BOOT, "batch: %d images in %.1f s, %d failed", (int)images.size(), seconds, (int)failed);
+
+	return failed == 0 ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,29 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+// Headless batch runner:
+// flycast -batch <list file> [-frames N] [-jobs N] [-timeout seconds] [-report file] [-config ...]
+// Runs each content image listed in the file in its own process without video, audio or input,
+// and reports the speed, frame hashes and status of each image.
+
+// Returns true if the command line requests a batch run
+bool batch_requested(int argc, char *argv[]);
+// Returns the process exit code: 0 if all images ran successfully
+int batch_run(int argc, char *argv[]);
@@ -18,6 +18,9 @@
 
 #if defined(__SWITCH__)
 #include "nswitch.h"
+#else
+#include "batch.h"
+#include "rend/TexCache.h"
 #endif
 
 #if defined(SUPPORT_DISPMANX)
@@ -345,6 +348,16 @@ int main(int argc, char* argv[])
 	INFO_LOG(BOOT, "Config dir is: %s", get_writable_config_path("").c_str());
 	INFO_LOG(BOOT, "Data dir is:   %s", get_writable_data_path("").c_str());
 
+#if !defined(__SWITCH__)
+	if (batch_requested(argc, argv))
+	{
+		common_linux_setup();
+		return batch_run(argc, argv);
+	}
+	if (argc == 3 && !strcmp(argv[1], "-texpack"))
+		return CustomTexture::BuildPack(argv[2]) >= 0 ? 0 : 1;
+#endif
+
 #if defined(USE_SDL)
 	// init video now: on rpi3 it installs a sigsegv handler(?)
 	if (SDL_Init(SDL_INIT_VIDEO) != 0)
@@ -60,6 +60,21 @@ bool region_unlock(void *start, size_t len)
 	return true;
 }
 
+bool renew_shared_memory(void *start, size_t size) {
+	return false;
+}
+
+bool dirty_tracking_init() {
+	return false;
+}
+bool dirty_tracking_start(void *start, size_t len) {
+	return false;
+}
+void dirty_tracking_stop(void *start, size_t len) {
+}
+void dirty_tracking_query(void *start, size_t len, u64 *dirty) {
+}
+
 /*
 static bool region_set_exec(void *start, size_t len)
 {
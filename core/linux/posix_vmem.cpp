@@ -11,6 +11,12 @@
 #include <fcntl.h>
 #include <cerrno>
 #include <unistd.h>
+#ifdef __linux__
+#include <linux/fs.h>
+#include <linux/userfaultfd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
 
 #include "hw/mem/addrspace.h"
 #include "hw/sh4/sh4_if.h"
@@ -86,6 +92,157 @@ bool region_set_exec(void *start, size_t len)
 	return true;
 }
 
+// The write-protect ioctls need the headers of Linux 5.19 or later
+#if defined(__linux__) && defined(UFFDIO_WRITEPROTECT) && defined(UFFD_FEATURE_WP_HUGETLBFS_SHMEM)
+// Linux 6.7+: userfaultfd asynchronous write-protect and the PAGEMAP_SCAN ioctl.
+// Writes to a tracked page are resolved by the kernel without a signal, and only the tracked ranges are affected.
+#ifndef UFFD_FEATURE_WP_ASYNC
+#define UFFD_FEATURE_WP_UNPOPULATED (1 << 13)
+#define UFFD_FEATURE_WP_ASYNC (1 << 15)
+#endif
+#ifndef PAGEMAP_SCAN
+#define PAGE_IS_WRITTEN (1 << 1)
+#define PM_SCAN_WP_MATCHING (1 << 0)
+#define PM_SCAN_CHECK_WPASYNC (1 << 1)
+struct page_region
+{
+	u64 start;
+	u64 end;
+	u64 categories;
+};
+struct pm_scan_arg
+{
+	u64 size;
+	u64 flags;
+	u64 start;
+	u64 end;
+	u64 walk_end;
+	u64 vec;
+	u64 vec_len;
+	u64 max_pages;
+	u64 category_inverted;
+	u64 category_mask;
+	u64 category_anyof_mask;
+	u64 return_mask;
+};
+#define PAGEMAP_SCAN _IOWR('f', 16, struct pm_scan_arg)
+#endif
+#ifndef UFFD_USER_MODE_ONLY
+#define UFFD_USER_MODE_ONLY 1
+#endif
+
+static int uffd = -1;
+static int pagemapFd = -1;
+
+bool dirty_tracking_init()
+{
+	if (uffd != -1)
+		return true;
+	// Only user-mode faults need to be handled, which doesn't require any privilege
+	uffd = syscall(__NR_userfaultfd, O_CLOEXEC | O_NONBLOCK | UFFD_USER_MODE_ONLY);
+	bool supported = uffd != -1;
+	if (supported)
+	{
+		uffdio_api api{};
+		api.api = UFFD_API;
+		api.features = UFFD_FEATURE_WP_ASYNC | UFFD_FEATURE_WP_HUGETLBFS_SHMEM | UFFD_FEATURE_WP_UNPOPULATED;
+		supported = ioctl(uffd, UFFDIO_API, &api) == 0;
+	}
+	if (supported)
+	{
+		pagemapFd = open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC);
+		supported = pagemapFd != -1;
+	}
+	if (!supported)
+	{
+		WARN_LOG(VMEM, "Asynchronous write-protect page tracking isn't supported: errno %d", errno);
+		if (uffd != -1)
+			close(uffd);
+		uffd = -1;
+	}
+	return supported;
+}
+
+bool dirty_tracking_start(void *start, size_t len)
+{
+	uffdio_register reg{};
+	reg.range.start = (uintptr_t)start;
+	reg.range.len = len;
+	reg.mode = UFFDIO_REGISTER_MODE_WP;
+	if (ioctl(uffd, UFFDIO_REGISTER, &reg) != 0)
+	{
+		WARN_LOG(VMEM, "userfaultfd register failed: errno %d", errno);
+		return false;
+	}
+	uffdio_writeprotect wp{};
+	wp.range = reg.range;
+	wp.mode = UFFDIO_WRITEPROTECT_MODE_WP;
+	if (ioctl(uffd, UFFDIO_WRITEPROTECT, &wp) != 0)
+	{
+		WARN_LOG(VMEM, "userfaultfd write-protect failed: errno %d", errno);
+		dirty_tracking_stop(start, len);
+		return false;
+	}
+	return true;
+}
+
+void dirty_tracking_stop(void *start, size_t len)
+{
+	uffdio_range range{ (uintptr_t)start, len };
+	if (ioctl(uffd, UFFDIO_UNREGISTER, &range) != 0)
+		WARN_LOG(VMEM, "userfaultfd unregister failed: errno %d", errno);
+}
+
+void dirty_tracking_query(void *start, size_t len, u64 *dirty)
+{
+	page_region regions[64];
+	pm_scan_arg arg{};
+	arg.size = sizeof(arg);
+	// Write-protect the written pages again
+	arg.flags = PM_SCAN_WP_MATCHING | PM_SCAN_CHECK_WPASYNC;
+	arg.start = (uintptr_t)start;
+	arg.end = (uintptr_t)start + len;
+	arg.vec = (uintptr_t)regions;
+	arg.vec_len = std::size(regions);
+	arg.category_mask = PAGE_IS_WRITTEN;
+	arg.return_mask = PAGE_IS_WRITTEN;
+	while (arg.start < arg.end)
+	{
+		long count = ioctl(pagemapFd, PAGEMAP_SCAN, &arg);
+		if (count < 0)
+		{
+			// Assume everything has been written
+			WARN_LOG(VMEM, "PAGEMAP_SCAN failed: errno %d", errno);
+			for (size_t page = (arg.start - (uintptr_t)start) / PAGE_SIZE; page < len / PAGE_SIZE; page++)
+				dirty[page / 64] |= 1ull << (page % 64);
+			return;
+		}
+		for (long i = 0; i < count; i++)
+			for (u64 addr = regions[i].start; addr < regions[i].end; addr += PAGE_SIZE)
+			{
+				size_t page = (addr - (uintptr_t)start) / PAGE_SIZE;
+				dirty[page / 64] |= 1ull << (page % 64);
+			}
+		// the region vector may be full
+		arg.start = arg.walk_end;
+	}
+}
+
+#else
+
+bool dirty_tracking_init() {
+	return false;
+}
+bool dirty_tracking_start(void *start, size_t len) {
+	return false;
+}
+void dirty_tracking_stop(void *start, size_t len) {
+}
+void dirty_tracking_query(void *start, size_t len, u64 *dirty) {
+}
+
+#endif
+
 static void *mem_region_reserve(void *start, size_t len)
 {
 	void *p = mmap(start, len, PROT_NONE, MAP_PRIVATE | MAP_ANON, -1, 0);
@@ -125,13 +282,15 @@ static int allocate_shared_filemem(unsigned size)
 	fd = ashmem_create_region("RAM", size);
 #else
 	#if !defined(__APPLE__)
-		fd = shm_open("/dcnzorz_mem", O_CREAT | O_EXCL | O_RDWR, S_IREAD | S_IWRITE);
-		shm_unlink("/dcnzorz_mem");
+		// forked processes may allocate their own file at the same time
+		const std::string name = "/dcnzorz_mem_" + std::to_string(getpid());
+		fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IREAD | S_IWRITE);
+		shm_unlink(name.c_str());
 	#endif
 
 	// if shmem does not work (or using OSX) fallback to a regular file on disk
 	if (fd < 0) {
-		std::string path = get_writable_data_path("dcnzorz_mem");
+		std::string path = get_writable_data_path("dcnzorz_mem_" + std::to_string(getpid()));
 		fd = open(path.c_str(), O_CREAT|O_RDWR|O_TRUNC, S_IRWXU|S_IRWXG|S_IRWXO);
 		unlink(path.c_str());
 	}
@@ -154,6 +313,7 @@ static int allocate_shared_filemem(unsigned size)
 // Implement vmem initialization for RAM, ARAM, VRAM and SH4 context, fpcb etc.
 
 int vmem_fd = -1;
+static size_t vmem_size;
 static void *reserved_base;
 static size_t reserved_size;
 
@@ -167,6 +327,7 @@ bool init(void **vmem_base_addr, void **sh4rcb_addr, size_t ramSize)
 	vmem_fd = allocate_shared_filemem(ramSize);
 	if (vmem_fd < 0)
 		return false;
+	vmem_size = ramSize;
 
 	// Now try to allocate a contiguous piece of memory.
 	reserved_size = 512_MB + sizeof(Sh4RCB) + ARAM_SIZE_MAX + 0x10000;
@@ -224,6 +385,20 @@ void ondemand_page(void *address, unsigned size_bytes) {
 	verify(rc);
 }
 
+// Replaces the memory file by a new one, private to this process
+bool renew_shared_memory(void *start, size_t size)
+{
+	if (vmem_fd < 0)
+		return false;
+	int fd = allocate_shared_filemem(vmem_size);
+	if (fd < 0)
+		return false;
+	close(vmem_fd);
+	vmem_fd = fd;
+	// Replace the views of the old file by reserved memory
+	return mmap(start, size, PROT_NONE, MAP_FIXED | MAP_PRIVATE | MAP_ANON, -1, 0) != MAP_FAILED;
+}
+
 // Creates mappings to the underlying file including mirroring sections
 void create_mappings(const Mapping *vmem_maps, unsigned nummaps) {
 	for (unsigned i = 0; i < nummaps; i++) {
@@ -161,27 +161,60 @@ LogManager::LogManager()
 	}
 
 	m_path_cutoff_point = DeterminePathCutOffPoint();
+
+	m_writer = std::thread(&LogManager::WriterThread, this);
 }
 
 LogManager::~LogManager()
 {
+	{
+		std::lock_guard<std::mutex> lock(m_wake_lock);
+		m_stopping = true;
+	}
+	m_wake.notify_one();
+	m_writer.join();
+	Flush();
+
 	// The log window listener pointer is owned by the GUI code.
 	delete m_listeners[LogListener::CONSOLE_LISTENER];
 	delete m_listeners[LogListener::FILE_LISTENER];
 	delete m_listeners[LogListener::IN_MEMORY_LISTENER];
 }
 
-// Return the current time formatted as Minutes:Seconds:Milliseconds
+// Return the time formatted as Minutes:Seconds:Milliseconds
 // in the form 00:00:000.
-static std::string GetTimeFormatted()
+static std::string GetTimeFormatted(double now)
 {
-	double now = os_GetSeconds();
 	u32 minutes = (u32)now / 60;
 	u32 seconds = (u32)now % 60;
 	u32 ms = (now - (u32)now) * 1000;
 	return StringFromFormat("%02d:%02d:%03d", minutes, seconds, ms);
 }
 
+bool LogManager::RateLimiter::Allow(const char* file, int line, double now)
+{
+	const uint64_t second = (uint64_t)now;
+	size_t hash = (size_t)file * 31 + line;
+	hash ^= hash >> 9;
+	std::atomic<uint64_t>& site = m_sites[hash % m_sites.size()];
+	// second in the upper 32 bits, message count in the lower 32 bits
+	uint64_t state = site.load(std::memory_order_relaxed);
+	uint64_t newState;
+	do {
+		if ((state >> 32) != second)
+			newState = (second << 32) | 1;
+		else if ((uint32_t)state >= MaxPerSecond)
+		{
+			m_suppressed.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		else
+			newState = state + 1;
+	} while (!site.compare_exchange_weak(state, newState, std::memory_order_relaxed));
+
+	return true;
+}
+
 void LogManager::Log(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char* file,
 		int line, const char* format, va_list args)
 {
@@ -194,16 +227,71 @@ void LogManager::LogWithFullPath(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE
 	if (!IsEnabled(type, level) || !static_cast<bool>(m_listener_ids))
 		return;
 
+	double now = os_GetSeconds();
+	const bool error = level <= LogTypes::LOG_LEVELS::LERROR;
+	// Errors are never suppressed
+	if (!error && !m_rate_limiter.Allow(file, line, now))
+		return;
+	// The format string and arguments are queued and formatted by the writer thread
+	if (!m_queue.push(level, type, file, line, now, format, args) && error)
+	{
+		// Make room for it
+		Flush();
+		m_queue.push(level, type, file, line, now, format, args);
+	}
+	// The program may be about to crash
+	if (error)
+		Flush();
+}
+
+void LogManager::Dispatch(const LogQueue::Record& record)
+{
 	char temp[MAX_MSGLEN];
-	CharArrayFromFormatV(temp, MAX_MSGLEN, format, args);
+	record.formatMessage(temp, sizeof(temp));
 
 	std::string msg =
-			StringFromFormat("%s %s:%u %c[%s]: %s\n", GetTimeFormatted().c_str(), file,
-					line, LogTypes::LOG_LEVEL_TO_CHAR[(int)level], GetShortName(type), temp);
+			StringFromFormat("%s %s:%u %c[%s]: %s\n", GetTimeFormatted(record.timestamp).c_str(), record.file,
+					record.line, LogTypes::LOG_LEVEL_TO_CHAR[(int)record.level], GetShortName(record.type), temp);
 
 	for (auto listener_id : m_listener_ids)
 		if (m_listeners[listener_id])
-			m_listeners[listener_id]->Log(level, msg.c_str());
+			m_listeners[listener_id]->Log(record.level, msg.c_str());
+}
+
+void LogManager::Flush()
+{
+	std::lock_guard<std::mutex> lock(m_write_lock);
+	LogQueue::Record record;
+	while (m_queue.pop(record))
+		Dispatch(record);
+
+	m_dropped += m_queue.takeDropped();
+	m_suppressed += m_rate_limiter.TakeSuppressed();
+	double now = os_GetSeconds();
+	if ((m_dropped != 0 || m_suppressed != 0) && now - m_last_drop_report >= 1.0)
+	{
+		std::string msg = StringFromFormat("%s W[COMMON]: %d log messages dropped, %d suppressed\n",
+				GetTimeFormatted(now).c_str(), m_dropped, m_suppressed);
+		for (auto listener_id : m_listener_ids)
+			if (m_listeners[listener_id])
+				m_listeners[listener_id]->Log(LogTypes::LOG_LEVELS::LWARNING, msg.c_str());
+		m_dropped = 0;
+		m_suppressed = 0;
+		m_last_drop_report = now;
+	}
+}
+
+void LogManager::WriterThread()
+{
+	std::unique_lock<std::mutex> lock(m_wake_lock);
+	while (!m_stopping)
+	{
+		// Producers never wake this thread up to keep logging cheap
+		m_wake.wait_for(lock, std::chrono::milliseconds(10));
+		lock.unlock();
+		Flush();
+		lock.lock();
+	}
 }
 
 LogTypes::LOG_LEVELS LogManager::GetLogLevel() const
@@ -5,10 +5,15 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <condition_variable>
 #include <cstdarg>
+#include <mutex>
+#include <thread>
 
 #include "BitSet.h"
 #include "Log.h"
+#include "LogQueue.h"
 
 // pure virtual interface
 class LogListener
@@ -53,6 +58,9 @@ public:
   void EnableListener(LogListener::LISTENER id, bool enable);
   bool IsListenerEnabled(LogListener::LISTENER id) const;
 
+  // Writes the queued messages to the listeners
+  void Flush();
+
 private:
   struct LogContainer
   {
@@ -65,9 +73,26 @@ private:
 	  bool m_enable = false;
   };
 
+  // Limits the number of messages per second of each call site
+  class RateLimiter
+  {
+  public:
+	  bool Allow(const char* file, int line, double now);
+	  uint32_t TakeSuppressed() { return m_suppressed.exchange(0); }
+
+  private:
+	  static constexpr uint32_t MaxPerSecond = 100;
+	  // call sites sharing a slot share the same budget
+	  std::array<std::atomic<uint64_t>, 256> m_sites{};
+	  std::atomic<uint32_t> m_suppressed{};
+  };
+
   LogManager();
   ~LogManager();
 
+  void Dispatch(const LogQueue::Record& record);
+  void WriterThread();
+
   LogManager(const LogManager&) = delete;
   LogManager& operator=(const LogManager&) = delete;
   LogManager(LogManager&&) = delete;
@@ -78,4 +103,16 @@ private:
   std::array<LogListener*, LogListener::NUMBER_OF_LISTENERS> m_listeners{};
   BitSet32 m_listener_ids;
   size_t m_path_cutoff_point = 0;
+
+  // Messages are formatted and written by a background thread
+  LogQueue m_queue;
+  RateLimiter m_rate_limiter;
+  std::mutex m_write_lock;
+  std::thread m_writer;
+  std::mutex m_wake_lock;
+  std::condition_variable m_wake;
+  bool m_stopping = false;
+  uint32_t m_dropped = 0;
+  uint32_t m_suppressed = 0;
+  double m_last_drop_report = 0;
 };
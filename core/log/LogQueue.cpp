@@ -0,0 +1,475 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "LogQueue.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+
+enum class ArgType { None, Int, Long, LongLong, SizeT, IntMax, PtrDiff, Double, LongDouble, Pointer, String, Invalid };
+
+struct FormatSpec
+{
+	const char *start;	// points to the '%'
+	size_t length;
+	int stars;			// '*' width and precision arguments
+	int precision;		// -1 if none, StarPrecision if passed as an argument
+	ArgType type;
+};
+
+constexpr int StarPrecision = -2;
+
+bool isDigit(char c) {
+	return c >= '0' && c <= '9';
+}
+
+// Parses the next conversion specification of a printf format string.
+// "%%" is returned as a specification without argument.
+bool nextSpec(const char *&p, FormatSpec& spec)
+{
+	while (*p != '%')
+	{
+		if (*p == '\0')
+			return false;
+		p++;
+	}
+	spec.start = p++;
+	spec.stars = 0;
+	spec.precision = -1;
+	while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0')
+		p++;
+	if (*p == '*') {
+		spec.stars++;
+		p++;
+	}
+	while (isDigit(*p))
+		p++;
+	if (*p == '.')
+	{
+		p++;
+		if (*p == '*') {
+			spec.stars++;
+			spec.precision = StarPrecision;
+			p++;
+		}
+		else
+		{
+			spec.precision = 0;
+			while (isDigit(*p))
+				spec.precision = std::min(spec.precision * 10 + (*p++ - '0'), 0xffff);
+		}
+	}
+	enum { None, Short, Long, LongLong, Size, IntMax, PtrDiff, LongDouble } length = None;
+	switch (*p)
+	{
+	case 'h':
+		length = Short;
+		p += p[1] == 'h' ? 2 : 1;
+		break;
+	case 'l':
+		length = p[1] == 'l' ? LongLong : Long;
+		p += p[1] == 'l' ? 2 : 1;
+		break;
+	case 'z':
+		length = Size;
+		p++;
+		break;
+	case 'j':
+		length = IntMax;
+		p++;
+		break;
+	case 't':
+		length = PtrDiff;
+		p++;
+		break;
+	case 'L':
+		length = LongDouble;
+		p++;
+		break;
+	default:
+		break;
+	}
+	const char conversion = *p;
+	if (conversion != '\0')
+		p++;
+	spec.length = p - spec.start;
+
+	switch (conversion)
+	{
+	case 'd':
+	case 'i':
+	case 'u':
+	case 'o':
+	case 'x':
+	case 'X':
+	case 'c':
+		switch (length)
+		{
+		case None:
+		case Short:
+			spec.type = ArgType::Int;
+			break;
+		case Long:
+			spec.type = conversion == 'c' ? ArgType::Invalid : ArgType::Long;
+			break;
+		case LongLong:
+			spec.type = ArgType::LongLong;
+			break;
+		case Size:
+			spec.type = ArgType::SizeT;
+			break;
+		case IntMax:
+			spec.type = ArgType::IntMax;
+			break;
+		case PtrDiff:
+			spec.type = ArgType::PtrDiff;
+			break;
+		default:
+			spec.type = ArgType::Invalid;
+			break;
+		}
+		break;
+	case 'f':
+	case 'F':
+	case 'e':
+	case 'E':
+	case 'g':
+	case 'G':
+	case 'a':
+	case 'A':
+		spec.type = length == LongDouble ? ArgType::LongDouble : ArgType::Double;
+		break;
+	case 'p':
+		spec.type = ArgType::Pointer;
+		break;
+	case 's':
+		spec.type = length == None ? ArgType::String : ArgType::Invalid;
+		break;
+	case '%':
+		spec.type = spec.length == 2 ? ArgType::None : ArgType::Invalid;
+		break;
+	default:
+		// %n, wide chars, truncated specification...
+		spec.type = ArgType::Invalid;
+		break;
+	}
+	return true;
+}
+
+template<typename T>
+bool put(uint8_t *&out, const uint8_t *end, T v)
+{
+	if (out + sizeof(T) > end)
+		return false;
+	memcpy(out, &v, sizeof(T));
+	out += sizeof(T);
+	return true;
+}
+
+template<typename T>
+T get(const uint8_t *&in)
+{
+	T v;
+	memcpy(&v, in, sizeof(T));
+	in += sizeof(T);
+	return v;
+}
+
+bool captureArgs(LogQueue::Record& record, va_list args)
+{
+	uint8_t *out = record.args;
+	const uint8_t *end = record.args + LogQueue::MaxArgSize;
+	const char *p = record.format;
+	FormatSpec spec;
+	while (nextSpec(p, spec))
+	{
+		int starArg = -1;
+		for (int i = 0; i < spec.stars; i++)
+		{
+			starArg = va_arg(args, int);
+			if (!put(out, end, starArg))
+				return false;
+		}
+		bool fits = true;
+		switch (spec.type)
+		{
+		case ArgType::None:
+			break;
+		case ArgType::Int:
+			fits = put(out, end, va_arg(args, int));
+			break;
+		case ArgType::Long:
+			fits = put(out, end, va_arg(args, long));
+			break;
+		case ArgType::LongLong:
+			fits = put(out, end, va_arg(args, long long));
+			break;
+		case ArgType::SizeT:
+			fits = put(out, end, va_arg(args, size_t));
+			break;
+		case ArgType::IntMax:
+			fits = put(out, end, va_arg(args, intmax_t));
+			break;
+		case ArgType::PtrDiff:
+			fits = put(out, end, va_arg(args, ptrdiff_t));
+			break;
+		case ArgType::Double:
+			fits = put(out, end, va_arg(args, double));
+			break;
+		case ArgType::LongDouble:
+			fits = put(out, end, va_arg(args, long double));
+			break;
+		case ArgType::Pointer:
+			fits = put(out, end, va_arg(args, void *));
+			break;
+		case ArgType::String:
+			{
+				const char *s = va_arg(args, const char *);
+				if (s == nullptr)
+					s = "(null)";
+				// the string doesn't need to be null-terminated if a precision is given
+				int precision = spec.precision == StarPrecision ? starArg : spec.precision;
+				size_t len = precision >= 0 ? strnlen(s, precision) : strlen(s);
+				fits = out + len + 1 <= end;
+				if (fits)
+				{
+					memcpy(out, s, len);
+					out[len] = '\0';
+					out += len + 1;
+				}
+			}
+			break;
+		case ArgType::Invalid:
+			return false;
+		}
+		if (!fits)
+			return false;
+	}
+	record.argSize = (uint32_t)(out - record.args);
+
+	return true;
+}
+
+class MessageWriter
+{
+public:
+	MessageWriter(char *buf, size_t size) : buf(buf), size(size) {
+		buf[0] = '\0';
+	}
+
+	void append(const char *s, size_t len)
+	{
+		len = std::min(len, size - 1 - pos);
+		memcpy(buf + pos, s, len);
+		pos += len;
+		buf[pos] = '\0';
+	}
+
+	template<typename T>
+	void format(const char *spec, int stars, const int *starArgs, T v)
+	{
+		if (pos + 1 >= size)
+			return;
+		int len;
+		// the format is a validated specification extracted from a format string literal
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+#endif
+		if (stars == 0)
+			len = snprintf(buf + pos, size - pos, spec, v);
+		else if (stars == 1)
+			len = snprintf(buf + pos, size - pos, spec, starArgs[0], v);
+		else
+			len = snprintf(buf + pos, size - pos, spec, starArgs[0], starArgs[1], v);
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+		if (len > 0)
+			pos = std::min(pos + len, size - 1);
+	}
+
+	size_t length() const { return pos; }
+
+private:
+	char *buf;
+	size_t size;
+	size_t pos = 0;
+};
+
+}
+
+size_t LogQueue::Record::formatMessage(char *buf, size_t size) const
+{
+	MessageWriter writer(buf, size);
+	if (preformatted)
+	{
+		const char *text = longMessage ? longMessage.get() : (const char *)args;
+		writer.append(text, strlen(text));
+		return writer.length();
+	}
+	const uint8_t *in = args;
+	const char *p = format;
+	const char *literal = format;
+	FormatSpec spec;
+	while (nextSpec(p, spec))
+	{
+		writer.append(literal, spec.start - literal);
+		literal = p;
+		int starArgs[2];
+		for (int i = 0; i < spec.stars; i++)
+			starArgs[i] = get<int>(in);
+		char specStr[32];
+		if (spec.length >= sizeof(specStr))
+			// not a sensible specification
+			return writer.length();
+		memcpy(specStr, spec.start, spec.length);
+		specStr[spec.length] = '\0';
+
+		switch (spec.type)
+		{
+		case ArgType::None:
+			writer.append("%", 1);
+			break;
+		case ArgType::Int:
+			writer.format(specStr, spec.stars, starArgs, get<int>(in));
+			break;
+		case ArgType::Long:
+			writer.format(specStr, spec.stars, starArgs, get<long>(in));
+			break;
+		case ArgType::LongLong:
+			writer.format(specStr, spec.stars, starArgs, get<long long>(in));
+			break;
+		case ArgType::SizeT:
+			writer.format(specStr, spec.stars, starArgs, get<size_t>(in));
+			break;
+		case ArgType::IntMax:
+			writer.format(specStr, spec.stars, starArgs, get<intmax_t>(in));
+			break;
+		case ArgType::PtrDiff:
+			writer.format(specStr, spec.stars, starArgs, get<ptrdiff_t>(in));
+			break;
+		case ArgType::Double:
+			writer.format(specStr, spec.stars, starArgs, get<double>(in));
+			break;
+		case ArgType::LongDouble:
+			writer.format(specStr, spec.stars, starArgs, get<long double>(in));
+			break;
+		case ArgType::Pointer:
+			writer.format(specStr, spec.stars, starArgs, get<void *>(in));
+			break;
+		case ArgType::String:
+			{
+				const char *s = (const char *)in;
+				writer.format(specStr, spec.stars, starArgs, s);
+				in += strlen(s) + 1;
+			}
+			break;
+		case ArgType::Invalid:
+			// never captured
+			return writer.length();
+		}
+	}
+	writer.append(literal, strlen(literal));
+
+	return writer.length();
+}
+
+LogQueue::LogQueue()
+{
+	for (size_t i = 0; i < Capacity; i++)
+		slots[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+bool LogQueue::push(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char *file, int line,
+		double timestamp, const char *format, va_list args)
+{
+	size_t pos = enqueuePos.load(std::memory_order_relaxed);
+	Slot *slot;
+	while (true)
+	{
+		slot = &slots[pos & (Capacity - 1)];
+		size_t sequence = slot->sequence.load(std::memory_order_acquire);
+		intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+		if (diff == 0)
+		{
+			if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if (diff < 0)
+		{
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		else
+		{
+			pos = enqueuePos.load(std::memory_order_relaxed);
+		}
+	}
+	Record& record = slot->record;
+	record.level = level;
+	record.type = type;
+	record.file = file;
+	record.line = line;
+	record.format = format;
+	record.timestamp = timestamp;
+
+	va_list argsCopy;
+	va_copy(argsCopy, args);
+	record.preformatted = !captureArgs(record, argsCopy);
+	va_end(argsCopy);
+	record.longMessage.reset();
+	if (record.preformatted)
+	{
+		// rare: only copy the message out of the slot if it's too long
+		char buf[MaxMessageSize];
+		int len = vsnprintf(buf, sizeof(buf), format, args);
+		if (len < 0)
+			buf[0] = '\0';
+		len = std::min<int>(std::max(len, 0), sizeof(buf) - 1);
+		if ((size_t)len < MaxArgSize) {
+			memcpy(record.args, buf, len + 1);
+		}
+		else
+		{
+			record.longMessage.reset(new char[len + 1]);
+			memcpy(record.longMessage.get(), buf, len + 1);
+		}
+		record.argSize = (uint32_t)std::min<size_t>(len + 1, MaxArgSize);
+	}
+	slot->sequence.store(pos + 1, std::memory_order_release);
+
+	return true;
+}
+
+bool LogQueue::pop(Record& record)
+{
+	Slot& slot = slots[dequeuePos & (Capacity - 1)];
+	size_t sequence = slot.sequence.load(std::memory_order_acquire);
+	if ((intptr_t)sequence - (intptr_t)(dequeuePos + 1) < 0)
+		return false;
+	record = std::move(slot.record);
+	slot.sequence.store(dequeuePos + Capacity, std::memory_order_release);
+	dequeuePos++;
+
+	return true;
+}
@@ -0,0 +1,82 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "Log.h"
+
+#include <atomic>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+//
+// Bounded lock-free queue of log records, multiple producers and a single consumer.
+// Producers only capture the format string pointer and a binary copy of the arguments:
+// the message is formatted by the consumer.
+//
+class LogQueue
+{
+public:
+	static constexpr size_t Capacity = 512;	// must be a power of 2
+	static constexpr size_t MaxArgSize = 480;
+	// Longest message formatted by the producer when the arguments can't be captured
+	static constexpr size_t MaxMessageSize = 1024;
+
+	struct Record
+	{
+		LogTypes::LOG_LEVELS level;
+		LogTypes::LOG_TYPE type;
+		const char *file;
+		int line;
+		const char *format;
+		double timestamp;
+		uint32_t argSize;
+		// the arguments didn't fit and the message has been formatted by the producer
+		bool preformatted;
+		alignas(16) uint8_t args[MaxArgSize];
+		// preformatted message that didn't fit in args
+		std::unique_ptr<char[]> longMessage;
+
+		// Formats the message into buf. Returns the length of the message.
+		size_t formatMessage(char *buf, size_t size) const;
+	};
+
+	LogQueue();
+
+	// Returns false if the queue is full
+	bool push(LogTypes::LOG_LEVELS level, LogTypes::LOG_TYPE type, const char *file, int line,
+			double timestamp, const char *format, va_list args);
+	// Single consumer. Returns false if the queue is empty.
+	bool pop(Record& record);
+
+	// Number of records dropped because the queue was full
+	uint32_t takeDropped() { return dropped.exchange(0); }
+
+private:
+	struct alignas(64) Slot
+	{
+		std::atomic<size_t> sequence;
+		Record record;
+	};
+
+	Slot slots[Capacity];
+	alignas(64) std::atomic<size_t> enqueuePos { 0 };
+	alignas(64) size_t dequeuePos = 0;
+	std::atomic<uint32_t> dropped { 0 };
+};
@@ -26,9 +26,7 @@
 #include "stdclass.h"
 
 //#define BBA_PCAPNG_DUMP
-#ifdef BBA_PCAPNG_DUMP
 #include "oslib/oslib.h"
-#endif
 
 #ifdef __MINGW32__
 #define _POSIX_SOURCE
@@ -45,6 +43,9 @@ extern "C" {
 }
 
 #include "net_platform.h"
+#ifndef _WIN32
+#include <poll.h>
+#endif
 
 #include "types.h"
 #include "picoppp.h"
@@ -52,6 +53,8 @@ extern "C" {
 #include "cfg/option.h"
 #include "emulator.h"
 
+#include <algorithm>
+#include <atomic>
 #include <map>
 #include <mutex>
 #include <queue>
@@ -250,7 +253,174 @@ static std::map<uint16_t, sock_t> tcp_listening_sockets;
 static bool pico_thread_running = false;
 extern "C" int dont_reject_opt_vj_hack;
 
-static void read_native_sockets();
+// Waits for events on a set of native sockets
+class SocketPoller
+{
+public:
+	void clear()
+	{
+#ifndef _WIN32
+		fds.clear();
+#else
+		FD_ZERO(&readFds);
+		FD_ZERO(&writeFds);
+		FD_ZERO(&errorFds);
+		empty = true;
+#endif
+	}
+
+	void add(sock_t fd, bool write = false)
+	{
+#ifndef _WIN32
+		pollfd pfd{};
+		pfd.fd = fd;
+		pfd.events = write ? POLLOUT : POLLIN;
+		fds.push_back(pfd);
+#else
+		FD_SET(fd, write ? &writeFds : &readFds);
+		FD_SET(fd, &errorFds);
+		empty = false;
+#endif
+	}
+
+	// Returns the number of sockets with pending events, 0 on timeout or -1 on error
+	int wait(int timeoutMs)
+	{
+#ifndef _WIN32
+		return poll(fds.data(), fds.size(), timeoutMs);
+#else
+		timeval tv;
+		tv.tv_sec = timeoutMs / 1000;
+		tv.tv_usec = (timeoutMs % 1000) * 1000;
+		if (empty)
+		{
+			// select fails with an empty set on windows
+			Sleep(timeoutMs);
+			return 0;
+		}
+		return select(0, &readFds, &writeFds, &errorFds, &tv);
+#endif
+	}
+
+	// Socket is readable, writable or has an error
+	bool isReady(sock_t fd) const
+	{
+#ifndef _WIN32
+		for (const pollfd& pfd : fds)
+			if (pfd.fd == fd)
+				return pfd.revents != 0;
+		return false;
+#else
+		return FD_ISSET(fd, &readFds) || FD_ISSET(fd, &writeFds) || FD_ISSET(fd, &errorFds);
+#endif
+	}
+
+private:
+#ifndef _WIN32
+	std::vector<pollfd> fds;
+#else
+	fd_set readFds;
+	fd_set writeFds;
+	fd_set errorFds;
+	bool empty = true;
+#endif
+};
+
+// Wakes up the pico thread when the emulated modem or BBA has data to send.
+// A datagram is sent to a loopback udp socket watched by the socket poller.
+class PicoWakeup
+{
+public:
+	void init()
+	{
+		sock_t s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+		if (!VALID(s))
+		{
+			perror("wakeup socket");
+			return;
+		}
+		sockaddr_in saddr{};
+		saddr.sin_family = AF_INET;
+		saddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		socklen_t saddr_len = sizeof(saddr);
+		if (::bind(s, (sockaddr *)&saddr, saddr_len) < 0
+				|| getsockname(s, (sockaddr *)&addr, &saddr_len) < 0)
+		{
+			perror("wakeup socket bind");
+			closesocket(s);
+			return;
+		}
+		set_non_blocking(s);
+		pending = false;
+		std::lock_guard<std::mutex> _(sockMutex);
+		sock = s;
+	}
+
+	void term()
+	{
+		std::lock_guard<std::mutex> _(sockMutex);
+		if (VALID(sock))
+			closesocket(sock);
+		sock = INVALID_SOCKET;
+	}
+
+	void signal()
+	{
+		if (pending.load(std::memory_order_relaxed))
+			return;
+		// Set before pending is published so that acknowledge() never sees a stale time
+		signalTime = os_GetSeconds();
+		if (pending.exchange(true))
+			return;
+		// Only one signal per acknowledge gets here so the lock is cheap
+		std::lock_guard<std::mutex> _(sockMutex);
+		if (VALID(sock))
+			sendto(sock, "", 1, 0, (const sockaddr *)&addr, sizeof(addr));
+	}
+
+	// Returns the wake up latency in seconds, or a negative value if no wake up was requested
+	double acknowledge()
+	{
+		if (!pending)
+			return -1.0;
+		double latency = os_GetSeconds() - signalTime;
+		// Drain the socket before clearing the flag. A signal received after this point sends
+		// a new datagram, and the data of a signal received before is handled by this loop iteration.
+		char buf[16];
+		while (recv(sock, buf, sizeof(buf), 0) > 0)
+			;
+		pending = false;
+		return latency;
+	}
+
+	sock_t getSocket() const { return sock; }
+
+private:
+	// signal() is called from the emulator threads
+	std::mutex sockMutex;
+	sock_t sock = INVALID_SOCKET;
+	sockaddr_in addr{};
+	std::atomic<bool> pending { false };
+	std::atomic<double> signalTime { 0.0 };
+};
+static PicoWakeup picoWakeup;
+
+// Event loop statistics, logged when the pico thread stops
+static struct {
+	u32 loops;
+	u32 timeouts;
+	u32 wakeups;
+	double totalLatency;
+	double maxLatency;
+} loopStats;
+
+// Upper bound of the time spent waiting for an event. The loop is otherwise driven by native socket events,
+// data from the emulated device and the next picotcp timer.
+constexpr int MAX_WAIT_MS = 100;
+// Wait time when data is still waiting to be sent to picotcp
+constexpr int RETRY_WAIT_MS = 5;
+
+static void read_native_sockets(const SocketPoller& poller);
 void get_host_by_name(const char *name, pico_ip4 dnsaddr);
 int get_dns_answer(pico_ip4 *address, pico_ip4 dnsaddr);
 
@@ -298,6 +468,7 @@ void write_pico(u8 b)
 	out_buffer_lock.lock();
 	out_buffer.push(b);
 	out_buffer_lock.unlock();
+	picoWakeup.signal();
 }
 
 int read_pico()
@@ -572,7 +743,7 @@ static void udp_callback(uint16_t ev, pico_socket *s)
 	}
 }
 
-static void read_native_sockets()
+static void read_native_sockets(const SocketPoller& poller)
 {
 	int r;
 	sockaddr_in src_addr;
@@ -581,6 +752,8 @@ static void read_native_sockets()
 	// Accept incoming TCP connections
 	for (auto it = tcp_listening_sockets.begin(); it != tcp_listening_sockets.end(); it++)
 	{
+		if (!poller.isReady(it->second))
+			continue;
 		addr_len = sizeof(src_addr);
 		memset(&src_addr, 0, addr_len);
 		sock_t sockfd = accept(it->second, (sockaddr *)&src_addr, &addr_len);
@@ -614,58 +787,37 @@ static void read_native_sockets()
 	}
 
 	// Check connecting outbound TCP sockets
-	fd_set write_fds{};
-	fd_set error_fds{};
-	FD_ZERO(&write_fds);
-	FD_ZERO(&error_fds);
-	int max_fd = -1;
-	for (auto it = tcp_connecting_sockets.begin(); it != tcp_connecting_sockets.end(); it++)
+	for (auto it = tcp_connecting_sockets.begin(); it != tcp_connecting_sockets.end(); )
 	{
-		FD_SET(it->second, &write_fds);
-		FD_SET(it->second, &error_fds);
-		max_fd = std::max(max_fd, (int)it->second);
-	}
-	if (max_fd > -1)
-	{
-		timeval tv{};
-		int rc = select(max_fd + 1, nullptr, &write_fds, &error_fds, &tv);
-		if (rc == -1)
-			perror("select");
-		else if (rc > 0)
+		if (!poller.isReady(it->second))
 		{
-			for (auto it = tcp_connecting_sockets.begin(); it != tcp_connecting_sockets.end(); )
-			{
-				if (!FD_ISSET(it->second, &write_fds) && !FD_ISSET(it->second, &error_fds))
-				{
-					it++;
-					continue;
-				}
-				int error;
+			it++;
+			continue;
+		}
+		int error;
 #ifdef _WIN32
-				char *value = (char *)&error;
+		char *value = (char *)&error;
 #else
-				int *value = &error;
+		int *value = &error;
 #endif
-				socklen_t l = sizeof(int);
-				if (getsockopt(it->second, SOL_SOCKET, SO_ERROR, value, &l) < 0 || error != 0)
-				{
-					char peer[30];
-					pico_ipv4_to_string(peer, it->first->local_addr.ip4.addr);
-					INFO_LOG(MODEM, "TCP connection to %s:%d failed: %s", peer, short_be(it->first->local_port), strerror(get_last_error()));
-					pico_socket_close(it->first);
-					closesocket(it->second);
-				}
-				else
-				{
-					set_tcp_nodelay(it->second);
+		socklen_t l = sizeof(int);
+		if (getsockopt(it->second, SOL_SOCKET, SO_ERROR, value, &l) < 0 || error != 0)
+		{
+			char peer[30];
+			pico_ipv4_to_string(peer, it->first->local_addr.ip4.addr);
+			INFO_LOG(MODEM, "TCP connection to %s:%d failed: %s", peer, short_be(it->first->local_port), strerror(get_last_error()));
+			pico_socket_close(it->first);
+			closesocket(it->second);
+		}
+		else
+		{
+			set_tcp_nodelay(it->second);
 
-					tcp_sockets.try_emplace(it->first, it->first, it->second);
+			tcp_sockets.try_emplace(it->first, it->first, it->second);
 
-					read_from_dc_socket(it->first, it->second);
-				}
-				it = tcp_connecting_sockets.erase(it);
-			}
+			read_from_dc_socket(it->first, it->second);
 		}
+		it = tcp_connecting_sockets.erase(it);
 	}
 
 	static char buf[1500];
@@ -674,7 +826,7 @@ static void read_native_sockets()
 	// Read UDP sockets
 	for (auto it = udp_sockets.begin(); it != udp_sockets.end(); it++)
 	{
-		if (!VALID(it->second))
+		if (!VALID(it->second) || !poller.isReady(it->second))
 			continue;
 
 		addr_len = sizeof(src_addr);
@@ -703,14 +855,55 @@ static void read_native_sockets()
 	// Read TCP sockets
 	for (auto it = tcp_sockets.begin(); it != tcp_sockets.end(); )
 	{
-		it->second.receive_native();
-		if (it->second.pico_sock == nullptr)
+		// Pending data and closed native sockets must be handled even without any new event
+		socket_pair& pair = it->second;
+		if (!pair.in_buffer.empty() || !VALID(pair.native_sock) || poller.isReady(pair.native_sock))
+			pair.receive_native();
+		if (pair.pico_sock == nullptr)
 			it = tcp_sockets.erase(it);
 		else
 			it++;
 	}
 }
 
+// Registers the native sockets to watch and returns how long to wait for events
+static int prepare_poll(SocketPoller& poller)
+{
+	poller.clear();
+	int timeout = MAX_WAIT_MS;
+	if (VALID(picoWakeup.getSocket()))
+		poller.add(picoWakeup.getSocket());
+	else
+		timeout = RETRY_WAIT_MS;
+
+	for (const auto& pair : tcp_listening_sockets)
+		poller.add(pair.second);
+	for (const auto& pair : tcp_connecting_sockets)
+		poller.add(pair.second, true);
+	for (const auto& pair : udp_sockets)
+		if (VALID(pair.second))
+			poller.add(pair.second);
+	for (const auto& pair : tcp_sockets)
+	{
+		if (!pair.second.in_buffer.empty()
+				|| (!VALID(pair.second.native_sock) && !pair.second.shutdown))
+			timeout = RETRY_WAIT_MS;
+		else if (VALID(pair.second.native_sock))
+			poller.add(pair.second.native_sock);
+	}
+	// DNS queries in progress are polled
+	if (public_ip.addr == 0 || afo_ip.addr == 0)
+		timeout = std::min(timeout, RETRY_WAIT_MS);
+	// Frames not processed yet by the stack
+	if (pico_dev != nullptr && (pico_dev->q_in->frames != 0 || pico_dev->q_out->frames != 0))
+		timeout = 0;
+	int32_t nextTimer = pico_timer_next_expire();
+	if (nextTimer >= 0)
+		timeout = std::min(timeout, (int)nextTimer);
+
+	return timeout;
+}
+
 static void close_native_sockets()
 {
 	for (const auto& pair : udp_sockets)
@@ -904,7 +1097,10 @@ void pico_receive_eth_frame(const u8 *frame, u32 size)
 {
 	dumpFrame(frame, size);
 	if (pico_dev != nullptr)
+	{
 		pico_stack_recv(pico_dev, (u8 *)frame, size);
+		picoWakeup.signal();
+	}
 }
 
 static int send_eth_frame(pico_device *dev, void *data, int len)
@@ -1108,13 +1304,36 @@ static void *pico_thread_func(void *)
 		}
 	}
 
+	picoWakeup.init();
+	loopStats = {};
+	SocketPoller poller;
 	while (pico_thread_running)
-    {
-    	read_native_sockets();
-    	pico_stack_tick();
-    	check_dns_entries();
-		PICO_IDLE();
-    }
+	{
+		int timeout = prepare_poll(poller);
+		int rc = poller.wait(timeout);
+		if (rc < 0)
+		{
+			perror("poll");
+			PICO_IDLE();
+		}
+		loopStats.loops++;
+		if (rc == 0)
+			loopStats.timeouts++;
+		double latency = picoWakeup.acknowledge();
+		if (latency >= 0.0)
+		{
+			loopStats.wakeups++;
+			loopStats.totalLatency += latency;
+			loopStats.maxLatency = std::max(loopStats.maxLatency, latency);
+		}
+		read_native_sockets(poller);
+		pico_stack_tick();
+		check_dns_entries();
+	}
+	INFO_LOG(MODEM, "pico thread: %u loops, %u timeouts, %u wakeups, latency avg %.3f ms max %.3f ms",
+			loopStats.loops, loopStats.timeouts, loopStats.wakeups,
+			loopStats.wakeups == 0 ? 0.0 : loopStats.totalLatency * 1000.0 / loopStats.wakeups, loopStats.maxLatency * 1000.0);
+	picoWakeup.term();
 
 	close_native_sockets();
 	pico_socket_del_imm(pico_tcp_socket);
@@ -1,5 +1,7 @@
 #include "audiostream.h"
 #include "cfg/option.h"
+#include "profiler/fc_profiler.h"
+#include <chrono>
 
 struct SoundFrame { s16 l; s16 r; };
 
@@ -8,6 +10,7 @@ static u32 writePtr;  // next sample index
 
 static AudioBackend *currentBackend;
 std::vector<AudioBackend *> *AudioBackend::backends;
+static AudioStream audioStream;
 
 static bool audio_recording_started;
 static bool eight_khz;
@@ -52,12 +55,141 @@ void WriteSample(s16 r, s16 l)
 
 	if (++writePtr == SAMPLE_COUNT)
 	{
-		if (currentBackend != nullptr)
+		if (audioStream.isRunning())
+			audioStream.write(Buffer, SAMPLE_COUNT, config::LimitFPS);
+		else if (currentBackend != nullptr)
 			currentBackend->push(Buffer, SAMPLE_COUNT, config::LimitFPS);
 		writePtr = 0;
 	}
 }
 
+void AudioStream::start(AudioBackend *backend, u32 targetLatency)
+{
+	stop();
+	this->backend = backend;
+	this->targetLatency = std::max(targetLatency, SAMPLE_COUNT);
+	// Room for the target latency plus the frames being written and some headroom
+	fifo.setCapacity((this->targetLatency * 2 + SAMPLE_COUNT) * 4);
+	resampler.reset();
+	resampler.setRatio(1.0);
+	depth = 0;
+	underruns = 0;
+	overruns = 0;
+	avgDepth = 0.f;
+	ratio = 1.f;
+	running = true;
+	thread = std::thread(&AudioStream::run, this);
+}
+
+void AudioStream::stop()
+{
+	if (!running)
+		return;
+	running = false;
+	dataRead.Set();
+	thread.join();
+	AudioStats stats = getStats();
+	INFO_LOG(AUDIO, "Audio stream: %u underruns, %u frames dropped, latency %.1f ms", stats.underruns, stats.overruns, stats.latency);
+}
+
+void AudioStream::write(const void *frames, u32 count, bool wait)
+{
+	if (wait)
+		// The FIFO is drained at the audio device rate
+		while (running && fifoDepth() > targetLatency)
+			dataRead.Wait(50);
+	if (!fifo.write((const u8 *)frames, count * 4))
+		overruns += count;
+}
+
+void AudioStream::run()
+{
+	// Maximum deviation from the nominal rate. Not audible.
+	constexpr double MAX_RATE_DELTA = 0.005;
+	std::vector<s16> input((SAMPLE_COUNT * 2 + Resampler::TAPS) * 2);
+	std::vector<s16> output(SAMPLE_COUNT * 2);
+	bool primed = false;
+	float averageDepth = 0.f;
+	fc_profiler::setThreadName("audio");
+	// Not all backends block in push() until the device needs more samples,
+	// so the thread is also paced by the clock.
+	using the_clock = std::chrono::steady_clock;
+	const the_clock::duration period = std::chrono::duration_cast<the_clock::duration>(
+			std::chrono::duration<double>((double)SAMPLE_COUNT / 44100.0));
+	// how far ahead of the device the backend can be fed
+	const the_clock::duration maxLead = period * (targetLatency / SAMPLE_COUNT);
+	the_clock::time_point deadline = the_clock::now();
+
+	while (running)
+	{
+		FC_PROFILE_SCOPE_NAMED("AudioStream::run");
+		u32 available = fifoDepth();
+		depth = available;
+		u32 produced = 0;
+		if (!primed)
+		{
+			// Wait until the FIFO is half full before resuming playback
+			if (available >= targetLatency / 2)
+			{
+				primed = true;
+				averageDepth = (float)targetLatency;
+			}
+		}
+		if (primed)
+		{
+			averageDepth += (available - averageDepth) * 0.05f;
+			avgDepth = averageDepth;
+			double error = (averageDepth - targetLatency) / targetLatency;
+			// consume more input frames per output frame when the FIFO is above the target
+			double r = 1.0 + std::min(MAX_RATE_DELTA, std::max(-MAX_RATE_DELTA, error * MAX_RATE_DELTA));
+			resampler.setRatio(r);
+			ratio = (float)r;
+
+			u32 needed = std::min<u32>(resampler.inputNeeded(SAMPLE_COUNT), (u32)input.size() / 2);
+			if (needed > available)
+			{
+				underruns++;
+				primed = false;
+				needed = available;
+			}
+			if (needed > 0)
+			{
+				fifo.read((u8 *)input.data(), needed * 4);
+				resampler.write(input.data(), needed);
+			}
+			produced = resampler.read(output.data(), SAMPLE_COUNT);
+		}
+		std::fill(output.begin() + produced * 2, output.end(), 0);
+		dataRead.Set();
+		backend->push(output.data(), SAMPLE_COUNT, true);
+
+		deadline += period;
+		the_clock::time_point now = the_clock::now();
+		if (deadline < now)
+			// push() blocked or the thread was late
+			deadline = now;
+		else if (deadline > now + maxLead)
+			std::this_thread::sleep_until(deadline - maxLead);
+	}
+}
+
+AudioStats AudioStream::getStats() const
+{
+	AudioStats stats;
+	stats.fifoDepth = depth;
+	stats.underruns = underruns;
+	stats.overruns = overruns;
+	stats.latency = (avgDepth + SAMPLE_COUNT) * 1000.f / 44100.f;
+	stats.ratio = ratio;
+
+	return stats;
+}
+
+AudioStats GetAudioStats()
+{
+	return audioStream.getStats();
+}
+
 void InitAudio()
 {
 	TermAudio();
@@ -92,6 +224,9 @@ void InitAudio()
 		return;
 	}
 
+	if (config::AudioDynamicRate)
+		audioStream.start(currentBackend, config::AudioTargetLatency * 44100 / 1000);
+
 	if (audio_recording_started)
 	{
 		// Restart recording
@@ -109,6 +244,7 @@ void TermAudio()
 	bool rec_started = audio_recording_started;
 	StopAudioRecording();
 	audio_recording_started = rec_started;
+	audioStream.stop();
 	currentBackend->term();
 	INFO_LOG(AUDIO, "Terminating audio backend \"%s\" (%s)...", currentBackend->slug.c_str(), currentBackend->name.c_str());
 	currentBackend = nullptr;
@@ -1,10 +1,13 @@
 #pragma once
 #include "types.h"
+#include "stdclass.h"
+#include "resampler.h"
 
 #include <algorithm>
 #include <atomic>
 #include <cstring>
 #include <string>
+#include <thread>
 #include <vector>
 
 class AudioBackend
@@ -75,6 +78,7 @@ class RingBuffer
 	std::atomic_int readCursor { 0 };
 	std::atomic_int writeCursor { 0 };
 
+public:
 	u32 readSize() {
 		return (u32)((writeCursor - readCursor + buffer.size()) % buffer.size());
 	}
@@ -82,7 +86,6 @@ class RingBuffer
 		return (u32)((readCursor - writeCursor + buffer.size() - 1) % buffer.size());
 	}
 
-public:
 	bool write(const u8 *data, u32 size)
 	{
 		if (size > writeSize())
@@ -129,3 +132,53 @@ public:
 		writeCursor = 0;
 	}
 };
+
+struct AudioStats
+{
+	u32 fifoDepth;		// in frames
+	u32 underruns;
+	u32 overruns;		// frames dropped because the FIFO was full
+	float latency;		// FIFO and pending samples, in ms
+	float ratio;		// resampling ratio
+};
+
+//
+// Lock-free FIFO between the AICA and the audio backend.
+// A dedicated thread resamples the FIFO content and pushes it to the backend.
+// The resampling ratio is slightly adjusted so that the FIFO stays around the target latency
+// (dynamic rate control), which avoids underruns when the emulation and audio clocks drift apart.
+//
+class AudioStream
+{
+public:
+	~AudioStream() { stop(); }
+
+	// targetLatency is in frames
+	void start(AudioBackend *backend, u32 targetLatency);
+	void stop();
+	bool isRunning() const { return running; }
+
+	// Called by the emulator. If wait is true, blocks while the FIFO is above the target latency.
+	void write(const void *frames, u32 count, bool wait);
+	AudioStats getStats() const;
+
+private:
+	void run();
+	u32 fifoDepth() { return fifo.readSize() / 4; }
+
+	AudioBackend *backend = nullptr;
+	RingBuffer fifo;
+	Resampler resampler;
+	std::thread thread;
+	cResetEvent dataRead;
+	std::atomic<bool> running { false };
+	u32 targetLatency = 0;
+
+	std::atomic<u32> depth { 0 };
+	std::atomic<u32> underruns { 0 };
+	std::atomic<u32> overruns { 0 };
+	std::atomic<float> avgDepth { 0.f };
+	std::atomic<float> ratio { 1.f };
+};
+
+AudioStats GetAudioStats();
@@ -65,7 +65,7 @@ inline dirent *readdir(DIR *dirstream)
         errno = EINVAL;
         return nullptr;
     }
-    static dirent d;
+    thread_local static dirent d;
 	d.d_ino = wdirent->d_ino;
 	d.d_off = wdirent->d_off;
 	d.d_type = wdirent->d_type;
@@ -0,0 +1,218 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "perf_jit.h"
+#include "cfg/option.h"
+
+#if defined(__linux__) && !defined(__ANDROID__)
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <elf.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace perfjit
+{
+
+// See tools/perf/Documentation/jitdump-specification.txt in the linux kernel tree
+constexpr u32 JITDUMP_MAGIC = 0x4A695444;	// JiTD
+constexpr u32 JITDUMP_VERSION = 1;
+constexpr u32 JIT_CODE_LOAD = 0;
+constexpr u32 JIT_CODE_CLOSE = 3;
+
+struct JitHeader
+{
+	u32 magic;
+	u32 version;
+	u32 totalSize;
+	u32 elfMach;
+	u32 pad1;
+	u32 pid;
+	u64 timestamp;
+	u64 flags;
+};
+
+struct JitRecordHeader
+{
+	u32 id;
+	u32 totalSize;
+	u64 timestamp;
+};
+
+struct JitCodeLoad
+{
+	JitRecordHeader header;
+	u32 pid;
+	u32 tid;
+	u64 vma;
+	u64 codeAddr;
+	u64 codeSize;
+	u64 codeIndex;
+	// followed by the zero-terminated name and the code
+};
+
+static std::mutex mutex;
+static bool opened;
+static FILE *perfMap;
+static FILE *jitDump;
+static void *jitDumpMarker;
+static size_t jitDumpMarkerSize;
+static u64 codeIndex;
+
+// perf record -k 1 uses CLOCK_MONOTONIC
+static u64 timestamp()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (u64)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static u32 elfMachine()
+{
+#if HOST_CPU == CPU_X64
+	return EM_X86_64;
+#elif HOST_CPU == CPU_X86
+	return EM_386;
+#elif HOST_CPU == CPU_ARM64
+	return EM_AARCH64;
+#elif HOST_CPU == CPU_ARM
+	return EM_ARM;
+#else
+	return EM_NONE;
+#endif
+}
+
+static void open()
+{
+	opened = true;
+	const int pid = getpid();
+	char path[64];
+	snprintf(path, sizeof(path), "/tmp/perf-%d.map", pid);
+	perfMap = fopen(path, "w");
+	if (perfMap == nullptr)
+		WARN_LOG(DYNAREC, "Can't create %s: errno %d", path, errno);
+
+	snprintf(path, sizeof(path), "/tmp/jit-%d.dump", pid);
+	int fd = ::open(path, O_CREAT | O_TRUNC | O_RDWR, 0666);
+	if (fd == -1)
+	{
+		WARN_LOG(DYNAREC, "Can't create %s: errno %d", path, errno);
+	}
+	else
+	{
+		// perf finds the jitdump file through this executable mapping
+		jitDumpMarkerSize = sysconf(_SC_PAGESIZE);
+		jitDumpMarker = mmap(nullptr, jitDumpMarkerSize, PROT_READ | PROT_EXEC, MAP_PRIVATE, fd, 0);
+		if (jitDumpMarker == MAP_FAILED)
+		{
+			WARN_LOG(DYNAREC, "jitdump mmap failed: errno %d", errno);
+			jitDumpMarker = nullptr;
+			::close(fd);
+		}
+		else
+		{
+			jitDump = fdopen(fd, "wb");
+			JitHeader header{};
+			header.magic = JITDUMP_MAGIC;
+			header.version = JITDUMP_VERSION;
+			header.totalSize = sizeof(header);
+			header.elfMach = elfMachine();
+			header.pid = pid;
+			header.timestamp = timestamp();
+			fwrite(&header, sizeof(header), 1, jitDump);
+		}
+	}
+	INFO_LOG(DYNAREC, "perf jit map enabled for pid %d", pid);
+}
+
+bool enabled() {
+	return config::DynarecPerfMap;
+}
+
+void addCode(const void *code, u32 size, const char *name)
+{
+	if (!config::DynarecPerfMap || size == 0)
+		return;
+	std::lock_guard<std::mutex> _(mutex);
+	if (!opened)
+		open();
+	if (perfMap != nullptr)
+	{
+		fprintf(perfMap, "%lx %x %s\n", (unsigned long)(uintptr_t)code, size, name);
+		fflush(perfMap);
+	}
+	if (jitDump != nullptr)
+	{
+		const u32 nameLen = strlen(name) + 1;
+		JitCodeLoad record{};
+		record.header.id = JIT_CODE_LOAD;
+		record.header.totalSize = sizeof(record) + nameLen + size;
+		record.header.timestamp = timestamp();
+		record.pid = getpid();
+		record.tid = (u32)syscall(SYS_gettid);
+		record.vma = (uintptr_t)code;
+		record.codeAddr = (uintptr_t)code;
+		record.codeSize = size;
+		record.codeIndex = codeIndex++;
+		fwrite(&record, sizeof(record), 1, jitDump);
+		fwrite(name, nameLen, 1, jitDump);
+		fwrite(code, size, 1, jitDump);
+	}
+}
+
+void close()
+{
+	std::lock_guard<std::mutex> _(mutex);
+	if (perfMap != nullptr)
+		fclose(perfMap);
+	perfMap = nullptr;
+	if (jitDump != nullptr)
+	{
+		JitRecordHeader record{ JIT_CODE_CLOSE, sizeof(JitRecordHeader), timestamp() };
+		fwrite(&record, sizeof(record), 1, jitDump);
+		fclose(jitDump);
+		jitDump = nullptr;
+	}
+	if (jitDumpMarker != nullptr)
+		munmap(jitDumpMarker, jitDumpMarkerSize);
+	jitDumpMarker = nullptr;
+}
+
+}
+
+#else
+
+namespace perfjit
+{
+
+bool enabled() {
+	return false;
+}
+
+void addCode(const void *code, u32 size, const char *name) {
+}
+
+void close() {
+}
+
+}
+
+#endif
@@ -0,0 +1,42 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "types.h"
+
+//
+// Linux perf integration for the JIT compilers (sh4, arm7 and aica dsp).
+// When the Dynarec.PerfMap option is enabled, each generated code block is
+// registered in /tmp/perf-<pid>.map and in a jitdump file (/tmp/jit-<pid>.dump)
+// so that perf can attribute host samples to guest code:
+//     perf record -k 1 ...
+//     perf inject --jit -i perf.data -o perf.jit.data
+//     perf report -i perf.jit.data
+// Neither format has an unload record: discarded blocks are superseded by the next block
+// generated at the same address. The jitdump records are timestamped so perf inject resolves
+// reused addresses correctly, whereas the perf map is only accurate until the code cache is reused.
+//
+namespace perfjit
+{
+
+bool enabled();
+// code is the executable address of the block
+void addCode(const void *code, u32 size, const char *name);
+void close();
+
+}
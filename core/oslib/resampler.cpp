@@ -0,0 +1,150 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "resampler.h"
+#include <algorithm>
+#include <cmath>
+
+constexpr int HALF_TAPS = Resampler::TAPS / 2;
+// Input frames kept before the current position
+constexpr int HISTORY = HALF_TAPS - 1;
+// Cut-off frequency relative to the input Nyquist frequency
+constexpr double CUTOFF = 0.9;
+
+Resampler::Resampler()
+{
+	const double pi = std::acos(-1.0);
+	coefs.resize((PHASES + 1) * TAPS);
+	for (int phase = 0; phase <= PHASES; phase++)
+	{
+		float *c = &coefs[phase * TAPS];
+		double frac = (double)phase / PHASES;
+		double sum = 0;
+		for (int tap = 0; tap < TAPS; tap++)
+		{
+			// distance between the input sample and the output position
+			double x = tap - HISTORY - frac;
+			double sinc = x == 0 ? 1.0 : std::sin(pi * CUTOFF * x) / (pi * CUTOFF * x);
+			double w = x / HALF_TAPS;
+			double window = std::abs(w) >= 1.0 ? 0.0 : 0.42 + 0.5 * std::cos(pi * w) + 0.08 * std::cos(2 * pi * w);
+			c[tap] = (float)(sinc * window);
+			sum += c[tap];
+		}
+		// unity gain at DC
+		for (int tap = 0; tap < TAPS; tap++)
+			c[tap] = (float)(c[tap] / sum);
+	}
+	reset();
+}
+
+void Resampler::reset()
+{
+	if (capacity == 0)
+		capacity = 1024;
+	input.assign(capacity * 4, 0.f);
+	start = 0;
+	// history of silence
+	count = HISTORY;
+	position = HISTORY;
+}
+
+void Resampler::grow(u32 minCapacity)
+{
+	u32 newCapacity = capacity;
+	while (newCapacity < minCapacity)
+		newCapacity *= 2;
+	std::vector<float> newInput(newCapacity * 4);
+	for (u32 i = 0; i < count; i++)
+	{
+		const float *src = &input[((start + i) & (capacity - 1)) * 2];
+		newInput[i * 2] = newInput[(i + newCapacity) * 2] = src[0];
+		newInput[i * 2 + 1] = newInput[(i + newCapacity) * 2 + 1] = src[1];
+	}
+	input = std::move(newInput);
+	capacity = newCapacity;
+	start = 0;
+}
+
+void Resampler::setRatio(double ratio)
+{
+	step = std::min(2.0, std::max(0.5, ratio));
+}
+
+void Resampler::write(const s16 *frames, u32 frameCount)
+{
+	if (count + frameCount > capacity)
+		grow(count + frameCount);
+	const u32 mask = capacity - 1;
+	for (u32 i = 0; i < frameCount; i++, count++)
+	{
+		// each frame is stored twice so that the filter taps are always contiguous
+		float *dst = &input[((start + count) & mask) * 2];
+		dst[0] = dst[capacity * 2] = frames[i * 2];
+		dst[1] = dst[capacity * 2 + 1] = frames[i * 2 + 1];
+	}
+}
+
+u32 Resampler::inputNeeded(u32 outFrames) const
+{
+	if (outFrames == 0)
+		return 0;
+	// last input frame needed by the last output frame
+	double last = position + (outFrames - 1) * step;
+	int needed = (int)last + HALF_TAPS + 1 - (int)count;
+	return (u32)std::max(0, needed);
+}
+
+u32 Resampler::read(s16 *frames, u32 frameCount)
+{
+	const int available = (int)count;
+	const u32 mask = capacity - 1;
+	u32 produced = 0;
+	for (; produced < frameCount; produced++)
+	{
+		int index = (int)position;
+		if (index + HALF_TAPS >= available)
+			break;
+		double frac = (position - index) * PHASES;
+		int phase = (int)frac;
+		float mix = (float)(frac - phase);
+		const float *c0 = &coefs[phase * TAPS];
+		const float *c1 = c0 + TAPS;
+		const float *in = &input[((start + index - HISTORY) & mask) * 2];
+		float l = 0.f;
+		float r = 0.f;
+		for (int tap = 0; tap < TAPS; tap++)
+		{
+			float c = c0[tap] + (c1[tap] - c0[tap]) * mix;
+			l += in[tap * 2] * c;
+			r += in[tap * 2 + 1] * c;
+		}
+		frames[produced * 2] = (s16)std::min(32767.f, std::max(-32768.f, std::round(l)));
+		frames[produced * 2 + 1] = (s16)std::min(32767.f, std::max(-32768.f, std::round(r)));
+		position += step;
+	}
+	// Discard the input frames that are no longer needed
+	int consumed = std::min((int)position - HISTORY, available);
+	if (consumed > 0)
+	{
+		start = (start + consumed) & mask;
+		count -= consumed;
+		position -= consumed;
+	}
+
+	return produced;
+}
@@ -0,0 +1,59 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "types.h"
+#include <vector>
+
+//
+// Stereo 16-bit polyphase resampler using a Blackman-windowed sinc.
+// Meant for ratios close to 1 (dynamic rate control) but works for any ratio in [0.5, 2].
+//
+class Resampler
+{
+public:
+	static constexpr int TAPS = 16;
+	static constexpr int PHASES = 256;
+
+	Resampler();
+	void reset();
+
+	// Number of input frames consumed per output frame
+	void setRatio(double ratio);
+	double getRatio() const { return step; }
+
+	// Adds interleaved stereo input frames
+	void write(const s16 *frames, u32 frameCount);
+	// Number of input frames missing to produce the given number of output frames
+	u32 inputNeeded(u32 outFrames) const;
+	// Produces up to frameCount interleaved stereo frames. Returns the number of frames produced.
+	u32 read(s16 *frames, u32 frameCount);
+
+private:
+	void grow(u32 minCapacity);
+
+	std::vector<float> coefs;	// (PHASES + 1) * TAPS
+	// Ring buffer of interleaved stereo frames. Each frame is stored twice, at index i and i + capacity,
+	// so that the frames used by the filter are contiguous.
+	std::vector<float> input;
+	u32 capacity = 0;			// in frames, power of 2
+	u32 start = 0;				// index of the oldest frame
+	u32 count = 0;				// number of frames in the buffer
+	double position = 0;		// position of the next output frame, relative to the oldest frame
+	double step = 1.0;
+};
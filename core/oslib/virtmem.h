@@ -20,6 +20,10 @@ void ondemand_page(void *address, unsigned size_bytes);
 void create_mappings(const Mapping *vmem_maps, unsigned nummaps);
 // Just tries to wipe as much as possible in the relevant area.
 void destroy();
+// Replaces the memory file by a new one and unmaps the views of the old one in [start, start + size).
+// Used by forked processes, which would otherwise share the memory of their parent.
+// The mappings must be created again.
+bool renew_shared_memory(void *start, std::size_t size);
 // Given a block of data in the .text section, prepares it for JIT action.
 // both code_area and size are page aligned. Returns success.
 bool prepare_jit_block(void *code_area, size_t size, void **code_area_rwx);
@@ -39,4 +43,13 @@ bool region_lock(void *start, std::size_t len);
 bool region_unlock(void *start, std::size_t len);
 bool region_set_exec(void *start, std::size_t len);
 
+// Bulk dirty page tracking, only available on Linux 6.7+ (userfaultfd asynchronous write-protect).
+// Returns false if not supported.
+bool dirty_tracking_init();
+// Starts tracking the writes to [start, start + len). Remapping the range stops the tracking.
+bool dirty_tracking_start(void *start, std::size_t len);
+void dirty_tracking_stop(void *start, std::size_t len);
+// Sets the bit of each page of [start, start + len) written since the last query in the dirty bitmap
+void dirty_tracking_query(void *start, std::size_t len, u64 *dirty);
+
 } // namespace vmem
@@ -7,7 +7,7 @@
 
 namespace fc_profiler
 {
-	thread_local ProfileThread* ProfileScope::s_thread = nullptr;
+	thread_local ProfileThread* ProfileThread::s_thread = nullptr;
 	std::vector<ProfileThread*> ProfileThread::s_allThreads;
 	std::recursive_mutex ProfileThread::s_allThreadsLock;
 
@@ -15,75 +15,77 @@ namespace fc_profiler
 	{
 		if (config::ProfilerEnabled)
 		{
-			if (!ProfileScope::s_thread)
+			if (!ProfileThread::s_thread)
 			{
 				std::unique_lock<std::recursive_mutex> lock(ProfileThread::s_allThreadsLock);
-				ProfileScope::s_thread = new ProfileThread();
-				ProfileThread::s_allThreads.push_back(ProfileScope::s_thread);
+				ProfileThread::s_thread = new ProfileThread();
+				ProfileThread::s_allThreads.push_back(ProfileThread::s_thread);
 			}
+			trace::ThreadBuffer *buffer = trace::threadBuffer;
+			if (buffer == nullptr)
+				buffer = trace::registerThread();
+			buffer->profiled = true;
 
-			ProfileThread& profileThread = *ProfileScope::s_thread;
-			profileThread.scopes.clear();
-			profileThread.scopes.reserve(FC_PROFILE_SCOPE_RESERVE_SIZE);
-			profileThread.level = 0;
+			ProfileThread& profileThread = *ProfileThread::s_thread;
+			profileThread.frameStart = buffer->head.load(std::memory_order_relaxed);
 			profileThread.startTicks = std::chrono::high_resolution_clock::now();
 			profileThread.threadName = threadName;
 		}
 	}
 
+	// Builds the tree of the scopes recorded in the ring buffer since the start of the frame
+	static void buildResultTree(ProfileThread& profileThread)
+	{
+		const trace::ThreadBuffer *buffer = trace::threadBuffer;
+		profileThread.cachedResultTree.clear();
+		if (buffer == nullptr)
+			return;
+		const u32 head = buffer->head.load(std::memory_order_relaxed);
+		if (head - profileThread.frameStart > trace::BUFFER_SIZE)
+			// the first events of the frame have been overwritten
+			return;
+		const double ticksPerSec = trace::ticksPerUs() * 1000000.0;
+		profileThread.cachedResultTree.resize(1);
+		ProfileThread::ResultNode* parent = &profileThread.cachedResultTree.back();
+		std::vector<u64> startTimes;
+		for (u32 i = profileThread.frameStart; i != head; i++)
+		{
+			const trace::Event& event = buffer->events[i & (trace::BUFFER_SIZE - 1)];
+			if (event.type == trace::Begin)
+			{
+				const trace::ScopeInfo& scope = trace::getScope(event.scopeId);
+				parent->children.push_back(ProfileThread::ResultNode());
+				ProfileThread::ResultNode* node = &parent->children.back();
+				node->parent = parent;
+				node->section = ProfileSection(scope.function, scope.file, scope.line, (u32)startTimes.size());
+				startTimes.push_back(event.timestamp);
+				parent = node;
+			}
+			else if (!startTimes.empty())
+			{
+				parent->section.duration = (event.timestamp - startTimes.back()) / ticksPerSec;
+				startTimes.pop_back();
+				parent = parent->parent;
+			}
+			// else scope begun in the previous frame
+		}
+	}
+
 	void endThread(double warningTime)
 	{
 		if (config::ProfilerEnabled)
 		{
 			std::unique_lock<std::recursive_mutex> lock(ProfileThread::s_allThreadsLock);
 
-			if (!ProfileScope::s_thread)
+			if (!ProfileThread::s_thread)
 				return;
-			ProfileThread& profileThread = *ProfileScope::s_thread;
+			ProfileThread& profileThread = *ProfileThread::s_thread;
 
 			std::chrono::high_resolution_clock::time_point endTicks = std::chrono::high_resolution_clock::now();
 			std::chrono::microseconds durationMicro = std::chrono::duration_cast<std::chrono::microseconds>(endTicks - profileThread.startTicks);
 			profileThread.cachedTime = (double)durationMicro.count() / 1000000;
 
-			if (profileThread.scopes.size() > 0)
-			{
-				profileThread.cachedResultTree.clear();
-				profileThread.cachedResultTree.resize(1);
-				ProfileThread::ResultNode* node = &profileThread.cachedResultTree.back();
-				ProfileThread::ResultNode* parent = node;
-
-				u32 currScope = 0;
-
-				for (const ProfileSection& section : profileThread.scopes)
-				{
-					if (section.scope == currScope)
-					{
-						parent->children.push_back(ProfileThread::ResultNode());
-						node = &parent->children.back();
-						node->parent = parent;
-					}
-					else if (section.scope > currScope)
-					{
-						assert(node);
-						node->children.push_back(ProfileThread::ResultNode());
-						parent = node;
-						node = &node->children.back();
-						node->parent = parent;
-					}
-					else if (section.scope < currScope)
-					{
-						assert(parent);
-						parent->children.push_back(ProfileThread::ResultNode());
-						node = &parent->children.back();
-						parent = node->parent;
-						if (!parent)
-							parent = node;
-					}
-
-					currScope = section.scope;
-					node->section = section;
-				}
-			}
+			buildResultTree(profileThread);
 
 			if (config::ProfilerOutputTTY && warningTime > 0.0f && profileThread.cachedTime > warningTime)
 			{
@@ -109,8 +111,7 @@ namespace fc_profiler
 		{
 			if (node.section.function)
 			{
-				std::chrono::microseconds scopeTimeMicro = std::chrono::duration_cast<std::chrono::microseconds>(node.section.end - node.section.start);
-				double scopeTimeS = (double)scopeTimeMicro.count() / 1000000;
+				double scopeTimeS = node.section.duration;
 				char text[256];
 				std::snprintf(text, 256, "%.3f : %s (%s, %i)", (float)scopeTimeS, node.section.function, node.section.file, node.section.line);
 				ImGui::TreeNode(text);
@@ -128,8 +129,7 @@ namespace fc_profiler
 
 		for (const ProfileThread::ResultNode& node : results)
 		{
-			std::chrono::microseconds scopeTimeMicro = std::chrono::duration_cast<std::chrono::microseconds>(node.section.end - node.section.start);
-			double scopeTimeS = (double)scopeTimeMicro.count() / 1000000;
+			double scopeTimeS = node.section.duration;
 			WARN_LOG(PROFILER, "%.4f %*s%s (%s, %i)", scopeTimeS, node.section.scope, "", node.section.function, node.section.file, node.section.line);
 			outputTTY(node.children);
 		}
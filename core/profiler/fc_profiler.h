@@ -1,11 +1,14 @@
 #pragma once
 
+#include "types.h"
+#include <string>
+
 #if FC_PROFILER
 
-#include "types.h"
+#include "fc_trace.h"
 #include <vector>
-#include <string>
 #include <chrono>
+#include <cstring>
 #include <thread>
 #include <mutex>
 
@@ -17,7 +20,40 @@
 #endif
 #endif
 
-#define FC_PROFILE_SCOPE_RESERVE_SIZE 128
+namespace fc_profiler
+{
+	// Records the scope in the thread ring buffer when the thread is profiled or a trace is active
+	struct ProfileScope
+	{
+		ProfileScope(u32 scopeId)
+			: scopeId(scopeId), recorded(trace::begin(scopeId))
+		{
+		}
+
+		~ProfileScope()
+		{
+			if (recorded)
+				trace::end(scopeId);
+		}
+
+		const u32 scopeId;
+		const bool recorded;
+	};
+
+	// Name of the current thread in traces
+	static inline void setThreadName(const char *name) {
+		trace::setThreadName(name);
+	}
+}
+
+#define FC_PROFILE_SCOPE \
+	static const u32 __profile__id = fc_profiler::trace::internScope(__PRETTY_FUNCTION__, __FILE__, __LINE__); \
+	fc_profiler::ProfileScope __profile__scope(__profile__id);
+
+#define FC_PROFILE_SCOPE_NAMED(name) \
+	static const u32 __profile__id = fc_profiler::trace::internScope(name, __FILE__, __LINE__); \
+	fc_profiler::ProfileScope __profile__scope(__profile__id);
+
 #define FC_PROFILE_HISTORY_MAX_SIZE 512
 
 namespace fc_profiler
@@ -29,6 +65,7 @@ namespace fc_profiler
 			, file(nullptr)
 			, line(0)
 			, scope(0)
+			, duration(0.0)
 		{
 
 		}
@@ -38,6 +75,7 @@ namespace fc_profiler
 			, file(_file)
 			, line(_line)
 			, scope(_scope)
+			, duration(0.0)
 		{
 		}
 
@@ -45,8 +83,7 @@ namespace fc_profiler
 		const char* file;
 		u32 line;
 		u32 scope;
-		std::chrono::high_resolution_clock::time_point start;
-		std::chrono::high_resolution_clock::time_point end;
+		double duration;	// in seconds
 	};
 
 	struct ProfileThread
@@ -54,19 +91,17 @@ namespace fc_profiler
 		ProfileThread()
 		{
 			startTicks = std::chrono::high_resolution_clock::now();
-			level = 0;
 			historyIdx = 0;
+			frameStart = 0;
 			cachedTime = 0.0;
-			scopes.reserve(FC_PROFILE_SCOPE_RESERVE_SIZE);
 			memset(history, 0, sizeof(history));
 		}
 
-		std::vector<ProfileSection> scopes;
 		std::chrono::high_resolution_clock::time_point startTicks;
 		std::chrono::high_resolution_clock::time_point endTicks;
 		double history[FC_PROFILE_HISTORY_MAX_SIZE];
-		u32 level;
 		u32 historyIdx;
+		u32 frameStart;		// index of the first event of the frame in the thread ring buffer
 		std::thread::id threadId;
 		std::string threadName;
 
@@ -82,32 +117,6 @@ namespace fc_profiler
 		std::vector<ResultNode> cachedResultTree;
 		static std::vector<ProfileThread*> s_allThreads;
 		static std::recursive_mutex s_allThreadsLock;
-	};
-
-	struct ProfileScope
-	{
-		ProfileScope(const char* function, const char* file, int line)
-			: sectionIdx(0)
-		{
-			if (s_thread)
-			{
-				ProfileSection section(function, file, line, s_thread->level++);
-				section.start = std::chrono::high_resolution_clock::now();
-				sectionIdx = s_thread->scopes.size();
-				s_thread->scopes.push_back(section);
-			}
-		}
-
-		~ProfileScope()
-		{
-			if (s_thread)
-			{
-				s_thread->scopes[sectionIdx].end = std::chrono::high_resolution_clock::now();
-				s_thread->level--;
-			}
-		}
-
-		size_t sectionIdx;
 		static thread_local ProfileThread* s_thread;
 	};
 
@@ -118,18 +127,13 @@ namespace fc_profiler
 	void outputTTY(const std::vector<ProfileThread::ResultNode>& results);
 }
 
-#define FC_PROFILE_SCOPE \
-	fc_profiler::ProfileScope __profile__scope(__PRETTY_FUNCTION__, __FILE__, __LINE__);
-
-#define FC_PROFILE_SCOPE_NAMED(name) \
-	fc_profiler::ProfileScope __profile__scope(name, __FILE__, __LINE__);
-
 #else
 
 namespace fc_profiler
 {
 	inline static void startThread(const std::string& threadName) {}
 	inline static void endThread(float warningTime = 0.0) {}
+	inline static void setThreadName(const char *name) {}
 }
 
 #define FC_PROFILE_SCOPE
@@ -0,0 +1,270 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "fc_trace.h"
+#include "stdclass.h"
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace fc_profiler {
+namespace trace
+{
+
+std::atomic<bool> active;
+thread_local ThreadBuffer *threadBuffer;
+static thread_local std::string threadName;
+
+// Protects the registration of scopes and threads
+static std::mutex mutex;
+// Scope infos are never moved or freed so they can be read without locking
+constexpr u32 MAX_SCOPES = 4096;
+static const ScopeInfo *scopes[MAX_SCOPES];
+static u32 scopeCount;
+static std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+// Buffers of the threads that have exited
+static std::vector<ThreadBuffer *> freeBuffers;
+static u32 threadCount;
+// Names of the threads that have exited during the trace
+static std::vector<std::pair<u32, std::string>> exitedThreads;
+
+static FILE *file;
+static std::thread drainer;
+static cResetEvent stopEvent;
+static std::atomic<bool> stopping;
+// events recorded before tracing started are discarded
+static u64 startTicks;
+
+// Tick to microsecond conversion
+static const u64 originTicks = ticks();
+static const std::chrono::steady_clock::time_point originTime = std::chrono::steady_clock::now();
+
+static std::string jsonEscape(const char *s)
+{
+	std::string escaped;
+	for (; *s != '\0'; s++)
+	{
+		if (*s == '"' || *s == '\\')
+			escaped += '\\';
+		if ((u8)*s >= ' ')
+			escaped += *s;
+	}
+	return escaped;
+}
+
+double ticksPerUs()
+{
+	double us = std::chrono::duration_cast<std::chrono::duration<double, std::micro>>(std::chrono::steady_clock::now() - originTime).count();
+	if (us < 1000.0)
+		// not enough time to calibrate
+		return std::chrono::steady_clock::period::den / 1000000.0 / std::chrono::steady_clock::period::num;
+	return (ticks() - originTicks) / us;
+}
+
+u32 internScope(const char *name, const char *file, int line)
+{
+	std::lock_guard<std::mutex> _(mutex);
+	if (scopeCount == 0)
+		// shared by the scopes that don't fit
+		scopes[scopeCount++] = new ScopeInfo{ "(other)", "(other)", "", 0 };
+	if (scopeCount == MAX_SCOPES)
+		return 0;
+	scopes[scopeCount] = new ScopeInfo{ jsonEscape(name), name, file, line };
+	return scopeCount++;
+}
+
+const ScopeInfo& getScope(u32 scopeId)
+{
+	return *scopes[scopeId];
+}
+
+// Hands the buffer of the thread back to the free list when the thread exits
+struct BufferOwner
+{
+	~BufferOwner()
+	{
+		if (buffer == nullptr)
+			return;
+		std::lock_guard<std::mutex> _(mutex);
+		if (active)
+			exitedThreads.emplace_back(buffer->threadId, buffer->name);
+		freeBuffers.push_back(buffer);
+		threadBuffer = nullptr;
+	}
+
+	ThreadBuffer *buffer = nullptr;
+};
+static thread_local BufferOwner bufferOwner;
+
+ThreadBuffer *registerThread()
+{
+	std::lock_guard<std::mutex> _(mutex);
+	threadBuffer = nullptr;
+	for (auto it = freeBuffers.begin(); it != freeBuffers.end(); ++it)
+	{
+		ThreadBuffer *buffer = *it;
+		// The events of the previous thread must be drained first
+		if (!active || buffer->tail.load(std::memory_order_acquire) == buffer->head.load(std::memory_order_relaxed))
+		{
+			freeBuffers.erase(it);
+			buffer->open = 0;
+			buffer->profiled = false;
+			threadBuffer = buffer;
+			break;
+		}
+	}
+	if (threadBuffer == nullptr)
+	{
+		buffers.push_back(std::make_unique<ThreadBuffer>());
+		threadBuffer = buffers.back().get();
+	}
+	threadBuffer->threadId = ++threadCount;
+	threadBuffer->name = threadName.empty() ? "thread " + std::to_string(threadCount) : threadName;
+	bufferOwner.buffer = threadBuffer;
+
+	return threadBuffer;
+}
+
+void setThreadName(const char *name)
+{
+	std::lock_guard<std::mutex> _(mutex);
+	threadName = jsonEscape(name);
+	if (threadBuffer != nullptr)
+		threadBuffer->name = threadName;
+}
+
+// Drainer thread only
+struct DrainState
+{
+	ThreadBuffer *buffer;
+	u32 depth;
+};
+static std::vector<DrainState> drainStates;
+
+static void drain()
+{
+	{
+		// Only the list of buffers is read under the lock. Buffers are never freed, only reused.
+		std::lock_guard<std::mutex> _(mutex);
+		for (size_t i = drainStates.size(); i < buffers.size(); i++)
+			drainStates.push_back({ buffers[i].get(), 0 });
+	}
+	const double tpus = ticksPerUs();
+	for (DrainState& state : drainStates)
+	{
+		ThreadBuffer *buffer = state.buffer;
+		u32 tail = buffer->tail.load(std::memory_order_relaxed);
+		const u32 head = buffer->head.load(std::memory_order_acquire);
+		for (; tail != head; tail++)
+		{
+			const Event& event = buffer->events[tail & (BUFFER_SIZE - 1)];
+			if (event.timestamp < startTicks)
+				continue;
+			if (event.type == Begin)
+				state.depth++;
+			else if (state.depth == 0)
+				// scope begun before tracing started
+				continue;
+			else
+				state.depth--;
+			std::fprintf(file, ",\n{\"ph\":\"%c\",\"name\":\"%s\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}",
+					event.type == Begin ? 'B' : 'E', scopes[event.scopeId]->name.c_str(),
+					(event.timestamp - startTicks) / tpus, buffer->threadId);
+		}
+		buffer->tail.store(tail, std::memory_order_release);
+	}
+}
+
+static void drainerThread()
+{
+	setThreadName("trace drainer");
+	while (true)
+	{
+		stopEvent.Wait(20);
+		drain();
+		if (stopping)
+			break;
+	}
+}
+
+bool start(const std::string& path)
+{
+	if (active)
+		return false;
+	file = nowide::fopen(path.c_str(), "w");
+	if (file == nullptr)
+	{
+		WARN_LOG(COMMON, "Can't create trace file %s", path.c_str());
+		return false;
+	}
+	std::fprintf(file, "{\"traceEvents\":[\n{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":1,\"args\":{\"name\":\"Flycast\"}}");
+	{
+		std::lock_guard<std::mutex> _(mutex);
+		// drop the events left over from a previous trace or recorded for the profiler
+		for (const auto& buffer : buffers)
+		{
+			buffer->tail = buffer->head.load();
+			buffer->dropped = 0;
+		}
+		exitedThreads.clear();
+	}
+	drainStates.clear();
+	startTicks = ticks();
+	stopping = false;
+	active = true;
+	drainer = std::thread(drainerThread);
+	INFO_LOG(COMMON, "Tracing to %s", path.c_str());
+
+	return true;
+}
+
+void stop()
+{
+	if (!active)
+		return;
+	active = false;
+	stopping = true;
+	stopEvent.Set();
+	drainer.join();
+
+	std::vector<std::pair<u32, std::string>> threadNames;
+	u32 dropped = 0;
+	{
+		std::lock_guard<std::mutex> _(mutex);
+		threadNames = exitedThreads;
+		for (const auto& buffer : buffers)
+		{
+			if (std::find(freeBuffers.begin(), freeBuffers.end(), buffer.get()) == freeBuffers.end())
+				threadNames.emplace_back(buffer->threadId, buffer->name);
+			dropped += buffer->dropped;
+		}
+	}
+	for (const auto& pair : threadNames)
+		std::fprintf(file, ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+				pair.first, pair.second.c_str());
+	std::fprintf(file, "\n]}\n");
+	std::fclose(file);
+	file = nullptr;
+	INFO_LOG(COMMON, "Tracing stopped. %u events dropped", dropped);
+}
+
+}
+}
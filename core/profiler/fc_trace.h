@@ -0,0 +1,150 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "types.h"
+#include <atomic>
+#include <chrono>
+#include <string>
+
+#if HOST_CPU == CPU_X86 || HOST_CPU == CPU_X64
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+//
+// Scope recording. Each thread records begin/end events in its own fixed-size ring buffer.
+// The events are used to build the per-frame profiler tree of the thread
+// and, while a trace is active, they are drained by a background thread into a Chrome trace event
+// JSON file (chrome://tracing, https://ui.perfetto.dev)
+//
+namespace fc_profiler {
+namespace trace
+{
+	enum EventType : u32 {
+		Begin,
+		End
+	};
+
+	struct Event
+	{
+		u64 timestamp;	// host ticks
+		u32 scopeId;
+		EventType type;
+	};
+	static_assert(sizeof(Event) == 16, "Event must be 16 bytes");
+
+	constexpr u32 BUFFER_SIZE = 1 << 16;	// events per thread, power of 2
+
+	// Single producer (the owning thread), single consumer (the drainer)
+	struct ThreadBuffer
+	{
+		std::atomic<u32> head { 0 };
+		std::atomic<u32> tail { 0 };
+		std::atomic<u32> dropped { 0 };
+		u32 threadId = 0;
+		std::string name;
+		// owning thread only
+		u32 open = 0;			// scopes begun and not ended yet
+		bool profiled = false;	// record events even when not tracing
+		Event events[BUFFER_SIZE];
+	};
+
+	struct ScopeInfo
+	{
+		std::string name;	// json escaped
+		const char *function;
+		const char *file;
+		int line;
+	};
+
+	extern std::atomic<bool> active;
+	extern thread_local ThreadBuffer *threadBuffer;
+	// Returns the buffer of the current thread. It is released when the thread exits.
+	ThreadBuffer *registerThread();
+
+	static inline u64 ticks()
+	{
+#if HOST_CPU == CPU_X86 || HOST_CPU == CPU_X64
+		return __rdtsc();
+#elif HOST_CPU == CPU_ARM64 && !defined(_MSC_VER)
+		u64 t;
+		asm volatile("mrs %0, cntvct_el0" : "=r"(t));
+		return t;
+#else
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+	}
+	// Host ticks per microsecond, measured since startup
+	double ticksPerUs();
+
+	static inline void push(ThreadBuffer *buffer, u32 head, u32 scopeId, EventType type)
+	{
+		Event& e = buffer->events[head & (BUFFER_SIZE - 1)];
+		e.timestamp = ticks();
+		e.scopeId = scopeId;
+		e.type = type;
+		buffer->head.store(head + 1, std::memory_order_release);
+	}
+
+	// Records the beginning of a scope. Returns false if the scope isn't recorded,
+	// in which case end() must not be called.
+	static inline bool begin(u32 scopeId)
+	{
+		ThreadBuffer *buffer = threadBuffer;
+		const bool tracing = active.load(std::memory_order_relaxed);
+		if (!tracing && (buffer == nullptr || !buffer->profiled))
+			return false;
+		if (buffer == nullptr)
+			buffer = registerThread();
+		u32 head = buffer->head.load(std::memory_order_relaxed);
+		// Keep room for the end events of this scope and the enclosing ones
+		// so that begin and end events are always dropped in pairs
+		if (tracing && head - buffer->tail.load(std::memory_order_acquire) + buffer->open + 2 > BUFFER_SIZE)
+		{
+			buffer->dropped.fetch_add(2, std::memory_order_relaxed);
+			return false;
+		}
+		push(buffer, head, scopeId, Begin);
+		buffer->open++;
+		return true;
+	}
+
+	static inline void end(u32 scopeId)
+	{
+		ThreadBuffer *buffer = threadBuffer;
+		buffer->open--;
+		push(buffer, buffer->head.load(std::memory_order_relaxed), scopeId, End);
+	}
+
+	// Returns the id of a scope. Meant to be called once per call site.
+	u32 internScope(const char *name, const char *file, int line);
+	// Returns the scope info of the given scope id. The reference stays valid.
+	const ScopeInfo& getScope(u32 scopeId);
+	void setThreadName(const char *name);
+
+	bool start(const std::string& path);
+	void stop();
+	static inline bool isActive() {
+		return active;
+	}
+}
+}
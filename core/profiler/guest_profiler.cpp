@@ -0,0 +1,227 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "guest_profiler.h"
+#include "hw/sh4/sh4_if.h"
+#include "hw/sh4/sh4_mem.h"
+#include "hw/sh4/sh4_sched.h"
+#include "hw/sh4/modules/mmu.h"
+#include "hw/sh4/dyna/blockmanager.h"
+#include "cfg/option.h"
+#include "stdclass.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <unordered_map>
+
+namespace guest_profiler
+{
+
+constexpr int SAMPLE_PERIOD = SH4_MAIN_CLOCK / 2000;
+constexpr u32 MAX_DEPTH = 32;
+constexpr u32 STACK_SCAN_SIZE = 256;	// bytes
+
+struct BlockStats
+{
+	u32 samples = 0;
+	u32 guestOpcodes = 0;
+	u32 guestCycles = 0;
+};
+
+static int schedId = -1;
+static u32 sampleCount;
+// call stacks, outermost frame first
+static std::map<std::vector<u32>, u32> stacks;
+static std::unordered_map<u32, BlockStats> blocks;
+static std::vector<u32> frames;
+// sorted by address
+static std::vector<Symbol> symbols;
+
+// Physical address so that P0, P1 and P2 addresses match
+static u32 physAddr(u32 addr) {
+	return addr & 0x1fffffff;
+}
+
+// Returns true if the instruction preceding the delay slot is a subroutine call
+static bool isReturnAddress(u32 addr)
+{
+	if ((addr & 1) != 0 || addr < 4)
+		return false;
+	const u8 *p = GetMemPtr(addr - 4, 2);
+	if (p == nullptr)
+		return false;
+	u16 op;
+	memcpy(&op, p, sizeof(op));
+	return (op & 0xf000) == 0xb000		// bsr
+		|| (op & 0xf0ff) == 0x400b		// jsr @Rn
+		|| (op & 0xf0ff) == 0x0003;		// bsrf Rn
+}
+
+static void takeSample()
+{
+	const u32 pc = Sh4cntx.pc;
+	frames.clear();
+	frames.push_back(pc);
+	if (!mmu_enabled())
+	{
+		// Heuristic call stack: PR if it hasn't been saved yet and any return address found on the stack
+		if (Sh4cntx.pr != pc && isReturnAddress(Sh4cntx.pr))
+			frames.push_back(Sh4cntx.pr);
+		const u8 *stack = GetMemPtr(Sh4cntx.r[15] & ~3, STACK_SCAN_SIZE);
+		for (u32 i = 0; stack != nullptr && i < STACK_SCAN_SIZE && frames.size() < MAX_DEPTH; i += 4)
+		{
+			u32 v;
+			memcpy(&v, stack + i, sizeof(v));
+			if (v != frames.back() && isReturnAddress(v))
+				frames.push_back(v);
+		}
+	}
+	std::reverse(frames.begin(), frames.end());
+	stacks[frames]++;
+
+	BlockStats *stats = &blocks[pc];
+#if FEAT_SHREC != DYNAREC_NONE
+	if (stats->samples == 0 && config::DynarecEnabled && !mmu_enabled())
+	{
+		RuntimeBlockInfoPtr block = bm_GetBlock(pc);
+		if (block)
+		{
+			stats->guestOpcodes = block->guest_opcodes;
+			stats->guestCycles = block->guest_cycles;
+		}
+	}
+#endif
+	stats->samples++;
+	sampleCount++;
+}
+
+static int sampleCallback(int tag, int cycles, int jitter, void *arg)
+{
+	takeSample();
+	return SAMPLE_PERIOD;
+}
+
+static std::string symbolize(u32 addr)
+{
+	const u32 phys = physAddr(addr);
+	auto it = std::upper_bound(symbols.begin(), symbols.end(), phys,
+			[](u32 addr, const Symbol& sym) { return addr < sym.address; });
+	if (it != symbols.begin())
+	{
+		--it;
+		if (it->size == 0 || phys < it->address + it->size)
+			return it->name;
+	}
+	char name[16];
+	snprintf(name, sizeof(name), "%08X", addr);
+	return name;
+}
+
+static void writeFoldedStacks(const std::string& path)
+{
+	FILE *f = nowide::fopen(path.c_str(), "w");
+	if (f == nullptr)
+	{
+		WARN_LOG(SH4, "Can't create %s", path.c_str());
+		return;
+	}
+	for (const auto& pair : stacks)
+	{
+		std::string line;
+		std::string last;
+		for (u32 addr : pair.first)
+		{
+			std::string name = symbolize(addr);
+			// PR often points into the current function
+			if (name == last)
+				continue;
+			if (!line.empty())
+				line += ';';
+			line += name;
+			last = std::move(name);
+		}
+		fprintf(f, "%s %d\n", line.c_str(), pair.second);
+	}
+	std::fclose(f);
+	INFO_LOG(SH4, "Guest profile: %d samples saved to %s", sampleCount, path.c_str());
+}
+
+static void logHotBlocks()
+{
+	std::vector<std::pair<u32, BlockStats>> sorted(blocks.begin(), blocks.end());
+	std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+		return a.second.samples > b.second.samples;
+	});
+	if (sorted.size() > 20)
+		sorted.resize(20);
+	for (const auto& pair : sorted)
+		INFO_LOG(SH4, "%08X %5.2f%% %s ops %d cycles %d", pair.first, pair.second.samples * 100.f / sampleCount,
+				symbolize(pair.first).c_str(), pair.second.guestOpcodes, pair.second.guestCycles);
+}
+
+void start()
+{
+	if (schedId != -1)
+		return;
+	stacks.clear();
+	blocks.clear();
+	sampleCount = 0;
+	schedId = sh4_sched_register(0, sampleCallback);
+	sh4_sched_request(schedId, SAMPLE_PERIOD);
+	INFO_LOG(SH4, "Guest profiler started");
+}
+
+void stop()
+{
+	if (schedId == -1)
+		return;
+	sh4_sched_unregister(schedId);
+	schedId = -1;
+	if (sampleCount == 0)
+		return;
+	writeFoldedStacks(get_writable_data_path("guest-profile.folded"));
+	logHotBlocks();
+	stacks.clear();
+	blocks.clear();
+}
+
+bool isActive() {
+	return schedId != -1;
+}
+
+void reset()
+{
+	// A hard reset of the scheduler cancels the pending sample
+	if (schedId != -1)
+		sh4_sched_request(schedId, SAMPLE_PERIOD);
+}
+
+void setSymbols(std::vector<Symbol>&& newSymbols)
+{
+	symbols = std::move(newSymbols);
+	for (Symbol& sym : symbols)
+		sym.address = physAddr(sym.address);
+	std::sort(symbols.begin(), symbols.end(), [](const Symbol& a, const Symbol& b) {
+		return a.address < b.address;
+	});
+	if (!symbols.empty())
+		INFO_LOG(SH4, "Guest profiler: %d symbols loaded", (int)symbols.size());
+}
+
+}
@@ -0,0 +1,51 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "types.h"
+#include <string>
+#include <vector>
+
+//
+// Statistical profiler of the emulated SH4.
+// A scheduler callback samples the guest pc and a best-effort call stack (PR register
+// and return addresses found on the stack) about 2000 times per emulated second.
+// Samples are exported as folded stacks, the input format of flamegraph.pl and speedscope.
+// start() and stop() must be called while the emulator is stopped.
+//
+namespace guest_profiler
+{
+
+struct Symbol
+{
+	u32 address;
+	u32 size;
+	std::string name;
+};
+
+void start();
+// Writes the folded stacks to the data folder
+void stop();
+bool isActive();
+// Resumes sampling after a hard reset of the emulator
+void reset();
+
+// Replaces the symbols used to name the sampled addresses (from an ELF symbol table)
+void setSymbols(std::vector<Symbol>&& symbols);
+
+}
@@ -5,6 +5,26 @@ extern "C" {
 }
 
 #include "hw/sh4/sh4_mem.h"
+#include "profiler/guest_profiler.h"
+
+static void loadSymbols(const elf_t& elfFile)
+{
+	std::vector<guest_profiler::Symbol> symbols;
+	for (size_t i = 0; i < elf_getNumSections(&elfFile); i++)
+	{
+		if (elf_getSectionType(&elfFile, i) != SHT_SYMTAB)
+			continue;
+		const Elf32_Sym *sym = (const Elf32_Sym *)elf_getSection(&elfFile, i);
+		const char *strings = elf_getStringTable(&elfFile, elf_getSectionLink(&elfFile, i));
+		if (sym == nullptr || strings == nullptr)
+			continue;
+		size_t count = elf_getSectionSize(&elfFile, i) / sizeof(Elf32_Sym);
+		for (size_t j = 0; j < count; j++, sym++)
+			if (ELF32_ST_TYPE(sym->st_info) == STT_FUNC && sym->st_name != 0)
+				symbols.push_back({ sym->st_value, sym->st_size, &strings[sym->st_name] });
+	}
+	guest_profiler::setSymbols(std::move(symbols));
+}
 
 bool reios_loadElf(const std::string& elf) {
 
@@ -55,6 +75,7 @@ bool reios_loadElf(const std::string& elf) {
 		ptr += len;
 		memset(ptr, 0, elf_getProgramHeaderMemorySize(&elfFile, i) - len);
 	}
+	loadSymbols(elfFile);
 	free(elfF);
 
 	return true;
@@ -23,6 +23,7 @@
 #include "cfg/option.h"
 #include "oslib/oslib.h"
 
+#include <algorithm>
 #include <sstream>
 #define STB_IMAGE_IMPLEMENTATION
 #define STBI_ONLY_JPEG
@@ -30,56 +31,164 @@
 #include <stb_image.h>
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include <stb_image_write.h>
+#ifdef _WIN32
+#include <windows.h>
+#include <nowide/convert.hpp>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 CustomTexture custom_texture;
 
+//
+// Texture pack: a single file containing the decoded textures of a game, sorted by hash
+// so that they can be found with a binary search in the memory-mapped file.
+//   TexturePackHeader
+//   TexturePackEntry[count], sorted by hash
+//   texture data, 16-byte aligned
+// Square power-of-two textures include their mipmaps, smallest first, as expected by UploadToGPU().
+// The textures aren't compressed: the renderers have no upload path for BCn or ASTC data.
+//
+constexpr u32 TEXTURE_PACK_MAGIC = 0x50544346;	// FCTP
+constexpr u32 TEXTURE_PACK_VERSION = 2;
+constexpr const char *TEXTURE_PACK_NAME = "textures.pack";
+
+struct TexturePackHeader
+{
+	u32 magic;
+	u32 version;
+	u32 count;
+	u32 reserved;
+};
+
+enum class TexturePackFormat : u32 {
+	RGBA8,		// bottom-up rows, as returned by stb_image when flipping on load
+};
+
+struct TexturePackEntry
+{
+	u32 hash;
+	TexturePackFormat format;
+	u32 width;
+	u32 height;
+	u32 mipLevels;	// 1 if the mipmaps aren't included
+	u32 reserved;
+	u64 offset;		// from the start of the file
+};
+static_assert(sizeof(TexturePackEntry) == 32, "TexturePackEntry must be packed");
+
+static u32 mipmapLevels(u32 width, u32 height)
+{
+	if (width != height || (width & (width - 1)) != 0)
+		return 1;
+	u32 levels = 1;
+	while (width > 1)
+	{
+		width >>= 1;
+		levels++;
+	}
+	return levels;
+}
+
+// Size of the mipmap levels smaller than the texture
+static u64 mipmapsSize(u32 width, u32 levels)
+{
+	u64 size = 0;
+	for (u32 i = 0; i + 1 < levels; i++)
+		size += (u64)(1 << i) * (1 << i) * 4;
+	return size;
+}
+
+// Returns the next mipmap level of a square RGBA8 image, averaging each 2x2 block
+static std::vector<u8> downscale(const u8 *src, u32 width)
+{
+	const u32 dstWidth = width / 2;
+	std::vector<u8> dst((size_t)dstWidth * dstWidth * 4);
+	for (u32 y = 0; y < dstWidth; y++)
+		for (u32 x = 0; x < dstWidth; x++)
+			for (u32 c = 0; c < 4; c++)
+			{
+				const u8 *p = &src[((y * 2) * width + x * 2) * 4 + c];
+				dst[(y * dstWidth + x) * 4 + c] = (u8)((p[0] + p[4] + p[width * 4] + p[width * 4 + 4] + 2) / 4);
+			}
+	return dst;
+}
+
+static bool parseTextureName(const std::string& name, u32& hash)
+{
+	std::string extension = get_file_extension(name);
+	if (extension != "jpg" && extension != "jpeg" && extension != "png")
+		return false;
+	std::string::size_type dotpos = name.find_last_of('.');
+	std::string basename = name.substr(0, dotpos);
+	char *endptr;
+	hash = (u32)strtoll(basename.c_str(), &endptr, 16);
+	if (endptr - basename.c_str() < (ptrdiff_t)basename.length())
+	{
+		INFO_LOG(RENDERER, "Invalid hash %s", basename.c_str());
+		return false;
+	}
+	return true;
+}
+
 void CustomTexture::LoaderThread()
 {
-	LoadMap();
+	{
+		// The first thread loads the texture list, the others wait
+		std::lock_guard<std::mutex> _(map_mutex);
+		if (!map_loaded)
+		{
+			bool packOpened;
+			{
+				std::lock_guard<std::mutex> _(pack_mutex);
+				packOpened = OpenPack(textures_path + TEXTURE_PACK_NAME);
+			}
+			if (!packOpened)
+				LoadMap();
+			map_loaded = true;
+		}
+	}
+	std::unique_lock<std::mutex> lock(work_queue_mutex);
 	while (initialized)
 	{
-		BaseTextureCacheData *texture;
-		
-		do {
-			texture = nullptr;
+		if (work_queue.empty())
+		{
+			wakeup_thread.wait(lock);
+			continue;
+		}
+		BaseTextureCacheData *texture = work_queue.back();
+		work_queue.pop_back();
+		lock.unlock();
+
+		texture->ComputeHash();
+		if (texture->custom_image_data != nullptr)
+		{
+			free(texture->custom_image_data);
+			texture->custom_image_data = nullptr;
+		}
+		if (!texture->dirty)
+		{
+			int width, height;
+			bool mipmaps;
+			u8 *image_data = LoadCustomTexture(texture->texture_hash, texture->IsMipmapped(), width, height, mipmaps);
+			if (image_data == nullptr)
 			{
-				std::unique_lock<std::mutex> lock(work_queue_mutex);
-				if (!work_queue.empty())
-				{
-					texture = work_queue.back();
-					work_queue.pop_back();
-				}
+				image_data = LoadCustomTexture(texture->old_texture_hash, texture->IsMipmapped(), width, height, mipmaps);
 			}
-			
-			if (texture != nullptr)
+			if (image_data != nullptr)
 			{
-				texture->ComputeHash();
-				if (texture->custom_image_data != nullptr)
-				{
-					free(texture->custom_image_data);
-					texture->custom_image_data = nullptr;
-				}
-				if (!texture->dirty)
-				{
-					int width, height;
-					u8 *image_data = LoadCustomTexture(texture->texture_hash, width, height);
-					if (image_data == nullptr)
-					{
-						image_data = LoadCustomTexture(texture->old_texture_hash, width, height);
-					}
-					if (image_data != nullptr)
-					{
-						texture->custom_width = width;
-						texture->custom_height = height;
-						texture->custom_image_data = image_data;
-					}
-				}
-				texture->custom_load_in_progress--;
+				texture->custom_width = width;
+				texture->custom_height = height;
+				texture->custom_mipmaps = mipmaps;
+				texture->custom_image_data = image_data;
 			}
+		}
+		texture->custom_load_in_progress--;
 
-		} while (texture != nullptr);
-		
-		wakeup_thread.Wait();
+		lock.lock();
 	}
 }
 
@@ -113,7 +222,10 @@ bool CustomTexture::Init()
 					NOTICE_LOG(RENDERER, "Found custom textures directory: %s", textures_path.c_str());
 					custom_textures_available = true;
 					flycast::closedir(dir);
-					loader_thread.Start();
+					// png decoding is slow, use several threads
+					int threadCount = std::max(1, std::min(4, (int)std::thread::hardware_concurrency() / 2));
+					for (int i = 0; i < threadCount; i++)
+						loader_threads.emplace_back(&CustomTexture::LoaderThread, this);
 				}
 			}
 		}
@@ -125,19 +237,34 @@ void CustomTexture::Terminate()
 {
 	if (initialized)
 	{
-		initialized = false;
 		{
 			std::unique_lock<std::mutex> lock(work_queue_mutex);
+			initialized = false;
 			work_queue.clear();
 		}
-		wakeup_thread.Set();
-		loader_thread.WaitToEnd();
+		wakeup_thread.notify_all();
+		for (auto& thread : loader_threads)
+			thread.join();
+		loader_threads.clear();
 		texture_map.clear();
+		{
+			std::lock_guard<std::mutex> _(pack_mutex);
+			ClosePack();
+		}
+		map_loaded = false;
 	}
 }
 
-u8* CustomTexture::LoadCustomTexture(u32 hash, int& width, int& height)
+u8* CustomTexture::LoadCustomTexture(u32 hash, bool mipmapped, int& width, int& height, bool& mipmapsIncluded)
 {
+	mipmapsIncluded = false;
+	{
+		// The pack can be replaced by BuildPack()
+		std::lock_guard<std::mutex> _(pack_mutex);
+		if (pack_data != nullptr)
+			return LoadPackTexture(hash, mipmapped, width, height, mipmapsIncluded);
+	}
+
 	auto it = texture_map.find(hash);
 	if (it == texture_map.end())
 		return nullptr;
@@ -162,7 +289,239 @@ void CustomTexture::LoadCustomTextureAsync(BaseTextureCacheData *texture_data)
 		std::unique_lock<std::mutex> lock(work_queue_mutex);
 		work_queue.insert(work_queue.begin(), texture_data);
 	}
-	wakeup_thread.Set();
+	wakeup_thread.notify_one();
+}
+
+bool CustomTexture::OpenPack(const std::string& path)
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileW(nowide::widen(path).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER fileSize;
+	if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart >= (LONGLONG)sizeof(TexturePackHeader))
+	{
+		pack_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (pack_mapping != nullptr)
+		{
+			pack_data = (const u8 *)MapViewOfFile(pack_mapping, FILE_MAP_READ, 0, 0, 0);
+			pack_size = (size_t)fileSize.QuadPart;
+		}
+	}
+	CloseHandle(file);
+#else
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd == -1)
+		return false;
+	struct stat st;
+	if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(TexturePackHeader))
+	{
+		void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		if (p != MAP_FAILED)
+		{
+			pack_data = (const u8 *)p;
+			pack_size = st.st_size;
+		}
+	}
+	close(fd);
+#endif
+	if (pack_data == nullptr)
+	{
+		WARN_LOG(RENDERER, "Can't map texture pack %s", path.c_str());
+		ClosePack();
+		return false;
+	}
+	const TexturePackHeader *header = (const TexturePackHeader *)pack_data;
+	if (header->magic != TEXTURE_PACK_MAGIC || header->version != TEXTURE_PACK_VERSION
+			|| header->count > (pack_size - sizeof(TexturePackHeader)) / sizeof(TexturePackEntry))
+	{
+		WARN_LOG(RENDERER, "Invalid texture pack %s", path.c_str());
+		ClosePack();
+		return false;
+	}
+	pack_entries = (const TexturePackEntry *)(header + 1);
+	pack_entry_count = header->count;
+	pack_path = path;
+	custom_textures_available = pack_entry_count != 0;
+	NOTICE_LOG(RENDERER, "Texture pack %s: %d textures", path.c_str(), pack_entry_count);
+
+	return true;
+}
+
+void CustomTexture::ClosePack()
+{
+#ifdef _WIN32
+	if (pack_data != nullptr)
+		UnmapViewOfFile(pack_data);
+	if (pack_mapping != nullptr)
+		CloseHandle(pack_mapping);
+	pack_mapping = nullptr;
+#else
+	if (pack_data != nullptr)
+		munmap((void *)pack_data, pack_size);
+#endif
+	pack_data = nullptr;
+	pack_size = 0;
+	pack_entries = nullptr;
+	pack_entry_count = 0;
+	pack_path.clear();
+}
+
+bool CustomTexture::ReplacePack(const std::string& newPath, const std::string& path)
+{
+	std::lock_guard<std::mutex> _(pack_mutex);
+	// A mapped file can't be replaced on windows
+	const bool inUse = pack_data != nullptr && pack_path == path;
+	if (inUse)
+		ClosePack();
+	bool success = std::rename(newPath.c_str(), path.c_str()) == 0;
+	if (!success)
+	{
+		// rename doesn't replace existing files on windows
+		nowide::remove(path.c_str());
+		success = std::rename(newPath.c_str(), path.c_str()) == 0;
+	}
+	if (inUse)
+		OpenPack(path);
+
+	return success;
+}
+
+u8 *CustomTexture::LoadPackTexture(u32 hash, bool mipmapped, int& width, int& height, bool& mipmapsIncluded)
+{
+	const TexturePackEntry *end = pack_entries + pack_entry_count;
+	const TexturePackEntry *entry = std::lower_bound(pack_entries, end, hash,
+			[](const TexturePackEntry& entry, u32 hash) { return entry.hash < hash; });
+	if (entry == end || entry->hash != hash)
+		return nullptr;
+	if (entry->format != TexturePackFormat::RGBA8)
+	{
+		WARN_LOG(RENDERER, "Texture %08x: unsupported format %d", hash, (int)entry->format);
+		return nullptr;
+	}
+	if (entry->mipLevels != 1 && entry->mipLevels != mipmapLevels(entry->width, entry->height))
+	{
+		WARN_LOG(RENDERER, "Texture %08x: invalid mipmap levels", hash);
+		return nullptr;
+	}
+	const u64 mipSize = mipmapsSize(entry->width, entry->mipLevels);
+	const u64 size = (u64)entry->width * entry->height * 4;
+	if (entry->offset > pack_size || mipSize + size > pack_size - entry->offset)
+	{
+		WARN_LOG(RENDERER, "Texture %08x: invalid offset/size", hash);
+		return nullptr;
+	}
+	mipmapsIncluded = mipmapped && entry->mipLevels > 1;
+	// The largest level is last
+	const u64 start = mipmapsIncluded ? 0 : mipSize;
+	const u64 copySize = mipSize + size - start;
+	// The texture cache takes ownership of the data
+	u8 *data = (u8 *)malloc(copySize);
+	if (data == nullptr)
+		return nullptr;
+	memcpy(data, pack_data + entry->offset + start, copySize);
+	width = entry->width;
+	height = entry->height;
+
+	return data;
+}
+
+int CustomTexture::BuildPack(std::string directory, std::atomic<float> *progress)
+{
+	if (!directory.empty() && directory.back() != '/' && directory.back() != '\\')
+		directory += '/';
+	const std::string packPath = directory + TEXTURE_PACK_NAME;
+	// The pack being replaced may be in use
+	const std::string tmpPath = packPath + ".tmp";
+	std::map<u32, std::string> files;
+	hostfs::DirectoryTree tree(directory);
+	for (const hostfs::FileInfo& item : tree)
+	{
+		u32 hash;
+		if (parseTextureName(item.name, hash))
+			files[hash] = item.path;
+	}
+	FILE *f = nowide::fopen(tmpPath.c_str(), "wb");
+	if (f == nullptr)
+	{
+		ERROR_LOG(RENDERER, "Can't create texture pack %s", tmpPath.c_str());
+		return -1;
+	}
+	// The entries are written once all the textures are known
+	std::vector<TexturePackEntry> entries;
+	entries.reserve(files.size());
+	u64 offset = sizeof(TexturePackHeader) + files.size() * sizeof(TexturePackEntry);
+	bool error = std::fseek(f, (long)offset, SEEK_SET) != 0;
+	stbi_set_flip_vertically_on_load(1);
+	size_t done = 0;
+	for (const auto& [hash, path] : files)
+	{
+		if (error)
+			break;
+		if (progress != nullptr)
+			*progress = (float)done++ / files.size();
+		FILE *file = nowide::fopen(path.c_str(), "rb");
+		if (file == nullptr)
+			continue;
+		int width, height, n;
+		u8 *imgData = stbi_load_from_file(file, &width, &height, &n, STBI_rgb_alpha);
+		std::fclose(file);
+		if (imgData == nullptr)
+		{
+			WARN_LOG(RENDERER, "Can't decode %s", path.c_str());
+			continue;
+		}
+		const u64 alignedOffset = (offset + 15) & ~15ull;
+		static const u8 padding[16] {};
+		error = std::fwrite(padding, 1, alignedOffset - offset, f) != alignedOffset - offset;
+		offset = alignedOffset;
+		const u32 levels = mipmapLevels(width, height);
+		if (levels > 1)
+		{
+			// Smallest level first
+			std::vector<std::vector<u8>> mipmaps;
+			for (u32 i = 1; i < levels; i++)
+				mipmaps.push_back(downscale(i == 1 ? imgData : mipmaps.back().data(), width >> (i - 1)));
+			for (auto it = mipmaps.rbegin(); it != mipmaps.rend() && !error; ++it)
+			{
+				error = std::fwrite(it->data(), 1, it->size(), f) != it->size();
+				offset += it->size();
+			}
+		}
+		const size_t size = (size_t)width * height * 4;
+		error = error || std::fwrite(imgData, 1, size, f) != size;
+		stbi_image_free(imgData);
+		entries.push_back({ hash, TexturePackFormat::RGBA8, (u32)width, (u32)height, levels, 0, alignedOffset });
+		offset += size;
+	}
+	// Textures that failed to load leave unused entries at the end of the table
+	TexturePackHeader header { TEXTURE_PACK_MAGIC, TEXTURE_PACK_VERSION, (u32)entries.size() };
+	error = error || std::fseek(f, 0, SEEK_SET) != 0
+			|| std::fwrite(&header, sizeof(header), 1, f) != 1
+			|| (!entries.empty() && std::fwrite(entries.data(), sizeof(TexturePackEntry), entries.size(), f) != entries.size());
+	error = std::fclose(f) != 0 || error;
+	if (error || !custom_texture.ReplacePack(tmpPath, packPath))
+	{
+		ERROR_LOG(RENDERER, "Error writing texture pack %s", packPath.c_str());
+		nowide::remove(tmpPath.c_str());
+		return -1;
+	}
+	if (progress != nullptr)
+		*progress = 1.f;
+	NOTICE_LOG(RENDERER, "Texture pack %s: %d textures", packPath.c_str(), (int)entries.size());
+
+	return (int)entries.size();
+}
+
+int CustomTexture::BuildGamePack(std::atomic<float> *progress)
+{
+	std::string game_id = GetGameId();
+	if (game_id.empty())
+		return -1;
+	std::string path = hostfs::getTextureLoadPath(game_id);
+	if (path.empty())
+		return -1;
+	return BuildPack(path, progress);
 }
 
 void CustomTexture::DumpTexture(u32 hash, int w, int h, TextureType textype, void *src_buffer)
@@ -291,19 +650,9 @@ void CustomTexture::LoadMap()
 	hostfs::DirectoryTree tree(textures_path);
 	for (const hostfs::FileInfo& item : tree)
 	{
-		std::string extension = get_file_extension(item.name);
-		if (extension != "jpg" && extension != "jpeg" && extension != "png")
-			continue;
-		std::string::size_type dotpos = item.name.find_last_of('.');
-		std::string basename = item.name.substr(0, dotpos);
-		char *endptr;
-		u32 hash = (u32)strtoll(basename.c_str(), &endptr, 16);
-		if (endptr - basename.c_str() < (ptrdiff_t)basename.length())
-		{
-			INFO_LOG(RENDERER, "Invalid hash %s", basename.c_str());
-			continue;
-		}
-		texture_map[hash] = item.path;
+		u32 hash;
+		if (parseTextureName(item.name, hash))
+			texture_map[hash] = item.path;
 	}
 	custom_textures_available = !texture_map.empty();
 }
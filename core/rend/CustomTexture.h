@@ -21,36 +21,65 @@
 #include "TexCache.h"
 #include "stdclass.h"
 
+#include <atomic>
+#include <condition_variable>
 #include <string>
+#include <thread>
 #include <vector>
 #include <map>
 #include <mutex>
 
+struct TexturePackEntry;
+
 class CustomTexture {
 public:
-	CustomTexture() : loader_thread(loader_thread_func, this) {}
 	~CustomTexture() { Terminate(); }
-	u8* LoadCustomTexture(u32 hash, int& width, int& height);
+	// Mipmaps are only included in the returned data if requested and found in the texture pack
+	u8* LoadCustomTexture(u32 hash, bool mipmapped, int& width, int& height, bool& mipmapsIncluded);
 	void LoadCustomTextureAsync(BaseTextureCacheData *texture_data);
 	void DumpTexture(u32 hash, int w, int h, TextureType textype, void *src_buffer);
 	void Terminate();
 
+	// Converts the png/jpeg textures found in a directory to a texture pack saved in the same directory.
+	// The pack is then used instead of the individual files.
+	// Returns the number of textures written, or -1 on error.
+	// Can be called from any thread. progress, if not null, is updated from 0 to 1.
+	static int BuildPack(std::string directory, std::atomic<float> *progress = nullptr);
+	// Builds the texture pack of the running game. It's used the next time the game is started.
+	static int BuildGamePack(std::atomic<float> *progress = nullptr);
+
 private:
 	bool Init();
 	void LoaderThread();
-	std::string GetGameId();
+	static std::string GetGameId();
 	void LoadMap();
-	
-	static void *loader_thread_func(void *param) { ((CustomTexture *)param)->LoaderThread(); return NULL; }
+	bool OpenPack(const std::string& path);
+	void ClosePack();
+	// Renames the new pack file over the given one, which is closed first if it's in use
+	bool ReplacePack(const std::string& newPath, const std::string& path);
+	u8 *LoadPackTexture(u32 hash, bool mipmapped, int& width, int& height, bool& mipmapsIncluded);
 	
 	bool initialized = false;
 	bool custom_textures_available = false;
 	std::string textures_path;
-	cThread loader_thread;
-	cResetEvent wakeup_thread;
+	std::vector<std::thread> loader_threads;
+	std::condition_variable wakeup_thread;
 	std::vector<BaseTextureCacheData *> work_queue;
 	std::mutex work_queue_mutex;
+	std::mutex map_mutex;
+	bool map_loaded = false;
 	std::map<u32, std::string> texture_map;
+
+	// Memory-mapped texture pack
+	std::mutex pack_mutex;
+	std::string pack_path;
+	const u8 *pack_data = nullptr;
+	size_t pack_size = 0;
+	const TexturePackEntry *pack_entries = nullptr;
+	u32 pack_entry_count = 0;
+#ifdef _WIN32
+	void *pack_mapping = nullptr;
+#endif
 };
 
 extern CustomTexture custom_texture;
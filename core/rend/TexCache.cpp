@@ -1,11 +1,13 @@
 #include "TexCache.h"
+#include "fb_convert.h"
 #include "CustomTexture.h"
 #include "deps/xbrz/xbrz.h"
 #include "hw/pvr/pvr_mem.h"
 #include "hw/mem/addrspace.h"
+#include "log/BitSet.h"
 
 #include <algorithm>
-#include <mutex>
+#include <type_traits>
 #include <xxhash.h>
 
 #ifdef _OPENMP
@@ -20,7 +22,9 @@ u32 palette32_ram[1024];
 u32 pal_hash_256[4];
 u32 pal_hash_16[64];
 bool palette_updated;
+std::atomic<u32> textureEpoch { 1 };
 extern bool pal_needs_update;
+extern u64 pal_dirty_banks;
 
 // Rough approximation of LoD bias from D adjust param, only used to increase LoD
 const std::array<f32, 16> D_Adjust_LoD_Bias = {
@@ -82,44 +86,52 @@ static void BuildTwiddleTables()
 
 static OnLoad btt(&BuildTwiddleTables);
 
+// Converts the palette entries of the given 16-entry banks
+template<typename Unpacker16, typename Unpacker32>
+static void convertPalette(u64 banks)
+{
+	while (banks != 0)
+	{
+		const u32 start = Common::LeastSignificantSetBit(banks) * 16;
+		banks &= banks - 1;
+		for (u32 i = start; i < start + 16; i++)
+		{
+			if constexpr (!std::is_void_v<Unpacker16>)
+				palette16_ram[i] = Unpacker16::unpack(PALETTE_RAM[i]);
+			palette32_ram[i] = Unpacker32::unpack(PALETTE_RAM[i]);
+		}
+	}
+}
+
 void palette_update()
 {
-	if (!pal_needs_update)
+	if (!pal_needs_update && pal_dirty_banks == 0)
 		return;
+	// Only convert and hash the banks that have been written unless the whole palette must be updated
+	const u64 banks = pal_needs_update ? ~0ull : pal_dirty_banks;
 	pal_needs_update = false;
+	pal_dirty_banks = 0;
 	palette_updated = true;
+	textureEpoch++;
 
 	if (!isDirectX(config::RendererType))
 	{
 		switch(PAL_RAM_CTRL&3)
 		{
 		case 0:
-			for (int i=0;i<1024;i++)
-			{
-				palette16_ram[i] = Unpacker1555::unpack(PALETTE_RAM[i]);
-				palette32_ram[i] = Unpacker1555_32<RGBAPacker>::unpack(PALETTE_RAM[i]);
-			}
+			convertPalette<Unpacker1555, Unpacker1555_32<RGBAPacker>>(banks);
 			break;
 
 		case 1:
-			for (int i=0;i<1024;i++)
-			{
-				palette16_ram[i] = UnpackerNop<u16>::unpack(PALETTE_RAM[i]);
-				palette32_ram[i] = Unpacker565_32<RGBAPacker>::unpack(PALETTE_RAM[i]);
-			}
+			convertPalette<UnpackerNop<u16>, Unpacker565_32<RGBAPacker>>(banks);
 			break;
 
 		case 2:
-			for (int i=0;i<1024;i++)
-			{
-				palette16_ram[i] = Unpacker4444::unpack(PALETTE_RAM[i]);
-				palette32_ram[i] = Unpacker4444_32<RGBAPacker>::unpack(PALETTE_RAM[i]);
-			}
+			convertPalette<Unpacker4444, Unpacker4444_32<RGBAPacker>>(banks);
 			break;
 
 		case 3:
-			for (int i=0;i<1024;i++)
-				palette32_ram[i] = Unpacker8888<RGBAPacker>::unpack(PALETTE_RAM[i]);
+			convertPalette<void, Unpacker8888<RGBAPacker>>(banks);
 			break;
 		}
 	}
@@ -129,39 +141,28 @@ void palette_update()
 		{
 
 		case 0:
-			for (int i=0;i<1024;i++)
-			{
-				palette16_ram[i] = UnpackerNop<u16>::unpack(PALETTE_RAM[i]);
-				palette32_ram[i] = Unpacker1555_32<BGRAPacker>::unpack(PALETTE_RAM[i]);
-			}
+			convertPalette<UnpackerNop<u16>, Unpacker1555_32<BGRAPacker>>(banks);
 			break;
 
 		case 1:
-			for (int i=0;i<1024;i++)
-			{
-				palette16_ram[i] = UnpackerNop<u16>::unpack(PALETTE_RAM[i]);
-				palette32_ram[i] = Unpacker565_32<BGRAPacker>::unpack(PALETTE_RAM[i]);
-			}
+			convertPalette<UnpackerNop<u16>, Unpacker565_32<BGRAPacker>>(banks);
 			break;
 
 		case 2:
-			for (int i=0;i<1024;i++)
-			{
-				palette16_ram[i] = UnpackerNop<u16>::unpack(PALETTE_RAM[i]);
-				palette32_ram[i] = Unpacker4444_32<BGRAPacker>::unpack(PALETTE_RAM[i]);
-			}
+			convertPalette<UnpackerNop<u16>, Unpacker4444_32<BGRAPacker>>(banks);
 			break;
 
 		case 3:
-			for (int i=0;i<1024;i++)
-				palette32_ram[i] = UnpackerNop<u32>::unpack(PALETTE_RAM[i]);
+			convertPalette<void, UnpackerNop<u32>>(banks);
 			break;
 		}
 	}
 	for (std::size_t i = 0; i < std::size(pal_hash_16); i++)
-		pal_hash_16[i] = XXH32(&PALETTE_RAM[i << 4], 16 * 4, 7);
+		if (banks & (1ull << i))
+			pal_hash_16[i] = XXH32(&PALETTE_RAM[i << 4], 16 * 4, 7);
 	for (std::size_t i = 0; i < std::size(pal_hash_256); i++)
-		pal_hash_256[i] = XXH32(&PALETTE_RAM[i << 8], 256 * 4, 7);
+		if ((banks >> (i * 16)) & 0xffff)
+			pal_hash_256[i] = XXH32(&PALETTE_RAM[i << 8], 256 * 4, 7);
 }
 
 void forcePaletteUpdate()
@@ -170,7 +171,18 @@ void forcePaletteUpdate()
 }
 
 
-static std::vector<vram_block*> VramLocks[VRAM_SIZE_MAX / PAGE_SIZE];
+TextureCacheStats textureCacheStats;
+
+// Head of the list of blocks locking each vram page
+static vram_block *VramLocks[VRAM_SIZE_MAX / PAGE_SIZE];
+// Pages written since their textures were last invalidated
+static std::atomic<u64> writtenPages[VRAM_SIZE_MAX / PAGE_SIZE / 64];
+static std::atomic<bool> pagesWritten;
+// Epoch of the last write trapped on each vram page, for the asynchronous readbacks
+static std::atomic<u64> vramWriteEpoch;
+static std::atomic<u64> pageWriteEpochs[VRAM_SIZE_MAX / PAGE_SIZE];
+// Number of pending readbacks writing to each page. Only used by the render thread.
+static u16 readbackLocks[VRAM_SIZE_MAX / PAGE_SIZE];
 
 //List functions
 //
@@ -181,12 +193,13 @@ static void vramlock_list_remove(vram_block* block)
 
 	for (u32 i = base; i <= end; i++)
 	{
-		std::vector<vram_block*>& list = VramLocks[i];
-		for (auto& lock : list)
-		{
-			if (lock == block)
-				lock = nullptr;
-		}
+		vram_block::Link& link = block->links[i - base];
+		if (link.prev != nullptr)
+			link.prev->links[i - link.prev->start / PAGE_SIZE].next = link.next;
+		else
+			VramLocks[i] = link.next;
+		if (link.next != nullptr)
+			link.next->links[i - link.next->start / PAGE_SIZE].prev = link.prev;
 	}
 }
  
@@ -195,60 +208,135 @@ static void vramlock_list_add(vram_block* block)
 	u32 base = block->start / PAGE_SIZE;
 	u32 end = block->end / PAGE_SIZE;
 
+	block->links.resize(end - base + 1);
 	for (u32 i = base; i <= end; i++)
 	{
-		std::vector<vram_block*>& list = VramLocks[i];
+		vram_block *head = VramLocks[i];
 		// If the list is empty then we need to protect vram, otherwise it's already been done
-		if (list.empty() || std::all_of(list.begin(), list.end(), [](vram_block *block) { return block == nullptr; }))
+		if (head == nullptr)
 			addrspace::protectVram(i * PAGE_SIZE, PAGE_SIZE);
-		auto it = std::find(list.begin(), list.end(), nullptr);
-		if (it != list.end())
-			*it = block;
 		else
-			list.push_back(block);
+			head->links[i - head->start / PAGE_SIZE].prev = block;
+		block->links[i - base] = { nullptr, head };
+		VramLocks[i] = block;
 	}
 }
- 
-static std::mutex vramlist_lock;
 
+static void invalidateVramPage(u32 page)
+{
+	// Unprotect first so that the render thread can't protect the page again
+	// before it sees the write
+	addrspace::unprotectVram(page * PAGE_SIZE, PAGE_SIZE);
+	writtenPages[page / 64].fetch_or(1ull << (page % 64), std::memory_order_release);
+	pagesWritten.store(true, std::memory_order_release);
+}
+
+// Called by the fault handler or when vram is written by the host.
+// Textures are invalidated later by the render thread, which owns the lock lists.
 bool VramLockedWriteOffset(size_t offset)
 {
 	if (offset >= VRAM_SIZE)
 		return false;
 
-	size_t addr_hash = offset / PAGE_SIZE;
-	std::vector<vram_block *>& list = VramLocks[addr_hash];
+	u32 page = offset / PAGE_SIZE;
+	invalidateVramPage(page);
+	// Pending readbacks to this page are now stale
+	pageWriteEpochs[page].store(vramWriteEpoch.fetch_add(1, std::memory_order_relaxed) + 1, std::memory_order_release);
 
-	{
-		std::lock_guard<std::mutex> lockguard(vramlist_lock);
+	return true;
+}
 
-		for (auto& lock : list)
-		{
-			if (lock != nullptr)
-			{
-				lock->texture->invalidate();
+bool VramLockedWrite(u8* address)
+{
+	u32 offset = addrspace::getVramOffset(address);
+	if (offset == (u32)-1)
+		return false;
+	addrspace::vramTrackingStats.trappedWrites++;
+	return VramLockedWriteOffset(offset);
+}
 
-				if (lock != nullptr)
-				{
-					ERROR_LOG(PVR, "Error : pvr is supposed to remove lock");
-					die("Invalid state");
-				}
-			}
+void invalidateWrittenTextures()
+{
+	// Called for each texture lookup: only write the flag when it's set
+	if (!pagesWritten.load(std::memory_order_relaxed)
+			|| !pagesWritten.exchange(false, std::memory_order_acquire))
+		return;
+	for (u32 i = 0; i < VRAM_SIZE / PAGE_SIZE / 64; i++)
+	{
+		u64 pages = writtenPages[i].exchange(0, std::memory_order_acquire);
+		while (pages != 0)
+		{
+			u32 page = i * 64 + Common::LeastSignificantSetBit(pages);
+			pages &= pages - 1;
+			// invalidate() removes the block from the list
+			while (VramLocks[page] != nullptr)
+				VramLocks[page]->texture->invalidate();
 		}
-		list.clear();
+	}
+}
+
+static ReadbackArea lockReadbackPages(u32 start, u32 end)
+{
+	ReadbackArea area;
+	area.firstPage = start / PAGE_SIZE;
+	area.lastPage = end / PAGE_SIZE;
+	// Load the epoch before protecting: the writes trapped afterwards are newer
+	area.epoch = vramWriteEpoch.load(std::memory_order_acquire);
+	for (u32 page = area.firstPage; page <= area.lastPage; page++)
+		readbackLocks[page]++;
+	// The pages may have been unprotected by a write even if already locked
+	addrspace::protectVram(area.firstPage * PAGE_SIZE, (area.lastPage - area.firstPage + 1) * PAGE_SIZE);
+
+	return area;
+}
+
+ReadbackArea lockReadbackArea(u32 addr, u32 size)
+{
+	addr &= VRAM_MASK;
+	return lockReadbackPages(addr, std::min(addr + std::max(size, 1u), VRAM_SIZE) - 1);
+}
 
-		addrspace::unprotectVram((u32)(offset & ~PAGE_MASK), PAGE_SIZE);
+ReadbackArea lockFramebufferArea(u32 width, u32 height, u32 dstAddr, FB_W_CTRL_type fb_w_ctrl, u32 linestride)
+{
+	const u32 bpp = fb_w_ctrl.fb_packmode <= 3 ? 2 : fb_w_ctrl.fb_packmode == 4 ? 3 : 4;
+	const u32 size = std::max(linestride, width * bpp) * std::max(height, 1u);
+	// The banks are interleaved every 32 bits
+	u32 start = pvr_map32(dstAddr & VRAM_MASK) & ~7;
+	u32 end = pvr_map32((dstAddr + size - 1) & VRAM_MASK) | 7;
+	if (end < start || end >= VRAM_SIZE)
+	{
+		// Crosses a bank boundary
+		start = 0;
+		end = VRAM_SIZE - 1;
 	}
+	return lockReadbackPages(start, end);
+}
+
+bool writeReadbackArea(const ReadbackArea& area, const std::function<void()>& write)
+{
+	bool stale = false;
+	for (u32 page = area.firstPage; page <= area.lastPage && !stale; page++)
+		stale = pageWriteEpochs[page].load(std::memory_order_acquire) > area.epoch;
+	unlockReadbackArea(area);
+	if (stale)
+		return false;
+
+	// Unprotect the pages and invalidate their textures, without making the other pending readbacks stale
+	for (u32 page = area.firstPage; page <= area.lastPage; page++)
+		invalidateVramPage(page);
+	write();
+	// Protect the pages again if a later readback writes to them
+	for (u32 page = area.firstPage; page <= area.lastPage; page++)
+		if (readbackLocks[page] != 0)
+			addrspace::protectVram(page * PAGE_SIZE, PAGE_SIZE);
 
 	return true;
 }
 
-bool VramLockedWrite(u8* address)
+void unlockReadbackArea(const ReadbackArea& area)
 {
-	u32 offset = addrspace::getVramOffset(address);
-	if (offset == (u32)-1)
-		return false;
-	return VramLockedWriteOffset(offset);
+	for (u32 page = area.firstPage; page <= area.lastPage; page++)
+		readbackLocks[page]--;
 }
 
 //unlocks mem
@@ -428,23 +516,18 @@ void BaseTextureCacheData::protectVRam()
 	block->start = sa_tex;
 	block->texture = this;
 
+	if (lock_block == nullptr)
 	{
-		std::lock_guard<std::mutex> lock(vramlist_lock);
-
-		if (lock_block == nullptr)
-		{
-			// This also protects vram if needed
-			vramlock_list_add(block);
-			lock_block = block;
-		}
-		else
-			delete block;
+		// This also protects vram if needed
+		vramlock_list_add(block);
+		lock_block = block;
 	}
+	else
+		delete block;
 }
 
 void BaseTextureCacheData::unprotectVRam()
 {
-	std::lock_guard<std::mutex> lock(vramlist_lock);
 	if (lock_block)
 		libCore_vramlock_Unlock_block_wb(lock_block);
 	lock_block = nullptr;
@@ -457,6 +540,8 @@ bool BaseTextureCacheData::Delete()
 	if (custom_load_in_progress > 0)
 		return false;
 
+	textureCacheStats.size -= gpuSize;
+	gpuSize = 0;
 	free(custom_image_data);
 	custom_image_data = nullptr;
 
@@ -476,8 +561,14 @@ BaseTextureCacheData::BaseTextureCacheData(TSP tsp, TCW tcw)
 	dirty = FrameCount;
 	lock_block = nullptr;
 	custom_image_data = nullptr;
+	custom_mipmaps = false;
 	custom_load_in_progress = 0;
 	gpuPalette = false;
+	gpuSize = 0;
+	lastUsed = FrameCount;
+	cacheKey = 0;
+	lruPrev = nullptr;
+	lruNext = nullptr;
 
 	//decode info from tsp/tcw into the texture struct
 	tex = &pvrTexInfo[tcw.PixelFmt == PixelReserved ? Pixel1555 : tcw.PixelFmt];	//texture format table entry
@@ -798,6 +889,7 @@ bool BaseTextureCacheData::Update()
 	protectVRam();
 
 	UploadToGPU(upscaled_w, upscaled_h, (const u8 *)temp_tex_buffer, IsMipmapped(), mipmapped);
+	setGpuSize(upscaled_w, upscaled_h, IsMipmapped());
 	if (config::DumpTextures)
 	{
 		ComputeHash();
@@ -815,12 +907,42 @@ void BaseTextureCacheData::CheckCustomTexture()
 	{
 		tex_type = TextureType::_8888;
 		gpuPalette = false;
-		UploadToGPU(custom_width, custom_height, custom_image_data, IsMipmapped(), false);
+		UploadToGPU(custom_width, custom_height, custom_image_data, IsMipmapped(), custom_mipmaps);
+		setGpuSize(custom_width, custom_height, IsMipmapped());
 		free(custom_image_data);
 		custom_image_data = nullptr;
 	}
 }
 
+void BaseTextureCacheData::setGpuSize(u32 width, u32 height, bool mipmapped)
+{
+	u32 size = width * height;
+	if (tex_type == TextureType::_8888 || Force32BitTexture(tex_type))
+		size *= 4;
+	else if (tex_type != TextureType::_8)
+		size *= 2;
+	if (mipmapped)
+		// mipmap levels add a third
+		size += size / 3;
+	textureCacheStats.size += size - gpuSize;
+	gpuSize = size;
+}
+
+std::string TextureCacheStats::getOSDText() const
+{
+	const u32 lookups = lastHits + lastMisses;
+	char text[64];
+	int len = snprintf(text, sizeof(text), " T:%u %uMB %u%%", count, (u32)(size / 1024 / 1024),
+			lookups == 0 ? 100 : lastHits * 100 / lookups);
+	if (lastEvictions != 0)
+		len += snprintf(text + len, sizeof(text) - len, " E:%u", lastEvictions);
+	if (lastMemoHits != 0)
+		snprintf(text + len, sizeof(text) - len, " M:%u", lastMemoHits);
+	return text;
+}
+
+bool BaseTextureCacheData::gpuPaletteFiltering;
+
 void BaseTextureCacheData::SetDirectXColorOrder(bool enabled) {
 	pvrTexInfo = enabled ? directx::pvrTexInfo : opengl::pvrTexInfo;
 }
@@ -872,355 +994,114 @@ void ReadFramebuffer(const FramebufferInfo& info, PixelBuffer<u32>& pb, int& wid
 
 	pb.init(width, height);
 	u32 *dst = (u32 *)pb.data();
-	const u32 fb_concat = info.fb_r_ctrl.fb_concat;
+	// 888 lines are read by 32-bit words
+	const u32 lineBytes = info.fb_r_ctrl.fb_depth == fbde_888 ? (width * bpp + 3) & ~3 : width * bpp;
+	std::vector<u32> line((lineBytes + 3) / 4);
 
-	switch (info.fb_r_ctrl.fb_depth)
+	for (int y = 0; y < height; y++)
 	{
-		case fbde_0555:    // 555 RGB
-			for (int y = 0; y < height; y++)
-			{
-				for (int i = 0; i < width; i++)
-				{
-					u16 src = pvr_read32p<u16>(addr);
-					*dst++ = Packer::pack(
-							(((src >> 10) & 0x1F) << 3) | fb_concat,
-							(((src >> 5) & 0x1F) << 3) | fb_concat,
-							(((src >> 0) & 0x1F) << 3) | fb_concat,
-							0xff);
-					addr += bpp;
-				}
-				addr += modulus * bpp;
-			}
-			break;
-
-		case fbde_565:    // 565 RGB
-			for (int y = 0; y < height; y++)
-			{
-				for (int i = 0; i < width; i++)
-				{
-					u16 src = pvr_read32p<u16>(addr);
-					*dst++ = Packer::pack(
-							(((src >> 11) & 0x1F) << 3) | fb_concat,
-							(((src >> 5) & 0x3F) << 2) | (fb_concat & 3),
-							(((src >> 0) & 0x1F) << 3) | fb_concat,
-							0xFF);
-					addr += bpp;
-				}
-				addr += modulus * bpp;
-			}
-			break;
-		case fbde_888:		// 888 RGB
-			for (int y = 0; y < height; y++)
-			{
-				for (int i = 0; i < width; i += 4)
-				{
-					u32 src = pvr_read32p<u32>(addr);
-					*dst++ = Packer::pack(src >> 16, src >> 8, src, 0xff);
-					addr += 4;
-					if (i + 1 >= width)
-						break;
-					u32 src2 = pvr_read32p<u32>(addr);
-					*dst++ = Packer::pack(src2 >> 8, src2, src >> 24, 0xff);
-					addr += 4;
-					if (i + 2 >= width)
-						break;
-					u32 src3 = pvr_read32p<u32>(addr);
-					*dst++ = Packer::pack(src3, src2 >> 24, src2 >> 16, 0xff);
-					addr += 4;
-					if (i + 3 >= width)
-						break;
-					*dst++ = Packer::pack(src3 >> 24, src3 >> 16, src3 >> 8, 0xff);
-				}
-				addr += modulus * bpp;
-			}
-			break;
-		case fbde_C888:     // 0888 RGB
-			for (int y = 0; y < height; y++)
-			{
-				for (int i = 0; i < width; i++)
-				{
-					u32 src = pvr_read32p<u32>(addr);
-					*dst++ = Packer::pack(src >> 16, src >> 8, src, 0xff);
-					addr += bpp;
-				}
-				addr += modulus * bpp;
-			}
-			break;
+		if (bpp == 2 && (addr & 3) != 0)
+		{
+			u16 *line16 = (u16 *)line.data();
+			for (int i = 0; i < width; i++)
+				line16[i] = pvr_read32p<u16>(addr + i * 2);
+		}
+		else
+		{
+			for (u32 i = 0; i < lineBytes / 4; i++)
+				line[i] = pvr_read32p<u32>(addr + i * 4);
+		}
+		fbconv::unpack<Packer>((const u8 *)line.data(), dst, width, info.fb_r_ctrl);
+		dst += width;
+		addr += lineBytes + modulus * bpp;
 	}
 }
 template void ReadFramebuffer<RGBAPacker>(const FramebufferInfo& info, PixelBuffer<u32>& pb, int& width, int& height);
 template void ReadFramebuffer<BGRAPacker>(const FramebufferInfo& info, PixelBuffer<u32>& pb, int& width, int& height);
 
-template<int bits>
-static inline u8 roundColor(u8 in)
-{
-	u8 out = in >> (8 - bits);
-	if (out != 0xffu >> (8 - bits))
-		out += (in >> (8 - bits - 1)) & 1;
-	return out;
-}
-
 // write to 32-bit vram area (framebuffer)
 class FBPixelWriter
 {
 public:
 	FBPixelWriter(u32 dstAddr) : dstAddr(dstAddr) {}
 
-	template<typename T>
-	void write(T pixel) {
-		pvr_write32p(dstAddr, pixel);
-		dstAddr += sizeof(T);
-	}
-
-	void advance(int bytes) {
-		dstAddr += bytes;
-	}
-
-private:
-	u32 dstAddr;
-};
-
-// write to 64-bit vram area (render to texture)
-class TexPixelWriter
-{
-public:
-	TexPixelWriter(u16 *dest) : dest(dest) {}
-
-	void write(u16 pixel) {
-		*dest++ = pixel;
-	}
-
-	void advance(int bytes) {
-		(u8 *&)dest += bytes;
-	}
-
-private:
-	u16 *dest;
-};
-
-// 0555 KRGB 16 bit  (default)	Bit 15 is the value of fb_kval[7].
-template<int Red, int Green, int Blue, int Alpha, typename PixelWriter, bool Round = false>
-class FBLineWriter0555
-{
-public:
-	FBLineWriter0555(FB_W_CTRL_type fb_w_ctrl, PixelWriter& pixWriter) : pixWriter(pixWriter) {
-		kval_bit = (fb_w_ctrl.fb_kval & 0x80) << 8;
+	u8 *getLine(u32 bytes) {
+		line.resize((bytes + 3) / 4);
+		return (u8 *)line.data();
 	}
 
-	void write(int xmin, int xmax, const u8 *& pixel, int y)
+	void writeLine(u32 bytes, int bpp)
 	{
-		for (int c = xmin; c < xmax; c++)
+		const u8 *p = (const u8 *)line.data();
+		if (bpp == 2 && (dstAddr & 2) != 0 && bytes >= 2)
 		{
-			u8 red, green, blue;
-			if constexpr (Round)
-			{
-				red = roundColor<5>(pixel[Red]);
-				green = roundColor<5>(pixel[Green]);
-				blue = roundColor<5>(pixel[Blue]);
-			}
-			else
-			{
-				red = pixel[Red] >> 3;
-				green = pixel[Green] >> 3;
-				blue = pixel[Blue] >> 3;
-			}
-			pixWriter.write((u16)((red << 10) | (green << 5) | blue | kval_bit));
-			pixel += 4;
+			pvr_write32p(dstAddr, *(const u16 *)p);
+			dstAddr += 2;
+			p += 2;
+			bytes -= 2;
 		}
-	}
-
-	static constexpr int BytesPerPixel = 2;
-
-private:
-	u16 kval_bit;
-	PixelWriter& pixWriter;
-};
-
-// 565 RGB 16 bit
-template<int Red, int Green, int Blue, int Alpha, typename PixelWriter, bool Round = false>
-class FBLineWriter565
-{
-public:
-	FBLineWriter565(FB_W_CTRL_type fb_w_ctrl, PixelWriter& pixWriter) : pixWriter(pixWriter) {}
-
-	void write(int xmin, int xmax, const u8 *& pixel, int y)
-	{
-		for (int c = xmin; c < xmax; c++)
+		for (; bytes >= 4; bytes -= 4)
 		{
-			u8 red, green, blue;
-			if constexpr (Round)
-			{
-				red = roundColor<5>(pixel[Red]);
-				green = roundColor<6>(pixel[Green]);
-				blue = roundColor<5>(pixel[Blue]);
-			}
-			else
-			{
-				red = pixel[Red] >> 3;
-				green = pixel[Green] >> 2;
-				blue = pixel[Blue] >> 3;
-			}
-			pixWriter.write((u16)((red << 11) | (green << 5) | blue));
-			pixel += 4;
+			u32 word;
+			memcpy(&word, p, sizeof(word));
+			pvr_write32p(dstAddr, word);
+			dstAddr += 4;
+			p += 4;
 		}
-	}
-
-	static constexpr int BytesPerPixel = 2;
-
-private:
-	PixelWriter& pixWriter;
-};
-
-// 4444 ARGB 16 bit
-template<int Red, int Green, int Blue, int Alpha, typename PixelWriter, bool Round = false>
-class FBLineWriter4444
-{
-public:
-	FBLineWriter4444(FB_W_CTRL_type fb_w_ctrl, PixelWriter& pixWriter) : pixWriter(pixWriter) {}
-
-	void write(int xmin, int xmax, const u8 *& pixel, int y)
-	{
-		for (int c = xmin; c < xmax; c++)
+		if (bytes >= 2)
 		{
-			u8 red, green, blue, alpha;
-			if constexpr (Round)
-			{
-				red = roundColor<4>(pixel[Red]);
-				green = roundColor<4>(pixel[Green]);
-				blue = roundColor<4>(pixel[Blue]);
-				alpha = roundColor<4>(pixel[Alpha]);
-			}
-			else
-			{
-				red = pixel[Red] >> 4;
-				green = pixel[Green] >> 4;
-				blue = pixel[Blue] >> 4;
-				alpha = pixel[Alpha] >> 4;
-			}
-			pixWriter.write((u16)((red << 8) | (green << 4) | blue | (alpha << 12)));
-			pixel += 4;
+			u16 half;
+			memcpy(&half, p, sizeof(half));
+			pvr_write32p(dstAddr, half);
+			dstAddr += 2;
 		}
 	}
 
-	static constexpr int BytesPerPixel = 2;
-
-private:
-	PixelWriter& pixWriter;
-};
-
-// 1555 ARGB 16 bit    The alpha value is determined by comparison with the value of fb_alpha_threshold.
-template<int Red, int Green, int Blue, int Alpha, typename PixelWriter, bool Round = false>
-class FBLineWriter1555
-{
-public:
-	FBLineWriter1555(FB_W_CTRL_type fb_w_ctrl, PixelWriter& pixWriter) : pixWriter(pixWriter) {
-		fb_alpha_threshold = fb_w_ctrl.fb_alpha_threshold;
-	}
-
-	void write(int xmin, int xmax, const u8 *& pixel, int y)
-	{
-		for (int c = xmin; c < xmax; c++)
-		{
-			u8 red, green, blue;
-			if constexpr (Round)
-			{
-				red = roundColor<5>(pixel[Red]);
-				green = roundColor<5>(pixel[Green]);
-				blue = roundColor<5>(pixel[Blue]);
-			}
-			else
-			{
-				red = pixel[Red] >> 3;
-				green = pixel[Green] >> 3;
-				blue = pixel[Blue] >> 3;
-			}
-			pixWriter.write((u16)((red << 10) | (green << 5) | blue
-					| (pixel[Alpha] >= fb_alpha_threshold ? 0x8000 : 0)));
-			pixel += 4;
-		}
+	void advance(int bytes) {
+		dstAddr += bytes;
 	}
 
-	static constexpr int BytesPerPixel = 2;
-
 private:
-	PixelWriter& pixWriter;
-	u8 fb_alpha_threshold;
+	u32 dstAddr;
+	std::vector<u32> line;
 };
 
-// 888 RGB 24 bit packed
-template<int Red, int Green, int Blue, int Alpha, typename PixelWriter>
-class FBLineWriter888
+// write to 64-bit vram area (render to texture)
+class TexPixelWriter
 {
 public:
-	FBLineWriter888(FB_W_CTRL_type fb_w_ctrl, PixelWriter& pixWriter) : pixWriter(pixWriter) {}
+	TexPixelWriter(u16 *dest) : dest(dest) {}
 
-	void write(int xmin, int xmax, const u8 *& pixel, int y)
-	{
-		for (int c = xmin; c < xmax - 3; c += 4)
-		{
-			pixWriter.write((u32)((pixel[Blue + 4] << 24) | (pixel[Red] << 16) | (pixel[Green] << 8) | pixel[Blue]));
-			pixel += 4;
-			pixWriter.write((u32)((pixel[Green + 4] << 24) | (pixel[Blue + 4] << 16) | (pixel[Red] << 8) | pixel[Green]));
-			pixel += 4;
-			pixWriter.write((u32)((pixel[Red + 4] << 24) | (pixel[Green + 4] << 16) | (pixel[Blue + 4] << 8) | pixel[Red]));
-			pixel += 8;
-		}
+	u8 *getLine(u32 bytes) {
+		return (u8 *)dest;
 	}
 
-	static constexpr int BytesPerPixel = 3;
-
-private:
-	PixelWriter& pixWriter;
-};
-
-// 0888 KRGB 32 bit (K is the value of fb_kval.)
-template<int Red, int Green, int Blue, int Alpha, typename PixelWriter>
-class FBLineWriter0888
-{
-public:
-	FBLineWriter0888(FB_W_CTRL_type fb_w_ctrl, PixelWriter& pixWriter) : pixWriter(pixWriter) {
-		fb_kval = fb_w_ctrl.fb_kval << 24;
+	void writeLine(u32 bytes, int bpp) {
+		advance(bytes);
 	}
 
-	void write(int xmin, int xmax, const u8 *& pixel, int y)
-	{
-		for (int c = xmin; c < xmax; c++)
-		{
-			pixWriter.write((u32)((pixel[Red] << 16) | (pixel[Green] << 8) | pixel[Blue] | fb_kval));
-			pixel += 4;
-		}
+	void advance(int bytes) {
+		(u8 *&)dest += bytes;
 	}
 
-	static constexpr int BytesPerPixel = 4;
-
 private:
-	u32 fb_kval;
-	PixelWriter& pixWriter;
+	u16 *dest;
 };
 
-// 8888 ARGB 32 bit
-template<int Red, int Green, int Blue, int Alpha, typename PixelWriter>
-class FBLineWriter8888
+// Converts the pixels [xmin, xmax[ of a line. Returns the number of pixels converted.
+template<int Red, int Green, int Blue, int Alpha, bool Round, typename PixelWriter>
+static u32 writeLine(PixelWriter& pixWriter, int xmin, int xmax, const u8 *& pixel, FB_W_CTRL_type fb_w_ctrl, int bpp)
 {
-public:
-	FBLineWriter8888(FB_W_CTRL_type fb_w_ctrl, PixelWriter& pixWriter) : pixWriter(pixWriter) {}
-
-	void write(int xmin, int xmax, const u8 *& pixel, int y)
-	{
-		for (int c = xmin; c < xmax; c++)
-		{
-			pixWriter.write((u32)((pixel[Red] << 16) | (pixel[Green] << 8) | pixel[Blue] | (pixel[Alpha] << 24)));
-			pixel += 4;
-		}
-	}
-
-	static constexpr int BytesPerPixel = 4;
+	u32 count = std::max(xmax - xmin, 0);
+	u8 *line = pixWriter.getLine(count * bpp);
+	count = fbconv::pack<Red, Green, Blue, Alpha, Round>(pixel, line, count, fb_w_ctrl);
+	pixWriter.writeLine(count * bpp, bpp);
+	pixel += count * 4;
 
-private:
-	PixelWriter& pixWriter;
-};
+	return count;
+}
 
-template<typename FBLineWriter>
+template<int Red, int Green, int Blue, int Alpha, bool Round>
 static void writeTexture(u32 width, u32 height, const u8 *data, u16 *dst, FB_W_CTRL_type fb_w_ctrl, u32 linestride)
 {
 	u32 padding = linestride;
@@ -1230,10 +1111,9 @@ static void writeTexture(u32 width, u32 height, const u8 *data, u16 *dst, FB_W_C
 		padding = 0;
 
 	TexPixelWriter pixWriter(dst);
-	FBLineWriter lineWriter(fb_w_ctrl, pixWriter);
 
 	for (u32 l = 0; l < height; l++) {
-		lineWriter.write(0, width, data, l);
+		writeLine<Red, Green, Blue, Alpha, Round>(pixWriter, 0, width, data, fb_w_ctrl, 2);
 		pixWriter.advance(padding);
 	}
 }
@@ -1241,42 +1121,41 @@ static void writeTexture(u32 width, u32 height, const u8 *data, u16 *dst, FB_W_C
 template<int Red, int Green, int Blue, int Alpha>
 void WriteTextureToVRam(u32 width, u32 height, const u8 *data, u16 *dst, FB_W_CTRL_type fb_w_ctrl, u32 linestride)
 {
+	// 0555 KRGB, 565 RGB, 4444 ARGB and 1555 ARGB 16 bit only
+	if (fb_w_ctrl.fb_packmode > 3)
+		return;
 	bool dither = fb_w_ctrl.fb_dither && config::EmulateFramebuffer;
+	if (dither)
+		writeTexture<Red, Green, Blue, Alpha, false>(width, height, data, dst, fb_w_ctrl, linestride);
+	else
+		writeTexture<Red, Green, Blue, Alpha, true>(width, height, data, dst, fb_w_ctrl, linestride);
+}
+template void WriteTextureToVRam<0, 1, 2, 3>(u32 width, u32 height, const u8 *data, u16 *dst, FB_W_CTRL_type fb_w_ctrl, u32 linestride);
+template void WriteTextureToVRam<2, 1, 0, 3>(u32 width, u32 height, const u8 *data, u16 *dst, FB_W_CTRL_type fb_w_ctrl, u32 linestride);
+
+template<int Red, int Green, int Blue, int Alpha>
+void WriteFramebuffer(u32 width, u32 height, const u8 *data, u32 dstAddr, FB_W_CTRL_type fb_w_ctrl, u32 linestride, FB_X_CLIP_type xclip, FB_Y_CLIP_type yclip)
+{
+	int bpp;
 	switch (fb_w_ctrl.fb_packmode)
 	{
-	case 0: // 0555 KRGB 16 bit  (default)
-		if (dither)
-			writeTexture<FBLineWriter0555<Red, Green, Blue, Alpha, TexPixelWriter, false>>(width, height, data, dst, fb_w_ctrl, linestride);
-		else
-			writeTexture<FBLineWriter0555<Red, Green, Blue, Alpha, TexPixelWriter, true>>(width, height, data, dst, fb_w_ctrl, linestride);
-		break;
+	case 0: // 0555 KRGB 16 bit
 	case 1: // 565 RGB 16 bit
-		if (dither)
-			writeTexture<FBLineWriter565<Red, Green, Blue, Alpha, TexPixelWriter, false>>(width, height, data, dst, fb_w_ctrl, linestride);
-		else
-			writeTexture<FBLineWriter565<Red, Green, Blue, Alpha, TexPixelWriter, true>>(width, height, data, dst, fb_w_ctrl, linestride);
-		break;
 	case 2: // 4444 ARGB 16 bit
-		if (dither)
-			writeTexture<FBLineWriter4444<Red, Green, Blue, Alpha, TexPixelWriter, false>>(width, height, data, dst, fb_w_ctrl, linestride);
-		else
-			writeTexture<FBLineWriter4444<Red, Green, Blue, Alpha, TexPixelWriter, true>>(width, height, data, dst, fb_w_ctrl, linestride);
-		break;
 	case 3: // 1555 ARGB 16 bit
-		if (dither)
-			writeTexture<FBLineWriter1555<Red, Green, Blue, Alpha, TexPixelWriter, false>>(width, height, data, dst, fb_w_ctrl, linestride);
-		else
-			writeTexture<FBLineWriter1555<Red, Green, Blue, Alpha, TexPixelWriter, true>>(width, height, data, dst, fb_w_ctrl, linestride);
+		bpp = 2;
+		break;
+	case 4: // 888 RGB 24 bit packed
+		bpp = 3;
+		break;
+	case 5: // 0888 KRGB 32 bit
+	case 6: // 8888 ARGB 32 bit
+		bpp = 4;
 		break;
+	default:
+		die("Invalid framebuffer format");
+		return;
 	}
-}
-template void WriteTextureToVRam<0, 1, 2, 3>(u32 width, u32 height, const u8 *data, u16 *dst, FB_W_CTRL_type fb_w_ctrl, u32 linestride);
-template void WriteTextureToVRam<2, 1, 0, 3>(u32 width, u32 height, const u8 *data, u16 *dst, FB_W_CTRL_type fb_w_ctrl, u32 linestride);
-
-template<typename FBLineWriter>
-static void writeFramebufferLW(u32 width, u32 height, const u8 *data, u32 dstAddr, FB_W_CTRL_type fb_w_ctrl, u32 linestride, FB_X_CLIP_type xclip, FB_Y_CLIP_type yclip)
-{
-	int bpp = FBLineWriter::BytesPerPixel;
 
 	u32 padding = linestride;
 	if (padding > width * bpp)
@@ -1291,51 +1170,18 @@ static void writeFramebufferLW(u32 width, u32 height, const u8 *data, u32 dstAdd
 	height = std::min(height, yclip.max + 1u);
 
 	FBPixelWriter pixWriter(dstAddr);
-	FBLineWriter lineWriter(fb_w_ctrl, pixWriter);
 
 	for (u32 l = yclip.min; l < height; l++)
 	{
 		p += 4 * xclip.min;
 		pixWriter.advance(bpp * xclip.min);
 
-		lineWriter.write(xclip.min, clipWidth, p, l);
+		writeLine<Red, Green, Blue, Alpha, false>(pixWriter, xclip.min, clipWidth, p, fb_w_ctrl, bpp);
 
 		pixWriter.advance(padding + (width - xclip.max - 1) * bpp);
 		p += (width - xclip.max - 1) * 4;
 	}
 }
-
-template<int Red, int Green, int Blue, int Alpha>
-void WriteFramebuffer(u32 width, u32 height, const u8 *data, u32 dstAddr, FB_W_CTRL_type fb_w_ctrl, u32 linestride, FB_X_CLIP_type xclip, FB_Y_CLIP_type yclip)
-{
-	switch (fb_w_ctrl.fb_packmode)
-	{
-	case 0: // 0555 KRGB 16 bit
-		writeFramebufferLW<FBLineWriter0555<Red, Green, Blue, Alpha, FBPixelWriter>>(width, height, data, dstAddr, fb_w_ctrl, linestride, xclip, yclip);
-		break;
-	case 1: // 565 RGB 16 bit
-		writeFramebufferLW<FBLineWriter565<Red, Green, Blue, Alpha, FBPixelWriter>>(width, height, data, dstAddr, fb_w_ctrl, linestride, xclip, yclip);
-		break;
-	case 2: // 4444 ARGB 16 bit
-		writeFramebufferLW<FBLineWriter4444<Red, Green, Blue, Alpha, FBPixelWriter>>(width, height, data, dstAddr, fb_w_ctrl, linestride, xclip, yclip);
-		break;
-	case 3: // 1555 ARGB 16 bit
-		writeFramebufferLW<FBLineWriter1555<Red, Green, Blue, Alpha, FBPixelWriter>>(width, height, data, dstAddr, fb_w_ctrl, linestride, xclip, yclip);
-		break;
-	case 4: // 888 RGB 24 bit packed
-		writeFramebufferLW<FBLineWriter888<Red, Green, Blue, Alpha, FBPixelWriter>>(width, height, data, dstAddr, fb_w_ctrl, linestride, xclip, yclip);
-		break;
-	case 5: // 0888 KRGB 32 bit
-		writeFramebufferLW<FBLineWriter0888<Red, Green, Blue, Alpha, FBPixelWriter>>(width, height, data, dstAddr, fb_w_ctrl, linestride, xclip, yclip);
-		break;
-	case 6: // 8888 ARGB 32 bit
-		writeFramebufferLW<FBLineWriter8888<Red, Green, Blue, Alpha, FBPixelWriter>>(width, height, data, dstAddr, fb_w_ctrl, linestride, xclip, yclip);
-		break;
-	default:
-		die("Invalid framebuffer format");
-		break;
-	}
-}
 template void WriteFramebuffer<0, 1, 2, 3>(u32 width, u32 height, const u8 *data, u32 dstAddr, FB_W_CTRL_type fb_w_ctrl,
 		u32 linestride, FB_X_CLIP_type xclip, FB_Y_CLIP_type yclip);
 template void WriteFramebuffer<2, 1, 0, 3>(u32 width, u32 height, const u8 *data, u32 dstAddr, FB_W_CTRL_type fb_w_ctrl,
@@ -1344,6 +1190,7 @@ template void WriteFramebuffer<2, 1, 0, 3>(u32 width, u32 height, const u8 *data
 void BaseTextureCacheData::invalidate()
 {
 	dirty = FrameCount;
+	textureEpoch++;
 
 	libCore_vramlock_Unlock_block_wb(lock_block);
 	lock_block = nullptr;
@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <array>
 #include <atomic>
+#include <functional>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -20,6 +21,8 @@ extern u32 pal_hash_256[4];
 extern u32 pal_hash_16[64];
 extern bool KillTex;
 extern bool palette_updated;
+// Incremented whenever a cached texture may need to be updated or may be deleted
+extern std::atomic<u32> textureEpoch;
 
 extern u32 detwiddle[2][11][1024];
 
@@ -557,10 +560,40 @@ struct vram_block
 	u32 end;
 
 	BaseTextureCacheData *texture;
+
+	// Links in the list of blocks of each page, from start to end
+	struct Link {
+		vram_block *prev;
+		vram_block *next;
+	};
+	std::vector<Link> links;
 };
 
+// Lock-free, can be called from any thread
 bool VramLockedWriteOffset(size_t offset);
 bool VramLockedWrite(u8* address);
+// Invalidates the textures of the pages written since the last call.
+// Must be called by the thread owning the texture cache.
+void invalidateWrittenTextures();
+
+// Destination of an asynchronous readback. Its vram pages stay write-protected until the pixels are written
+// so that the writes made in the meantime are detected.
+struct ReadbackArea
+{
+	u32 firstPage = 0;
+	u32 lastPage = 0;
+	u64 epoch = 0;	// vram writes made after the area was locked have a greater epoch
+};
+// The following functions must be called by the thread owning the texture cache.
+// Locks size bytes of vram at the 64-bit offset addr
+ReadbackArea lockReadbackArea(u32 addr, u32 size);
+// Locks the vram area written by WriteFramebuffer() (32-bit path)
+ReadbackArea lockFramebufferArea(u32 width, u32 height, u32 dstAddr, FB_W_CTRL_type fb_w_ctrl, u32 linestride);
+// Calls write() unless the area has been written since it was locked, in which case the pixels are stale and dropped.
+// The area is unlocked in both cases. Returns false if the readback has been dropped.
+bool writeReadbackArea(const ReadbackArea& area, const std::function<void()>& write);
+// Unlocks the area of a discarded readback
+void unlockReadbackArea(const ReadbackArea& area);
 
 void UpscalexBRZ(int factor, u32* source, u32* dest, int width, int height, bool has_alpha);
 
@@ -596,8 +629,14 @@ public:
 		std::swap(custom_image_data, other.custom_image_data);
 		custom_width = other.custom_width;
 		custom_height = other.custom_height;
+		custom_mipmaps = other.custom_mipmaps;
 		custom_load_in_progress = 0;
 		gpuPalette = other.gpuPalette;
+		gpuSize = other.gpuSize;
+		lastUsed = other.lastUsed;
+		cacheKey = other.cacheKey;
+		lruPrev = nullptr;
+		lruNext = nullptr;
 	}
 
 	TSP tsp;        	//dreamcast texture parameters
@@ -628,9 +667,17 @@ public:
 	u8* custom_image_data;		// loaded custom image data
 	u32 custom_width;
 	u32 custom_height;
+	bool custom_mipmaps;		// custom_image_data includes the mipmaps, smallest first
 	std::atomic_int custom_load_in_progress;
 	bool gpuPalette;
 
+	// used for cache eviction
+	u32 gpuSize;		// size in bytes of the uploaded texture, including mipmaps
+	u32 lastUsed;		// frame number at which texture was last used
+	u64 cacheKey;
+	BaseTextureCacheData *lruPrev;	// more recently used
+	BaseTextureCacheData *lruNext;	// less recently used
+
 	void PrintTextureName();
 	virtual std::string GetId() = 0;
 
@@ -673,6 +720,7 @@ public:
 	bool NeedsUpdate();
 	virtual bool Delete();
 	virtual ~BaseTextureCacheData() = default;
+	void setGpuSize(u32 width, u32 height, bool mipmapped);
 	void protectVRam();
 	void unprotectVRam();
 	void invalidate();
@@ -680,27 +728,73 @@ public:
 	static bool IsGpuHandledPaletted(TSP tsp, TCW tcw)
 	{
 		// Some palette textures are handled on the GPU
-		// This is currently limited to textures using nearest filtering and not mipmapped.
+		// This is currently limited to textures not mipmapped, and using nearest filtering
+		// unless the renderer can filter paletted textures.
 		// Enabling texture upscaling or dumping also disables this mode.
 		return (tcw.PixelFmt == PixelPal4 || tcw.PixelFmt == PixelPal8)
 				&& config::TextureUpscale == 1
 				&& !config::DumpTextures
-				&& tsp.FilterMode == 0
+				&& (tsp.FilterMode == 0 || gpuPaletteFiltering)
 				&& !tcw.MipMapped
 				&& !tcw.VQ_Comp;
 	}
 	static void SetDirectXColorOrder(bool enabled);
+	// Renderers that do bilinear filtering of paletted textures in their shaders
+	static void SetGpuPaletteFiltering(bool enabled) { gpuPaletteFiltering = enabled; }
+	// True if a GPU paletted texture must be filtered by the shader
+	static bool IsFilteredGpuPalette(TSP tsp)
+	{
+		if (!gpuPaletteFiltering)
+			return false;
+		if (config::TextureFiltering == 0)
+			return tsp.FilterMode != 0;
+		return config::TextureFiltering == 2;
+	}
+
+private:
+	static bool gpuPaletteFiltering;
 };
 
 // TODO Split the texture cache in a separate header
 #include "CustomTexture.h"
 
+struct TextureCacheStats
+{
+	void newFrame()
+	{
+		lastHits = hits;
+		lastMisses = misses;
+		lastEvictions = evictions;
+		lastMemoHits = memoHits;
+		hits = 0;
+		misses = 0;
+		evictions = 0;
+		memoHits = 0;
+	}
+	std::string getOSDText() const;
+
+	// current frame
+	u32 hits = 0;
+	u32 misses = 0;
+	u32 evictions = 0;		// unused textures deleted to stay within the memory budget
+	u32 memoHits = 0;		// lookups and updates skipped thanks to the per-frame memo
+	// last frame
+	u32 lastHits = 0;
+	u32 lastMisses = 0;
+	u32 lastEvictions = 0;
+	u32 lastMemoHits = 0;
+	u32 count = 0;			// number of cached textures
+	u64 size = 0;			// gpu memory used by the cached textures, in bytes
+};
+extern TextureCacheStats textureCacheStats;
+
 template<typename Texture>
 class BaseTextureCache
 {
 public:
 	Texture *getTextureCacheData(TSP tsp, TCW tcw)
 	{
+		invalidateWrittenTextures();
 		u64 key = tsp.full & TSPTextureCacheMask.full;
 		if (tcw.PixelFmt == PixelPal4 || tcw.PixelFmt == PixelPal8)
 		{
@@ -725,15 +819,43 @@ public:
 			texture = &it->second;
 			// Needed if the texture is updated
 			texture->tcw.StrideSel = tcw.StrideSel;
+			textureCacheStats.hits++;
 		}
 		else //create if not existing
 		{
 			texture = &cache.emplace(std::make_pair(key, Texture(tsp, tcw))).first->second;
+			texture->cacheKey = key;
+			textureCacheStats.misses++;
 		}
+		lruTouch(texture);
 
 		return texture;
 	}
 
+	// Returns the texture last returned by the renderer for this tsp and tcw during the current frame,
+	// or nullptr if the texture cache or palettes have changed since then.
+	Texture *getMemoizedTexture(TSP tsp, TCW tcw)
+	{
+		invalidateWrittenTextures();
+		const MemoEntry& entry = memo[memoIndex(tsp, tcw)];
+		if (entry.epoch != textureEpoch.load(std::memory_order_relaxed)
+				|| entry.tsp.full != tsp.full || entry.tcw.full != tcw.full
+				|| entry.texture->IsCustomTextureAvailable())
+			return nullptr;
+		textureCacheStats.memoHits++;
+		return entry.texture;
+	}
+
+	// Records a texture that is up to date and ready to be used
+	void memoizeTexture(TSP tsp, TCW tcw, Texture *texture)
+	{
+		MemoEntry& entry = memo[memoIndex(tsp, tcw)];
+		entry.tsp = tsp;
+		entry.tcw = tcw;
+		entry.epoch = textureEpoch.load(std::memory_order_relaxed);
+		entry.texture = texture;
+	}
+
 	Texture *getRTTexture(u32 address, u32 fb_packmode, u32 width, u32 height)
 	{
 		// TexAddr : (address), Reserved : 0, StrideSel : 0, ScanOrder : 1
@@ -758,8 +880,17 @@ public:
 		return getTextureCacheData(tsp, tcw);
 	}
 
-	void CollectCleanup()
+	void CollectCleanup() {
+		CollectCleanup([](Texture *texture) { return texture->Delete(); });
+	}
+
+	// deleteTexture must release the texture resources, or return false if it can't be deleted yet
+	template<typename DeleteFunc>
+	void CollectCleanup(DeleteFunc deleteTexture)
 	{
+		textureCacheStats.newFrame();
+		// The memo only lasts one frame
+		textureEpoch++;
 		std::vector<u64> list;
 
 		u32 TargetFrame = std::max((u32)120, FrameCount) - 120;
@@ -774,10 +905,20 @@ public:
 		}
 
 		for (u64 id : list)
+			erase(id, deleteTexture);
+
+		// Evict the least recently used textures if over budget
+		const u64 budget = (u64)config::TextureCacheBudget * 1024 * 1024;
+		BaseTextureCacheData *texture = lruTail;
+		while (budget != 0 && textureCacheStats.size > budget && texture != nullptr
+				&& texture->lastUsed + MinEvictionAge < FrameCount)
 		{
-			if (cache.find(id)->second.Delete())
-				cache.erase(id);
+			BaseTextureCacheData *prev = texture->lruPrev;
+			if (erase(texture->cacheKey, deleteTexture))
+				textureCacheStats.evictions++;
+			texture = prev;
 		}
+		textureCacheStats.count = (u32)cache.size();
 	}
 
 	void Clear()
@@ -787,12 +928,77 @@ public:
 			texture.Delete();
 
 		cache.clear();
+		textureEpoch++;
+		lruHead = nullptr;
+		lruTail = nullptr;
+		textureCacheStats.count = 0;
+		// Delete() keeps the size of textures with a custom texture being loaded
+		textureCacheStats.size = 0;
 		KillTex = false;
 		INFO_LOG(RENDERER, "Texture cache cleared");
 	}
 
 protected:
+	template<typename DeleteFunc>
+	bool erase(u64 id, DeleteFunc& deleteTexture)
+	{
+		auto it = cache.find(id);
+		if (!deleteTexture(&it->second))
+			return false;
+		lruUnlink(&it->second);
+		cache.erase(it);
+		textureEpoch++;
+		return true;
+	}
+
+	void lruTouch(BaseTextureCacheData *texture)
+	{
+		texture->lastUsed = FrameCount;
+		if (lruHead == texture)
+			return;
+		lruUnlink(texture);
+		texture->lruNext = lruHead;
+		if (lruHead != nullptr)
+			lruHead->lruPrev = texture;
+		else
+			lruTail = texture;
+		lruHead = texture;
+	}
+
+	void lruUnlink(BaseTextureCacheData *texture)
+	{
+		if (texture->lruPrev != nullptr)
+			texture->lruPrev->lruNext = texture->lruNext;
+		else if (lruHead == texture)
+			lruHead = texture->lruNext;
+		if (texture->lruNext != nullptr)
+			texture->lruNext->lruPrev = texture->lruPrev;
+		else if (lruTail == texture)
+			lruTail = texture->lruPrev;
+		texture->lruPrev = nullptr;
+		texture->lruNext = nullptr;
+	}
+
+	static u32 memoIndex(TSP tsp, TCW tcw) {
+		return ((tcw.full ^ (tsp.full << 7)) * 0x9E3779B1u) >> (32 - MemoBits);
+	}
+
 	std::unordered_map<u64, Texture> cache;
+	// Direct-mapped memo of the textures used in the current frame
+	struct MemoEntry
+	{
+		TSP tsp{};
+		TCW tcw{};
+		u32 epoch = 0;
+		Texture *texture = nullptr;
+	};
+	static constexpr u32 MemoBits = 8;
+	std::array<MemoEntry, 1 << MemoBits> memo {};
+	// Most and least recently used textures
+	BaseTextureCacheData *lruHead = nullptr;
+	BaseTextureCacheData *lruTail = nullptr;
+	// Textures used in the last second aren't evicted
+	static constexpr u32 MinEvictionAge = 60;
 	// Only use TexU and TexV from TSP in the cache key
 	//     TexV : 7, TexU : 7
 	const TSP TSPTextureCacheMask = { { 7, 7 } };
@@ -294,14 +294,17 @@ bool DX11Renderer::ensureBufferSize(ComPtr<ID3D11Buffer>& buffer, D3D11_BIND_FLA
 
 BaseTextureCacheData *DX11Renderer::GetTexture(TSP tsp, TCW tcw)
 {
+	DX11Texture* tf = texCache.getMemoizedTexture(tsp, tcw);
+	if (tf != nullptr)
+		return tf;
 	//lookup texture
-	DX11Texture* tf = texCache.getTextureCacheData(tsp, tcw);
+	tf = texCache.getTextureCacheData(tsp, tcw);
 
 	//update if needed
 	if (tf->NeedsUpdate())
 	{
 		if (!tf->Update())
-			tf = nullptr;
+			return nullptr;
 	}
 	else if (tf->IsCustomTextureAvailable())
 	{
@@ -310,6 +313,7 @@ BaseTextureCacheData *DX11Renderer::GetTexture(TSP tsp, TCW tcw)
 		// FIXME textureView
 		tf->loadCustomTexture();
 	}
+	texCache.memoizeTexture(tsp, tcw, tf);
 	return tf;
 }
 
@@ -49,6 +49,7 @@ class DX11TextureCache final : public BaseTextureCache<DX11Texture>
 public:
 	DX11TextureCache() {
 		DX11Texture::SetDirectXColorOrder(true);
+		DX11Texture::SetGpuPaletteFiltering(false);
 	}
 	~DX11TextureCache() {
 		Clear();
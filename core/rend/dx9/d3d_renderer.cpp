@@ -217,14 +217,17 @@ BaseTextureCacheData *D3DRenderer::GetTexture(TSP tsp, TCW tcw)
 {
 	if (!theDXContext.isReady())
 		return nullptr;
+	D3DTexture* tf = texCache.getMemoizedTexture(tsp, tcw);
+	if (tf != nullptr)
+		return tf;
 	//lookup texture
-	D3DTexture* tf = texCache.getTextureCacheData(tsp, tcw);
+	tf = texCache.getTextureCacheData(tsp, tcw);
 
 	//update if needed
 	if (tf->NeedsUpdate())
 	{
 		if (!tf->Update())
-			tf = nullptr;
+			return nullptr;
 	}
 	else if (tf->IsCustomTextureAvailable())
 	{
@@ -232,6 +235,7 @@ BaseTextureCacheData *D3DRenderer::GetTexture(TSP tsp, TCW tcw)
 		tf->texture.reset();
 		tf->loadCustomTexture();
 	}
+	texCache.memoizeTexture(tsp, tcw, tf);
 	return tf;
 }
 
@@ -42,6 +42,7 @@ class D3DTextureCache final : public BaseTextureCache<D3DTexture>
 public:
 	D3DTextureCache() {
 		D3DTexture::SetDirectXColorOrder(true);
+		D3DTexture::SetGpuPaletteFiltering(false);
 	}
 	~D3DTextureCache() {
 		Clear();
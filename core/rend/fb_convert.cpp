@@ -0,0 +1,543 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "fb_convert.h"
+#include "TexCache.h"
+#include <cstring>
+#include <type_traits>
+
+#if HOST_CPU == CPU_X86 || HOST_CPU == CPU_X64
+#include <emmintrin.h>
+#define FB_CONVERT_SSE
+#elif HOST_CPU == CPU_ARM64 || (HOST_CPU == CPU_ARM && defined(__ARM_NEON__))
+#include <arm_neon.h>
+#define FB_CONVERT_NEON
+#endif
+
+namespace fbconv {
+
+static constexpr u32 PackedBytesPerPixel[8] { 2, 2, 2, 2, 3, 4, 4, 0 };
+
+template<int bits, bool Round>
+static inline u32 convert(u8 in)
+{
+	u8 out = in >> (8 - bits);
+	if constexpr (Round)
+	{
+		if (out != 0xffu >> (8 - bits))
+			out += (in >> (8 - bits - 1)) & 1;
+	}
+	return out;
+}
+
+template<int Red, int Green, int Blue, int Alpha, bool Round>
+u32 packScalar(const u8 *src, u8 *dst, u32 count, FB_W_CTRL_type fb_w_ctrl)
+{
+	u16 *dst16 = (u16 *)dst;
+	u32 *dst32 = (u32 *)dst;
+	switch (fb_w_ctrl.fb_packmode)
+	{
+	case 0: // 0555 KRGB 16 bit. Bit 15 is the value of fb_kval[7].
+		{
+			const u32 kval = (fb_w_ctrl.fb_kval & 0x80) << 8;
+			for (u32 i = 0; i < count; i++, src += 4)
+				dst16[i] = (convert<5, Round>(src[Red]) << 10) | (convert<5, Round>(src[Green]) << 5)
+					| convert<5, Round>(src[Blue]) | kval;
+		}
+		return count;
+	case 1: // 565 RGB 16 bit
+		for (u32 i = 0; i < count; i++, src += 4)
+			dst16[i] = (convert<5, Round>(src[Red]) << 11) | (convert<6, Round>(src[Green]) << 5)
+				| convert<5, Round>(src[Blue]);
+		return count;
+	case 2: // 4444 ARGB 16 bit
+		for (u32 i = 0; i < count; i++, src += 4)
+			dst16[i] = (convert<4, Round>(src[Red]) << 8) | (convert<4, Round>(src[Green]) << 4)
+				| convert<4, Round>(src[Blue]) | (convert<4, Round>(src[Alpha]) << 12);
+		return count;
+	case 3: // 1555 ARGB 16 bit. The alpha value is determined by comparison with the value of fb_alpha_threshold.
+		for (u32 i = 0; i < count; i++, src += 4)
+			dst16[i] = (convert<5, Round>(src[Red]) << 10) | (convert<5, Round>(src[Green]) << 5)
+				| convert<5, Round>(src[Blue]) | (src[Alpha] >= fb_w_ctrl.fb_alpha_threshold ? 0x8000 : 0);
+		return count;
+	case 4: // 888 RGB 24 bit packed
+		count &= ~3;
+		for (u32 i = 0; i < count; i++, src += 4)
+		{
+			*dst++ = src[Blue];
+			*dst++ = src[Green];
+			*dst++ = src[Red];
+		}
+		return count;
+	case 5: // 0888 KRGB 32 bit (K is the value of fb_kval.)
+		for (u32 i = 0; i < count; i++, src += 4)
+			dst32[i] = (src[Red] << 16) | (src[Green] << 8) | src[Blue] | (fb_w_ctrl.fb_kval << 24);
+		return count;
+	case 6: // 8888 ARGB 32 bit
+		for (u32 i = 0; i < count; i++, src += 4)
+			dst32[i] = (src[Red] << 16) | (src[Green] << 8) | src[Blue] | (src[Alpha] << 24);
+		return count;
+	default:
+		return 0;
+	}
+}
+
+template<typename Packer>
+void unpackScalar(const u8 *src, u32 *dst, u32 count, FB_R_CTRL_type fb_r_ctrl)
+{
+	const u32 fb_concat = fb_r_ctrl.fb_concat;
+	const u16 *src16 = (const u16 *)src;
+	switch (fb_r_ctrl.fb_depth)
+	{
+	case fbde_0555:
+		for (u32 i = 0; i < count; i++)
+			dst[i] = Packer::pack(
+					(((src16[i] >> 10) & 0x1F) << 3) | fb_concat,
+					(((src16[i] >> 5) & 0x1F) << 3) | fb_concat,
+					(((src16[i] >> 0) & 0x1F) << 3) | fb_concat,
+					0xff);
+		break;
+	case fbde_565:
+		for (u32 i = 0; i < count; i++)
+			dst[i] = Packer::pack(
+					(((src16[i] >> 11) & 0x1F) << 3) | fb_concat,
+					(((src16[i] >> 5) & 0x3F) << 2) | (fb_concat & 3),
+					(((src16[i] >> 0) & 0x1F) << 3) | fb_concat,
+					0xff);
+		break;
+	case fbde_888:
+		for (u32 i = 0; i < count; i++, src += 3)
+			dst[i] = Packer::pack(src[2], src[1], src[0], 0xff);
+		break;
+	case fbde_C888:
+		for (u32 i = 0; i < count; i++, src += 4)
+			dst[i] = Packer::pack(src[2], src[1], src[0], 0xff);
+		break;
+	}
+}
+
+#if defined(FB_CONVERT_SSE)
+
+// One component of 4 host pixels in 32-bit lanes
+template<int Offset>
+static inline __m128i component(__m128i pixels) {
+	return _mm_and_si128(_mm_srli_epi32(pixels, Offset * 8), _mm_set1_epi32(0xff));
+}
+
+template<int bits, bool Round>
+static inline __m128i convert(__m128i c)
+{
+	if constexpr (Round)
+	{
+		// add the next bit and saturate. Lanes are less than 0x8000 so a 16-bit min does the job
+		c = _mm_srli_epi32(_mm_add_epi32(_mm_srli_epi32(c, 7 - bits), _mm_set1_epi32(1)), 1);
+		return _mm_min_epi16(c, _mm_set1_epi32((1 << bits) - 1));
+	}
+	else
+	{
+		return _mm_srli_epi32(c, 8 - bits);
+	}
+}
+
+template<int Red, int Green, int Blue>
+static inline __m128i rgb(__m128i pixels)
+{
+	return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(component<Red>(pixels), 16), _mm_slli_epi32(component<Green>(pixels), 8)),
+			component<Blue>(pixels));
+}
+
+// 8 pixels per iteration
+template<typename F>
+static u32 pack16(const u8 *src, u8 *dst, u32 count, F convertPixels)
+{
+	u32 i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m128i lo = convertPixels(_mm_loadu_si128((const __m128i *)&src[i * 4]));
+		__m128i hi = convertPixels(_mm_loadu_si128((const __m128i *)&src[i * 4 + 16]));
+		// sign extend so that the signed saturation of packs leaves the values untouched
+		lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+		hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+		_mm_storeu_si128((__m128i *)&dst[i * 2], _mm_packs_epi32(lo, hi));
+	}
+	return i;
+}
+
+// 4 pixels per iteration
+template<typename F>
+static u32 pack32(const u8 *src, u8 *dst, u32 count, F convertPixels)
+{
+	u32 i = 0;
+	for (; i + 4 <= count; i += 4)
+		_mm_storeu_si128((__m128i *)&dst[i * 4], convertPixels(_mm_loadu_si128((const __m128i *)&src[i * 4])));
+	return i;
+}
+
+template<int Red, int Green, int Blue, int Alpha, bool Round>
+u32 pack(const u8 *src, u8 *dst, u32 count, FB_W_CTRL_type fb_w_ctrl)
+{
+	u32 done = 0;
+	switch (fb_w_ctrl.fb_packmode)
+	{
+	case 0: // 0555 KRGB 16 bit
+		{
+			const __m128i kval = _mm_set1_epi32((fb_w_ctrl.fb_kval & 0x80) << 8);
+			done = pack16(src, dst, count, [kval](__m128i p) {
+				return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(convert<5, Round>(component<Red>(p)), 10),
+						_mm_slli_epi32(convert<5, Round>(component<Green>(p)), 5)),
+						_mm_or_si128(convert<5, Round>(component<Blue>(p)), kval));
+			});
+		}
+		break;
+	case 1: // 565 RGB 16 bit
+		done = pack16(src, dst, count, [](__m128i p) {
+			return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(convert<5, Round>(component<Red>(p)), 11),
+					_mm_slli_epi32(convert<6, Round>(component<Green>(p)), 5)),
+					convert<5, Round>(component<Blue>(p)));
+		});
+		break;
+	case 2: // 4444 ARGB 16 bit
+		done = pack16(src, dst, count, [](__m128i p) {
+			return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(convert<4, Round>(component<Red>(p)), 8),
+					_mm_slli_epi32(convert<4, Round>(component<Green>(p)), 4)),
+					_mm_or_si128(convert<4, Round>(component<Blue>(p)), _mm_slli_epi32(convert<4, Round>(component<Alpha>(p)), 12)));
+		});
+		break;
+	case 3: // 1555 ARGB 16 bit
+		{
+			// alpha >= threshold <=> alpha > threshold - 1
+			const __m128i threshold = _mm_set1_epi32((int)fb_w_ctrl.fb_alpha_threshold - 1);
+			done = pack16(src, dst, count, [threshold](__m128i p) {
+				return _mm_or_si128(_mm_or_si128(_mm_slli_epi32(convert<5, Round>(component<Red>(p)), 10),
+						_mm_slli_epi32(convert<5, Round>(component<Green>(p)), 5)),
+						_mm_or_si128(convert<5, Round>(component<Blue>(p)),
+								_mm_and_si128(_mm_cmpgt_epi32(component<Alpha>(p), threshold), _mm_set1_epi32(0x8000))));
+			});
+		}
+		break;
+	case 4: // 888 RGB 24 bit packed
+		{
+			const __m128i mask = _mm_setr_epi32(0xffffff, 0, 0, 0);
+			for (; done + 4 <= count; done += 4)
+			{
+				// drop the 4th byte of each 0RGB pixel
+				__m128i x = rgb<Red, Green, Blue>(_mm_loadu_si128((const __m128i *)&src[done * 4]));
+				__m128i v = _mm_or_si128(_mm_and_si128(x, mask),
+						_mm_srli_si128(_mm_and_si128(x, _mm_slli_si128(mask, 4)), 1));
+				v = _mm_or_si128(v, _mm_or_si128(_mm_srli_si128(_mm_and_si128(x, _mm_slli_si128(mask, 8)), 2),
+						_mm_srli_si128(_mm_and_si128(x, _mm_slli_si128(mask, 12)), 3)));
+				_mm_storel_epi64((__m128i *)&dst[done * 3], v);
+				const u32 last = _mm_cvtsi128_si32(_mm_srli_si128(v, 8));
+				memcpy(&dst[done * 3 + 8], &last, sizeof(last));
+			}
+		}
+		break;
+	case 5: // 0888 KRGB 32 bit
+		{
+			const __m128i kval = _mm_set1_epi32(fb_w_ctrl.fb_kval << 24);
+			done = pack32(src, dst, count, [kval](__m128i p) {
+				return _mm_or_si128(rgb<Red, Green, Blue>(p), kval);
+			});
+		}
+		break;
+	case 6: // 8888 ARGB 32 bit
+		done = pack32(src, dst, count, [](__m128i p) {
+			return _mm_or_si128(rgb<Red, Green, Blue>(p), _mm_slli_epi32(component<Alpha>(p), 24));
+		});
+		break;
+	default:
+		return 0;
+	}
+	return done + packScalar<Red, Green, Blue, Alpha, Round>(src + done * 4, dst + done * PackedBytesPerPixel[fb_w_ctrl.fb_packmode],
+			count - done, fb_w_ctrl);
+}
+
+// 0RGB to host pixels with an opaque alpha
+template<typename Packer>
+static inline __m128i unpack0888(__m128i x)
+{
+	if constexpr (std::is_same_v<Packer, BGRAPacker>)
+		return _mm_or_si128(x, _mm_set1_epi32(0xff000000));
+	else
+		return _mm_or_si128(_mm_or_si128(_mm_and_si128(x, _mm_set1_epi32(0xff00)), _mm_set1_epi32(0xff000000)),
+				_mm_or_si128(_mm_slli_epi32(_mm_and_si128(x, _mm_set1_epi32(0xff)), 16),
+						_mm_and_si128(_mm_srli_epi32(x, 16), _mm_set1_epi32(0xff))));
+}
+
+// 8-bit red, green and blue in 16-bit lanes to 8 host pixels
+template<typename Packer>
+static inline void storePixels(u32 *dst, __m128i r, __m128i g, __m128i b)
+{
+	if constexpr (std::is_same_v<Packer, BGRAPacker>)
+		std::swap(r, b);
+	const __m128i lo = _mm_or_si128(r, _mm_slli_epi16(g, 8));
+	const __m128i hi = _mm_or_si128(b, _mm_set1_epi16((short)0xff00));
+	_mm_storeu_si128((__m128i *)&dst[0], _mm_unpacklo_epi16(lo, hi));
+	_mm_storeu_si128((__m128i *)&dst[4], _mm_unpackhi_epi16(lo, hi));
+}
+
+template<typename Packer>
+void unpack(const u8 *src, u32 *dst, u32 count, FB_R_CTRL_type fb_r_ctrl)
+{
+	const __m128i concat = _mm_set1_epi16(fb_r_ctrl.fb_concat);
+	const __m128i mask5 = _mm_set1_epi16(0x1f);
+	u32 done = 0;
+	switch (fb_r_ctrl.fb_depth)
+	{
+	case fbde_0555:
+		for (; done + 8 <= count; done += 8)
+		{
+			__m128i v = _mm_loadu_si128((const __m128i *)&src[done * 2]);
+			storePixels<Packer>(&dst[done],
+					_mm_or_si128(_mm_slli_epi16(_mm_and_si128(_mm_srli_epi16(v, 10), mask5), 3), concat),
+					_mm_or_si128(_mm_slli_epi16(_mm_and_si128(_mm_srli_epi16(v, 5), mask5), 3), concat),
+					_mm_or_si128(_mm_slli_epi16(_mm_and_si128(v, mask5), 3), concat));
+		}
+		unpackScalar<Packer>(src + done * 2, dst + done, count - done, fb_r_ctrl);
+		break;
+	case fbde_565:
+		{
+			const __m128i concat2 = _mm_and_si128(concat, _mm_set1_epi16(3));
+			for (; done + 8 <= count; done += 8)
+			{
+				__m128i v = _mm_loadu_si128((const __m128i *)&src[done * 2]);
+				storePixels<Packer>(&dst[done],
+						_mm_or_si128(_mm_slli_epi16(_mm_srli_epi16(v, 11), 3), concat),
+						_mm_or_si128(_mm_slli_epi16(_mm_and_si128(_mm_srli_epi16(v, 5), _mm_set1_epi16(0x3f)), 2), concat2),
+						_mm_or_si128(_mm_slli_epi16(_mm_and_si128(v, mask5), 3), concat));
+			}
+			unpackScalar<Packer>(src + done * 2, dst + done, count - done, fb_r_ctrl);
+		}
+		break;
+	case fbde_888:
+		{
+			const __m128i mask = _mm_setr_epi32(0xffffff, 0, 0, 0);
+			for (; done + 4 <= count; done += 4)
+			{
+				// insert a 4th byte after each group of 3
+				u32 last;
+				memcpy(&last, &src[done * 3 + 8], sizeof(last));
+				__m128i v = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)&src[done * 3]), _mm_cvtsi32_si128(last));
+				__m128i x = _mm_or_si128(_mm_and_si128(v, mask),
+						_mm_and_si128(_mm_slli_si128(v, 1), _mm_slli_si128(mask, 4)));
+				x = _mm_or_si128(x, _mm_or_si128(_mm_and_si128(_mm_slli_si128(v, 2), _mm_slli_si128(mask, 8)),
+						_mm_and_si128(_mm_slli_si128(v, 3), _mm_slli_si128(mask, 12))));
+				_mm_storeu_si128((__m128i *)&dst[done], unpack0888<Packer>(x));
+			}
+			unpackScalar<Packer>(src + done * 3, dst + done, count - done, fb_r_ctrl);
+		}
+		break;
+	case fbde_C888:
+		for (; done + 4 <= count; done += 4)
+			_mm_storeu_si128((__m128i *)&dst[done], unpack0888<Packer>(_mm_loadu_si128((const __m128i *)&src[done * 4])));
+		unpackScalar<Packer>(src + done * 4, dst + done, count - done, fb_r_ctrl);
+		break;
+	}
+}
+
+#elif defined(FB_CONVERT_NEON)
+
+template<int bits, bool Round>
+static inline uint8x16_t convert(uint8x16_t c)
+{
+	if constexpr (Round)
+		// rounding shift then saturate
+		return vminq_u8(vrshrq_n_u8(c, 8 - bits), vdupq_n_u8((1 << bits) - 1));
+	else
+		return vshrq_n_u8(c, 8 - bits);
+}
+
+template<int Shift>
+static inline uint16x8_t shiftLow(uint8x16_t v) {
+	return vshlq_n_u16(vmovl_u8(vget_low_u8(v)), Shift);
+}
+template<int Shift>
+static inline uint16x8_t shiftHigh(uint8x16_t v) {
+	return vshlq_n_u16(vmovl_u8(vget_high_u8(v)), Shift);
+}
+
+// Combines the components of 16 pixels into 16-bit values
+template<int ShiftR, int ShiftG, int ShiftB, int ShiftA>
+static inline void store16(u8 *dst, uint8x16_t r, uint8x16_t g, uint8x16_t b, uint8x16_t a)
+{
+	vst1q_u16((u16 *)&dst[0], vorrq_u16(vorrq_u16(shiftLow<ShiftR>(r), shiftLow<ShiftG>(g)),
+			vorrq_u16(shiftLow<ShiftB>(b), shiftLow<ShiftA>(a))));
+	vst1q_u16((u16 *)&dst[16], vorrq_u16(vorrq_u16(shiftHigh<ShiftR>(r), shiftHigh<ShiftG>(g)),
+			vorrq_u16(shiftHigh<ShiftB>(b), shiftHigh<ShiftA>(a))));
+}
+
+template<int Red, int Green, int Blue, int Alpha, bool Round>
+u32 pack(const u8 *src, u8 *dst, u32 count, FB_W_CTRL_type fb_w_ctrl)
+{
+	const u32 packmode = fb_w_ctrl.fb_packmode;
+	if (packmode > 6)
+		return 0;
+	const uint8x16_t kval = vdupq_n_u8(packmode == 0 ? fb_w_ctrl.fb_kval >> 7 : fb_w_ctrl.fb_kval);
+	const uint8x16_t threshold = vdupq_n_u8(fb_w_ctrl.fb_alpha_threshold);
+	const u32 bpp = PackedBytesPerPixel[packmode];
+	u32 done = 0;
+	// 16 pixels per iteration, one component per register
+	for (; done + 16 <= count; done += 16)
+	{
+		const uint8x16x4_t p = vld4q_u8(&src[done * 4]);
+		u8 *d = &dst[done * bpp];
+		switch (packmode)
+		{
+		case 0: // 0555 KRGB 16 bit
+			store16<10, 5, 0, 15>(d, convert<5, Round>(p.val[Red]), convert<5, Round>(p.val[Green]), convert<5, Round>(p.val[Blue]), kval);
+			break;
+		case 1: // 565 RGB 16 bit
+			store16<11, 5, 0, 0>(d, convert<5, Round>(p.val[Red]), convert<6, Round>(p.val[Green]), convert<5, Round>(p.val[Blue]), vdupq_n_u8(0));
+			break;
+		case 2: // 4444 ARGB 16 bit
+			store16<8, 4, 0, 12>(d, convert<4, Round>(p.val[Red]), convert<4, Round>(p.val[Green]), convert<4, Round>(p.val[Blue]),
+					convert<4, Round>(p.val[Alpha]));
+			break;
+		case 3: // 1555 ARGB 16 bit
+			store16<10, 5, 0, 15>(d, convert<5, Round>(p.val[Red]), convert<5, Round>(p.val[Green]), convert<5, Round>(p.val[Blue]),
+					vandq_u8(vcgeq_u8(p.val[Alpha], threshold), vdupq_n_u8(1)));
+			break;
+		case 4: // 888 RGB 24 bit packed
+			{
+				uint8x16x3_t v;
+				v.val[0] = p.val[Blue];
+				v.val[1] = p.val[Green];
+				v.val[2] = p.val[Red];
+				vst3q_u8(d, v);
+			}
+			break;
+		case 5: // 0888 KRGB 32 bit
+		case 6: // 8888 ARGB 32 bit
+			{
+				uint8x16x4_t v;
+				v.val[0] = p.val[Blue];
+				v.val[1] = p.val[Green];
+				v.val[2] = p.val[Red];
+				v.val[3] = packmode == 5 ? kval : p.val[Alpha];
+				vst4q_u8(d, v);
+			}
+			break;
+		}
+	}
+	return done + packScalar<Red, Green, Blue, Alpha, Round>(src + done * 4, dst + done * bpp, count - done, fb_w_ctrl);
+}
+
+// 8 host pixels from 8-bit red, green and blue
+template<typename Packer>
+static inline void storePixels8(u32 *dst, uint8x8_t r, uint8x8_t g, uint8x8_t b)
+{
+	uint8x8x4_t v;
+	v.val[0] = std::is_same_v<Packer, BGRAPacker> ? b : r;
+	v.val[1] = g;
+	v.val[2] = std::is_same_v<Packer, BGRAPacker> ? r : b;
+	v.val[3] = vdup_n_u8(0xff);
+	vst4_u8((u8 *)dst, v);
+}
+
+// 16 host pixels from 8-bit red, green and blue
+template<typename Packer>
+static inline void storePixels16(u32 *dst, uint8x16_t r, uint8x16_t g, uint8x16_t b)
+{
+	uint8x16x4_t v;
+	v.val[0] = std::is_same_v<Packer, BGRAPacker> ? b : r;
+	v.val[1] = g;
+	v.val[2] = std::is_same_v<Packer, BGRAPacker> ? r : b;
+	v.val[3] = vdupq_n_u8(0xff);
+	vst4q_u8((u8 *)dst, v);
+}
+
+template<typename Packer>
+void unpack(const u8 *src, u32 *dst, u32 count, FB_R_CTRL_type fb_r_ctrl)
+{
+	const uint16x8_t concat = vdupq_n_u16(fb_r_ctrl.fb_concat);
+	const uint16x8_t mask5 = vdupq_n_u16(0x1f);
+	u32 done = 0;
+	switch (fb_r_ctrl.fb_depth)
+	{
+	case fbde_0555:
+		for (; done + 8 <= count; done += 8)
+		{
+			const uint16x8_t v = vld1q_u16((const u16 *)&src[done * 2]);
+			storePixels8<Packer>(&dst[done],
+					vmovn_u16(vorrq_u16(vshlq_n_u16(vandq_u16(vshrq_n_u16(v, 10), mask5), 3), concat)),
+					vmovn_u16(vorrq_u16(vshlq_n_u16(vandq_u16(vshrq_n_u16(v, 5), mask5), 3), concat)),
+					vmovn_u16(vorrq_u16(vshlq_n_u16(vandq_u16(v, mask5), 3), concat)));
+		}
+		unpackScalar<Packer>(src + done * 2, dst + done, count - done, fb_r_ctrl);
+		break;
+	case fbde_565:
+		{
+			const uint16x8_t concat2 = vandq_u16(concat, vdupq_n_u16(3));
+			for (; done + 8 <= count; done += 8)
+			{
+				const uint16x8_t v = vld1q_u16((const u16 *)&src[done * 2]);
+				storePixels8<Packer>(&dst[done],
+						vmovn_u16(vorrq_u16(vshlq_n_u16(vshrq_n_u16(v, 11), 3), concat)),
+						vmovn_u16(vorrq_u16(vshlq_n_u16(vandq_u16(vshrq_n_u16(v, 5), vdupq_n_u16(0x3f)), 2), concat2)),
+						vmovn_u16(vorrq_u16(vshlq_n_u16(vandq_u16(v, mask5), 3), concat)));
+			}
+			unpackScalar<Packer>(src + done * 2, dst + done, count - done, fb_r_ctrl);
+		}
+		break;
+	case fbde_888:
+		for (; done + 16 <= count; done += 16)
+		{
+			const uint8x16x3_t v = vld3q_u8(&src[done * 3]);
+			storePixels16<Packer>(&dst[done], v.val[2], v.val[1], v.val[0]);
+		}
+		unpackScalar<Packer>(src + done * 3, dst + done, count - done, fb_r_ctrl);
+		break;
+	case fbde_C888:
+		for (; done + 16 <= count; done += 16)
+		{
+			const uint8x16x4_t v = vld4q_u8(&src[done * 4]);
+			storePixels16<Packer>(&dst[done], v.val[2], v.val[1], v.val[0]);
+		}
+		unpackScalar<Packer>(src + done * 4, dst + done, count - done, fb_r_ctrl);
+		break;
+	}
+}
+
+#else
+
+template<int Red, int Green, int Blue, int Alpha, bool Round>
+u32 pack(const u8 *src, u8 *dst, u32 count, FB_W_CTRL_type fb_w_ctrl) {
+	return packScalar<Red, Green, Blue, Alpha, Round>(src, dst, count, fb_w_ctrl);
+}
+
+template<typename Packer>
+void unpack(const u8 *src, u32 *dst, u32 count, FB_R_CTRL_type fb_r_ctrl) {
+	unpackScalar<Packer>(src, dst, count, fb_r_ctrl);
+}
+
+#endif
+
+template u32 pack<0, 1, 2, 3, false>(const u8 *src, u8 *dst, u32 count, FB_W_CTRL_type fb_w_ctrl);
+template u32 pack<0, 1, 2, 3, true>(const u8 *src, u8 *dst, u32 count, FB_W_CTRL_type fb_w_ctrl);
+template u32 pack<2, 1, 0, 3, false>(const u8 *src, u8 *dst, u32 count, FB_W_CTRL_type fb_w_ctrl);
+template u32 pack<2, 1, 0, 3, true>(const u8 *src, u8 *dst, u32 count, FB_W_CTRL_type fb_w_ctrl);
+template u32 packScalar<0, 1, 2, 3, false>(const u8 *src, u8 *dst, u32 count, FB_W_CTRL_type fb_w_ctrl);
+template u32 packScalar<0, 1, 2, 3, true>(const u8 *src, u8 *dst, u32 count, FB_W_CTRL_type fb_w_ctrl);
+template u32 packScalar<2, 1, 0, 3, false>(const u8 *src, u8 *dst, u32 count, FB_W_CTRL_type fb_w_ctrl);
+template u32 packScalar<2, 1, 0, 3, true>(const u8 *src, u8 *dst, u32 count, FB_W_CTRL_type fb_w_ctrl);
+template void unpack<RGBAPacker>(const u8 *src, u32 *dst, u32 count, FB_R_CTRL_type fb_r_ctrl);
+template void unpack<BGRAPacker>(const u8 *src, u32 *dst, u32 count, FB_R_CTRL_type fb_r_ctrl);
+template void unpackScalar<RGBAPacker>(const u8 *src, u32 *dst, u32 count, FB_R_CTRL_type fb_r_ctrl);
+template void unpackScalar<BGRAPacker>(const u8 *src, u32 *dst, u32 count, FB_R_CTRL_type fb_r_ctrl);
+
+}
@@ -0,0 +1,45 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "types.h"
+#include "hw/pvr/pvr_regs.h"
+
+//
+// Conversion of lines of pixels between host 32-bit pixels and the framebuffer formats
+//
+namespace fbconv {
+
+// Converts count host pixels to the fb_w_ctrl.fb_packmode format.
+// Red, Green, Blue and Alpha are the byte offsets of each component in a host pixel.
+// Color components are rounded to the nearest value if Round is true, truncated otherwise.
+// Returns the number of pixels converted: 888 packed pixels are only converted by groups of 4.
+template<int Red, int Green, int Blue, int Alpha, bool Round>
+u32 pack(const u8 *src, u8 *dst, u32 count, FB_W_CTRL_type fb_w_ctrl);
+// Reference implementation
+template<int Red, int Green, int Blue, int Alpha, bool Round>
+u32 packScalar(const u8 *src, u8 *dst, u32 count, FB_W_CTRL_type fb_w_ctrl);
+
+// Converts count pixels in fb_r_ctrl.fb_depth format to host pixels
+template<typename Packer>
+void unpack(const u8 *src, u32 *dst, u32 count, FB_R_CTRL_type fb_r_ctrl);
+// Reference implementation
+template<typename Packer>
+void unpackScalar(const u8 *src, u32 *dst, u32 count, FB_R_CTRL_type fb_r_ctrl);
+
+}
@@ -0,0 +1,384 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "game_scanner.h"
+#include "oslib/directory.h"
+#include "nowide/cstdio.hpp"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <deque>
+
+constexpr char const *INDEX_NAME = "flycast-gamelist.idx";
+constexpr u32 INDEX_MAGIC = 0x58494746;	// FGIX
+constexpr u32 INDEX_VERSION = 2;
+
+// Content of the game directories as of the last scan.
+// All the files with a game extension are kept: they are matched against the rom list
+// when the game list is built so that the index stays valid when the list changes.
+class GameIndex
+{
+public:
+	struct File
+	{
+		std::string path;
+		std::string name;
+	};
+	struct Directory
+	{
+		s64 mtime = -1;		// -1 if unknown: the directory is always listed
+		std::vector<std::string> subdirs;
+		std::vector<File> files;
+	};
+
+	bool load(const std::string& path);
+	void save(const std::string& path) const;
+
+	const Directory *find(const std::string& path) const
+	{
+		auto it = directories.find(path);
+		return it == directories.end() ? nullptr : &it->second;
+	}
+
+	std::unordered_map<std::string, Directory> directories;
+};
+
+static void writeString(FILE *f, const std::string& s)
+{
+	u32 size = (u32)s.size();
+	std::fwrite(&size, sizeof(size), 1, f);
+	std::fwrite(s.data(), 1, size, f);
+}
+
+static bool readString(FILE *f, std::string& s)
+{
+	u32 size;
+	if (std::fread(&size, sizeof(size), 1, f) != 1 || size > 4096)
+		return false;
+	s.resize(size);
+	return std::fread(&s[0], 1, size, f) == size;
+}
+
+template<typename T>
+static bool readValue(FILE *f, T& v) {
+	return std::fread(&v, sizeof(T), 1, f) == 1;
+}
+
+bool GameIndex::load(const std::string& path)
+{
+	directories.clear();
+	FILE *f = nowide::fopen(path.c_str(), "rb");
+	if (f == nullptr)
+		return false;
+	u32 header[3];
+	bool valid = std::fread(header, sizeof(header), 1, f) == 1 && header[0] == INDEX_MAGIC && header[1] == INDEX_VERSION;
+	for (u32 i = 0; valid && i < header[2]; i++)
+	{
+		std::string dirPath;
+		Directory dir;
+		u32 count;
+		valid = readString(f, dirPath) && readValue(f, dir.mtime) && readValue(f, count);
+		for (u32 j = 0; valid && j < count; j++)
+		{
+			dir.subdirs.emplace_back();
+			valid = readString(f, dir.subdirs.back());
+		}
+		valid = valid && readValue(f, count);
+		for (u32 j = 0; valid && j < count; j++)
+		{
+			dir.files.emplace_back();
+			File& file = dir.files.back();
+			valid = readString(f, file.path) && readString(f, file.name);
+		}
+		if (valid)
+			directories[dirPath] = std::move(dir);
+	}
+	std::fclose(f);
+	if (!valid)
+	{
+		WARN_LOG(COMMON, "Ignoring invalid game index %s", path.c_str());
+		directories.clear();
+	}
+	return valid;
+}
+
+void GameIndex::save(const std::string& path) const
+{
+	std::string tmpPath = path + ".tmp";
+	FILE *f = nowide::fopen(tmpPath.c_str(), "wb");
+	if (f == nullptr)
+	{
+		WARN_LOG(COMMON, "Can't write game index %s", tmpPath.c_str());
+		return;
+	}
+	const u32 header[] { INDEX_MAGIC, INDEX_VERSION, (u32)directories.size() };
+	std::fwrite(header, sizeof(header), 1, f);
+	for (const auto& pair : directories)
+	{
+		const Directory& dir = pair.second;
+		writeString(f, pair.first);
+		std::fwrite(&dir.mtime, sizeof(dir.mtime), 1, f);
+		u32 count = (u32)dir.subdirs.size();
+		std::fwrite(&count, sizeof(count), 1, f);
+		for (const std::string& subdir : dir.subdirs)
+			writeString(f, subdir);
+		count = (u32)dir.files.size();
+		std::fwrite(&count, sizeof(count), 1, f);
+		for (const File& file : dir.files)
+		{
+			writeString(f, file.path);
+			writeString(f, file.name);
+		}
+	}
+	bool error = std::ferror(f) != 0;
+	std::fclose(f);
+	if (error || std::rename(tmpPath.c_str(), path.c_str()) != 0)
+	{
+		// rename doesn't replace existing files on windows
+		nowide::remove(path.c_str());
+		if (error || std::rename(tmpPath.c_str(), path.c_str()) != 0)
+		{
+			WARN_LOG(COMMON, "Can't write game index %s", path.c_str());
+			nowide::remove(tmpPath.c_str());
+		}
+	}
+}
+
+static bool getDirectoryTime(const std::string& path, s64& mtime)
+{
+	struct stat st;
+	if (flycast::stat(path.c_str(), &st) != 0)
+		return false;
+	mtime = (s64)st.st_mtime;
+	return true;
+}
+
+static bool isGameExtension(const std::string& extension)
+{
+	return extension == "zip" || extension == "7z"
+			|| extension == "bin" || extension == "lst" || extension == "dat"
+			|| extension == "chd" || extension == "gdi"
+			|| extension == "cdi" || extension == "cue";
+}
+
+void GameScanner::addGame(const std::string& path, const std::string& name, std::vector<GameMedia>& games, std::vector<GameMedia>& arcadeGames)
+{
+	std::string extension = get_file_extension(name);
+	if (extension == "zip" || extension == "7z")
+	{
+		std::string gameName = get_file_basename(name);
+		string_tolower(gameName);
+		auto it = arcade_games.find(gameName);
+		if (it == arcade_games.end())
+			return;
+		arcadeGames.push_back(GameMedia{ name + " (" + it->second->description + ")", path, name, it->second->description });
+	}
+	else if (extension == "bin" || extension == "lst" || extension == "dat")
+	{
+		if (!config::HideLegacyNaomiRoms)
+			arcadeGames.push_back(GameMedia{ name, path, name, get_file_basename(name) });
+	}
+	else
+	{
+		if (extension == "chd" || extension == "gdi")
+		{
+			// Hide arcade gdroms
+			std::string basename = get_file_basename(name);
+			string_tolower(basename);
+			if (arcade_gdroms.count(basename) != 0)
+				return;
+		}
+		games.push_back(GameMedia{ name, path, name, get_file_basename(name) });
+	}
+}
+
+static void sortGames(std::vector<GameMedia>& games, std::vector<GameMedia>& arcadeGames)
+{
+	auto less = [](const GameMedia& left, const GameMedia& right) {
+		return left.name < right.name || (left.name == right.name && left.path < right.path);
+	};
+	std::sort(games.begin(), games.end(), less);
+	std::sort(arcadeGames.begin(), arcadeGames.end(), less);
+	games.insert(games.end(), std::make_move_iterator(arcadeGames.begin()), std::make_move_iterator(arcadeGames.end()));
+	arcadeGames.clear();
+}
+
+void GameScanner::scanDirectory(const std::string& path, const GameIndex& oldIndex, GameIndex& index)
+{
+	GameIndex::Directory dir;
+	if (!getDirectoryTime(path, dir.mtime))
+		dir.mtime = -1;
+	const GameIndex::Directory *cached = oldIndex.find(path);
+	if (cached != nullptr && dir.mtime != -1 && cached->mtime == dir.mtime)
+	{
+		index.directories[path] = *cached;
+		return;
+	}
+	for (const hostfs::FileInfo& item : hostfs::storage().listContent(path))
+	{
+		if (!running)
+			return;
+		if (item.isDirectory)
+		{
+			dir.subdirs.push_back(item.path);
+			continue;
+		}
+		if (item.name.substr(0, 2) == "._")
+			// Ignore Mac OS turds
+			continue;
+		if (isGameExtension(get_file_extension(item.name)))
+			dir.files.push_back(GameIndex::File{ item.path, item.name });
+	}
+	// The modification time has a one-second resolution on most file systems.
+	// Entries added during the current second may not be listed yet.
+	if (dir.mtime >= (s64)time(nullptr) - 1)
+		dir.mtime = -1;
+	index.directories[path] = std::move(dir);
+}
+
+void GameScanner::scan()
+{
+	if (arcade_games.empty())
+		for (int gameid = 0; Games[gameid].name != nullptr; gameid++)
+		{
+			const Game *game = &Games[gameid];
+			arcade_games[game->name] = game;
+			if (game->gdrom_name != nullptr)
+				arcade_gdroms.insert(game->gdrom_name);
+		}
+	const auto startTime = std::chrono::steady_clock::now();
+	if (indexPath.empty())
+		indexPath = get_writable_data_path(INDEX_NAME);
+	GameIndex oldIndex;
+	oldIndex.load(indexPath);
+	const std::vector<std::string> roots = config::ContentPath.get();
+
+	// Show the games found by the previous scan until this one is complete
+	std::vector<GameMedia> games;
+	std::vector<GameMedia> arcadeGames;
+	{
+		std::unordered_set<std::string> visited;
+		std::vector<std::string> stack(roots.begin(), roots.end());
+		while (!stack.empty())
+		{
+			std::string path = std::move(stack.back());
+			stack.pop_back();
+			const GameIndex::Directory *dir = oldIndex.find(path);
+			if (dir == nullptr || !visited.insert(path).second)
+				continue;
+			for (const GameIndex::File& file : dir->files)
+				addGame(file.path, file.name, games, arcadeGames);
+			stack.insert(stack.end(), dir->subdirs.begin(), dir->subdirs.end());
+		}
+	}
+	const bool showPrevious = !games.empty() || !arcadeGames.empty();
+	sortGames(games, arcadeGames);
+	{
+		std::lock_guard<std::mutex> guard(mutex);
+		game_list = std::move(games);
+	}
+	games.clear();
+
+	GameIndex index;
+	std::mutex queueMutex;
+	std::condition_variable queueCond;
+	std::deque<std::string> queue(roots.begin(), roots.end());
+	int busy = 0;
+	u32 listed = 0;
+
+	auto worker = [&]() {
+		std::unique_lock<std::mutex> lock(queueMutex);
+		while (true)
+		{
+			queueCond.wait(lock, [&]() { return !queue.empty() || busy == 0 || !running; });
+			if (queue.empty() || !running)
+				break;
+			std::string path = std::move(queue.front());
+			queue.pop_front();
+			if (index.find(path) != nullptr)
+				// already scanned (symlink loop or duplicate content path)
+				continue;
+			index.directories[path];
+			busy++;
+			lock.unlock();
+
+			GameIndex dirIndex;
+			try {
+				scanDirectory(path, oldIndex, dirIndex);
+			} catch (const hostfs::StorageException& e) {
+				// ignore
+			}
+
+			lock.lock();
+			busy--;
+			auto it = dirIndex.directories.begin();
+			if (it != dirIndex.directories.end())
+			{
+				GameIndex::Directory& dir = it->second;
+				if (oldIndex.find(path) == nullptr || oldIndex.find(path)->mtime != dir.mtime || dir.mtime == -1)
+					listed++;
+				queue.insert(queue.end(), dir.subdirs.begin(), dir.subdirs.end());
+				size_t first = games.size();
+				size_t arcadeCount = arcadeGames.size();
+				for (const GameIndex::File& file : dir.files)
+					addGame(file.path, file.name, games, arcadeGames);
+				if (first == games.size() && arcadeCount == arcadeGames.size())
+				{
+					if (games.empty() && arcadeGames.empty() && ++empty_folders_scanned > 1000)
+						content_path_looks_incorrect = true;
+				}
+				else
+				{
+					content_path_looks_incorrect = false;
+					if (!showPrevious)
+					{
+						// Show the games as they are found
+						std::lock_guard<std::mutex> guard(mutex);
+						game_list.insert(game_list.end(), games.begin() + first, games.end());
+					}
+				}
+				index.directories[path] = std::move(dir);
+			}
+			queueCond.notify_all();
+		}
+		queueCond.notify_all();
+	};
+	const int threadCount = std::max(2, std::min(8, (int)std::thread::hardware_concurrency()));
+	std::vector<std::thread> workers;
+	for (int i = 0; i < threadCount - 1; i++)
+		workers.emplace_back(worker);
+	worker();
+	for (auto& thread : workers)
+		thread.join();
+
+	if (!running)
+		return;
+	const size_t gameCount = games.size() + arcadeGames.size();
+	sortGames(games, arcadeGames);
+	{
+		std::lock_guard<std::mutex> guard(mutex);
+		game_list = std::move(games);
+	}
+	if (listed != 0 || index.directories.size() != oldIndex.directories.size())
+		index.save(indexPath);
+	scan_done = true;
+
+	INFO_LOG(COMMON, "Game scan: %d games, %d directories (%d listed) in %.1f ms", (int)gameCount, (int)index.directories.size(), listed,
+			std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count());
+}
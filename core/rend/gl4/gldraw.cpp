@@ -36,7 +36,7 @@ GLuint depthSaveTexId;
 static gl4PipelineShader *gl4GetProgram(bool cp_AlphaTest, bool pp_InsideClipping,
 							bool pp_Texture, bool pp_UseAlpha, bool pp_IgnoreTexA, u32 pp_ShadInstr, bool pp_Offset,
 							u32 pp_FogCtrl, bool pp_TwoVolumes, bool pp_Gouraud, bool pp_BumpMap, bool fog_clamping,
-							bool palette, bool naomi2, Pass pass)
+							int palette, bool naomi2, Pass pass)
 {
 	u32 rv=0;
 
@@ -52,7 +52,7 @@ static gl4PipelineShader *gl4GetProgram(bool cp_AlphaTest, bool pp_InsideClippin
 	rv <<= 1; rv |= (int)pp_Gouraud;
 	rv <<= 1; rv |= (int)pp_BumpMap;
 	rv <<= 1; rv |= (int)fog_clamping;
-	rv <<= 1; rv |= (int)palette;
+	rv <<= 2; rv |= palette;
 	rv <<= 1; rv |= (int)naomi2;
 	rv <<= 2; rv |= (int)pass;
 	rv <<= 1; rv |= (int)(!settings.platform.isNaomi2() && config::NativeDepthInterpolation);
@@ -118,10 +118,12 @@ static void SetGPState(const PolyParam* gp)
 	int clip_rect[4] = {};
 	TileClipping clipmode = GetTileClip(gp->tileclip, ViewportMatrix, clip_rect);
 	bool gpuPalette;
+	int palette;
 
 	if (pass == Pass::Depth)
 	{
 		gpuPalette = gp->texture != nullptr && Type == ListType_Punch_Through ? gp->texture->gpuPalette : false;
+		palette = gpuPalette ? (TextureCacheData::IsFilteredGpuPalette(gp->tsp) ? 2 : 1) : 0;
 		CurrentShader = gl4GetProgram(Type == ListType_Punch_Through ? true : false,
 				clipmode == TileClipping::Inside,
 				Type == ListType_Punch_Through ? gp->pcw.Texture : false,
@@ -134,7 +136,7 @@ static void SetGPState(const PolyParam* gp)
 				false,
 				false,
 				false,
-				gpuPalette,
+				palette,
 				gp->isNaomi2(),
 				pass);
 	}
@@ -146,6 +148,7 @@ static void SetGPState(const PolyParam* gp)
 
 		int fog_ctrl = config::Fog ? gp->tsp.FogCtrl : 2;
 		gpuPalette = gp->texture != nullptr ? gp->texture->gpuPalette : false;
+		palette = gpuPalette ? (TextureCacheData::IsFilteredGpuPalette(gp->tsp) ? 2 : 1) : 0;
 
 		CurrentShader = gl4GetProgram(Type == ListType_Punch_Through ? true : false,
 				clipmode == TileClipping::Inside,
@@ -159,7 +162,7 @@ static void SetGPState(const PolyParam* gp)
 				gp->pcw.Gouraud,
 				gp->tcw.PixelFmt == PixelBumpMap,
 				color_clamp,
-				gpuPalette,
+				palette,
 				gp->isNaomi2(),
 				pass);
 	}
@@ -225,11 +228,12 @@ static void SetGPState(const PolyParam* gp)
 
 				bool nearest_filter;
 				if (config::TextureFiltering == 0) {
-					nearest_filter = tsp.FilterMode == 0;
+					nearest_filter = tsp.FilterMode == 0 || texture->gpuPalette;
 				} else if (config::TextureFiltering == 1) {
 					nearest_filter = true;
 				} else {
-					nearest_filter = false;
+					// Paletted textures are filtered by the shader
+					nearest_filter = texture->gpuPalette;
 				}
 
 				bool mipmapped = gp->tcw.MipMapped != 0 && gp->tcw.ScanOrder == 0 && config::UseMipmaps;
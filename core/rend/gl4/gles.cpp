@@ -164,7 +164,7 @@ uniform sampler2D DepthTex;
 uniform float trilinear_alpha;
 uniform vec4 fog_clamp_min;
 uniform vec4 fog_clamp_max;
-#if pp_Palette == 1
+#if pp_Palette != 0
 uniform sampler2D palette;
 uniform int palette_index;
 #endif
@@ -213,20 +213,49 @@ vec4 fog_clamp(vec4 col)
 #endif
 }
 
+#if pp_Palette != 0
+
+vec4 paletteEntry(float colIdx)
+{
+	int color_idx = int(floor(colIdx * 255.0 + 0.5)) + palette_index;
+	ivec2 c = ivec2(color_idx % 32, color_idx / 32);
+	return texelFetch(palette, c, 0);
+}
+
 #if pp_Palette == 1
 
 vec4 palettePixel(sampler2D tex, vec3 coords)
 {
 #if DIV_POS_Z == 1
-	float colIdx = texture(tex, coords.xy).r;
+	return paletteEntry(texture(tex, coords.xy).r);
 #else
-	float colIdx = textureProj(tex, coords).r;
+	return paletteEntry(textureProj(tex, coords).r);
 #endif
-	int color_idx = int(floor(colIdx * 255.0 + 0.5)) + palette_index;
-	ivec2 c = ivec2(color_idx % 32, color_idx / 32);
-	return texelFetch(palette, c, 0);
 }
 
+#else
+
+// Bilinear filtering of the palette colors. The index texture uses nearest filtering.
+vec4 palettePixel(sampler2D tex, vec3 coords)
+{
+#if DIV_POS_Z == 1
+	vec2 uv = coords.xy;
+#else
+	vec2 uv = coords.xy / coords.z;
+#endif
+	vec2 texSize = vec2(textureSize(tex, 0));
+	vec2 pos = uv * texSize - 0.5;
+	vec2 f = fract(pos);
+	vec2 texel = 1.0 / texSize;
+	uv = (floor(pos) + 0.5) * texel;
+	vec4 c00 = paletteEntry(texture(tex, uv).r);
+	vec4 c10 = paletteEntry(texture(tex, uv + vec2(texel.x, 0.0)).r);
+	vec4 c01 = paletteEntry(texture(tex, uv + vec2(0.0, texel.y)).r);
+	vec4 c11 = paletteEntry(texture(tex, uv + texel).r);
+	return mix(mix(c00, c10, f.x), mix(c01, c11, f.x), f.y);
+}
+
+#endif
 #endif
 
 void main()
@@ -741,6 +770,7 @@ bool OpenGL4Renderer::Init()
 	fog_needs_update = true;
 	forcePaletteUpdate();
 	TextureCacheData::SetDirectXColorOrder(false);
+	TextureCacheData::SetGpuPaletteFiltering(true);
 
 	return true;
 }
@@ -122,6 +122,9 @@ void SetGPState(const PolyParam* gp,u32 cflip=0)
 	TileClipping clipmode = GetTileClip(gp->tileclip, ViewportMatrix, clip_rect);
 	TextureCacheData *texture = (TextureCacheData *)gp->texture;
 	bool gpuPalette = texture != nullptr ? texture->gpuPalette : false;
+	int palette = 0;
+	if (gpuPalette)
+		palette = TextureCacheData::IsFilteredGpuPalette(gp->tsp) ? 2 : 1;
 
 	CurrentShader = GetProgram(Type == ListType_Punch_Through ? true : false,
 								  clipmode == TileClipping::Inside,
@@ -135,7 +138,7 @@ void SetGPState(const PolyParam* gp,u32 cflip=0)
 								  gp->tcw.PixelFmt == PixelBumpMap,
 								  color_clamp,
 								  ShaderUniforms.trilinear_alpha != 1.f,
-								  gpuPalette,
+								  palette,
 								  gp->isNaomi2(),
 								  ShaderUniforms.dithering);
 	
@@ -183,7 +186,8 @@ void SetGPState(const PolyParam* gp,u32 cflip=0)
 		} else if (config::TextureFiltering == 1) {
 			nearest_filter = true;
 		} else {
-			nearest_filter = false;
+			// Paletted textures are filtered by the shader
+			nearest_filter = gpuPalette;
 		}
 
 		bool mipmapped = texture->IsMipmapped();
@@ -726,17 +730,29 @@ void writeFramebufferToVRAM()
 	glPixelStorei(GL_PACK_ALIGNMENT, 1);
 	u32 linestride = pvrrc.fb_W_LINESTRIDE * 8;
 
-	PixelBuffer<u32> tmp_buf;
-	tmp_buf.init(width, height);
-
-	u8 *p = (u8 *)tmp_buf.data();
-	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, p);
-
 	xClip.min = std::min(xClip.min, width - 1);
 	xClip.max = std::min(xClip.max, width - 1);
 	yClip.min = std::min(yClip.min, height - 1);
 	yClip.max = std::min(yClip.max, height - 1);
-	WriteFramebuffer(width, height, p, tex_addr, pvrrc.fb_W_CTRL, linestride, xClip, yClip);
+#ifndef GLES2
+	if (gl.readback.isEnabled())
+	{
+		const FB_W_CTRL_type fb_W_CTRL = pvrrc.fb_W_CTRL;
+		const ReadbackArea area = lockFramebufferArea(width, height, tex_addr, fb_W_CTRL, linestride);
+		gl.readback.read(width, height, area, [=](const u8 *pixels) {
+			WriteFramebuffer(width, height, pixels, tex_addr, fb_W_CTRL, linestride, xClip, yClip);
+		});
+	}
+	else
+#endif
+	{
+		PixelBuffer<u32> tmp_buf;
+		tmp_buf.init(width, height);
+
+		u8 *p = (u8 *)tmp_buf.data();
+		glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, p);
+		WriteFramebuffer(width, height, p, tex_addr, pvrrc.fb_W_CTRL, linestride, xClip, yClip);
+	}
 
 	glBindFramebuffer(GL_FRAMEBUFFER, gl.ofbo.origFbo);
 	glCheck();
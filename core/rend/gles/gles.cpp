@@ -140,7 +140,7 @@ uniform sampler2D tex,fog_table;
 uniform lowp float trilinear_alpha;
 uniform lowp vec4 fog_clamp_min;
 uniform lowp vec4 fog_clamp_max;
-#if pp_Palette == 1
+#if pp_Palette != 0
 uniform sampler2D palette;
 uniform mediump int palette_index;
 #endif
@@ -180,25 +180,54 @@ highp vec4 fog_clamp(lowp vec4 col)
 #endif
 }
 
-#if pp_Palette == 1
+#if pp_Palette != 0
 
-lowp vec4 palettePixel(highp vec3 coords)
+lowp vec4 paletteEntry(highp float colIdx)
 {
+	highp int color_idx = int(floor(colIdx * 255.0 + 0.5)) + palette_index;
 #if TARGET_GL == GLES2 || TARGET_GL == GL2
-	highp int color_idx = int(floor(texture(tex, coords.xy).FOG_CHANNEL * 255.0 + 0.5)) + palette_index;
     highp vec2 c = vec2((mod(float(color_idx), 32.0) * 2.0 + 1.0) / 64.0, (float(color_idx / 32) * 2.0 + 1.0) / 64.0);
 	return texture(palette, c);
 #else
-	#if DIV_POS_Z == 1
-		highp int color_idx = int(floor(texture(tex, coords.xy).FOG_CHANNEL * 255.0 + 0.5)) + palette_index;
-	#else
-		highp int color_idx = int(floor(textureProj(tex, coords).FOG_CHANNEL * 255.0 + 0.5)) + palette_index;
-	#endif
     highp ivec2 c = ivec2(color_idx % 32, color_idx / 32);
 	return texelFetch(palette, c, 0);
 #endif
 }
 
+#if pp_Palette == 1
+
+lowp vec4 palettePixel(highp vec3 coords)
+{
+#if TARGET_GL == GLES2 || TARGET_GL == GL2 || DIV_POS_Z == 1
+	return paletteEntry(texture(tex, coords.xy).FOG_CHANNEL);
+#else
+	return paletteEntry(textureProj(tex, coords).FOG_CHANNEL);
+#endif
+}
+
+#else
+
+// Bilinear filtering of the palette colors. The index texture uses nearest filtering.
+lowp vec4 palettePixel(highp vec3 coords)
+{
+#if DIV_POS_Z == 1
+	highp vec2 uv = coords.xy;
+#else
+	highp vec2 uv = coords.xy / coords.z;
+#endif
+	highp vec2 texSize = vec2(textureSize(tex, 0));
+	highp vec2 pos = uv * texSize - 0.5;
+	highp vec2 f = fract(pos);
+	highp vec2 texel = 1.0 / texSize;
+	uv = (floor(pos) + 0.5) * texel;
+	lowp vec4 c00 = paletteEntry(texture(tex, uv).FOG_CHANNEL);
+	lowp vec4 c10 = paletteEntry(texture(tex, uv + vec2(texel.x, 0.0)).FOG_CHANNEL);
+	lowp vec4 c01 = paletteEntry(texture(tex, uv + vec2(0.0, texel.y)).FOG_CHANNEL);
+	lowp vec4 c11 = paletteEntry(texture(tex, uv + texel).FOG_CHANNEL);
+	return mix(mix(c00, c10, f.x), mix(c01, c11, f.x), f.y);
+}
+
+#endif
 #endif
 
 #if TARGET_GL == GLES2
@@ -452,6 +481,9 @@ void termGLCommon()
 	paletteTextureId = 0;
 	// RTT
 	gl.rtt.framebuffer.reset();
+#ifndef GLES2
+	gl.readback.term();
+#endif
 
 	gl_free_osd_resources();
 	gl.ofbo.framebuffer.reset();
@@ -671,7 +703,7 @@ GLuint gl_CompileAndLink(const char *vertexShader, const char *fragmentShader)
 PipelineShader *GetProgram(bool cp_AlphaTest, bool pp_InsideClipping,
 		bool pp_Texture, bool pp_UseAlpha, bool pp_IgnoreTexA, u32 pp_ShadInstr, bool pp_Offset,
 		u32 pp_FogCtrl, bool pp_Gouraud, bool pp_BumpMap, bool fog_clamping, bool trilinear,
-		bool palette, bool naomi2, bool dithering)
+		int palette, bool naomi2, bool dithering)
 {
 	u32 rv=0;
 
@@ -687,7 +719,7 @@ PipelineShader *GetProgram(bool cp_AlphaTest, bool pp_InsideClipping,
 	rv <<= 1; rv |= pp_BumpMap;
 	rv <<= 1; rv |= fog_clamping;
 	rv <<= 1; rv |= trilinear;
-	rv <<= 1; rv |= palette;
+	rv <<= 2; rv |= palette;
 	rv <<= 1; rv |= naomi2;
 	rv <<= 1, rv |= !settings.platform.isNaomi2() && config::NativeDepthInterpolation;
 	rv <<= 1; rv |= dithering;
@@ -1004,6 +1036,7 @@ bool OpenGLRenderer::Init()
 	fog_needs_update = true;
 	forcePaletteUpdate();
 	TextureCacheData::SetDirectXColorOrder(false);
+	TextureCacheData::SetGpuPaletteFiltering(gl.gl_major >= 3);
 
 	return true;
 }
@@ -1135,6 +1168,10 @@ void OpenGLRenderer::Process(TA_context* ctx)
 	if (gl.gl_major < 3 && settings.platform.isNaomi2())
 		throw FlycastException("OpenGL ES 3.0+ required for Naomi 2");
 
+#ifndef GLES2
+	// Write the due readbacks before their textures are used
+	gl.readback.newFrame();
+#endif
 	if (KillTex)
 		TexCache.Clear();
 	TexCache.Cleanup();
@@ -11,6 +11,8 @@
 #endif
 
 #include <unordered_map>
+#include <deque>
+#include <functional>
 #include <glm/glm.hpp>
 
 #ifndef GL_TEXTURE_MAX_ANISOTROPY
@@ -108,7 +110,7 @@ struct PipelineShader
 	bool pp_BumpMap;
 	bool fog_clamping;
 	bool trilinear;
-	bool palette;
+	int palette;		// 0: none, 1: nearest, 2: bilinear
 	bool naomi2;
 	bool divPosZ;
 	bool dithering;
@@ -222,6 +224,50 @@ protected:
 	void defineVtxAttribs() override;
 };
 
+#ifndef GLES2
+//
+// Asynchronous framebuffer readbacks through pixel buffer objects (GL 3+ / GLES 3+).
+// The pixels are written to vram when the frame rendered config::ReadbackLatency frames later is processed,
+// unless the destination area has been written in the meantime.
+//
+class ReadbackQueue
+{
+public:
+	using WriteFunc = std::function<void(const u8 *pixels)>;
+
+	bool isEnabled() const;
+	// Reads the bound framebuffer in RGBA8 format. write is called once the pixels are available.
+	// area is the vram area written by write, which is unlocked when the readback completes.
+	void read(u32 width, u32 height, const ReadbackArea& area, WriteFunc write);
+	// Writes the readbacks that are due to vram
+	void newFrame();
+	// Waits for and writes all pending readbacks
+	void flush();
+	void term();
+
+private:
+	void complete(size_t count);
+
+	struct Buffer
+	{
+		GLuint name;
+		u32 size;
+	};
+	struct Readback
+	{
+		Buffer buffer;
+		u32 size;
+		GLsync fence;
+		u64 frame;
+		ReadbackArea area;
+		WriteFunc write;
+	};
+	std::deque<Readback> pending;
+	std::vector<Buffer> freeBuffers;
+	u64 frame = 0;
+};
+#endif
+
 struct gl_ctx
 {
 	struct
@@ -270,6 +316,10 @@ struct gl_ctx
 		std::unique_ptr<GlFramebuffer> framebuffer;
 	} rtt;
 
+#ifndef GLES2
+	ReadbackQueue readback;
+#endif
+
 	struct
 	{
 		std::unique_ptr<GlFramebuffer> framebuffer;
@@ -390,7 +440,7 @@ void writeFramebufferToVRAM();
 PipelineShader *GetProgram(bool cp_AlphaTest, bool pp_InsideClipping,
 		bool pp_Texture, bool pp_UseAlpha, bool pp_IgnoreTexA, u32 pp_ShadInstr, bool pp_Offset,
 		u32 pp_FogCtrl, bool pp_Gouraud, bool pp_BumpMap, bool fog_clamping, bool trilinear,
-		bool palette, bool naomi2, bool dithering);
+		int palette, bool naomi2, bool dithering);
 
 GLuint gl_CompileShader(const char* shader, GLuint type);
 GLuint gl_CompileAndLink(const char *vertexShader, const char *fragmentShader);
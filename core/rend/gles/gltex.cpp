@@ -213,6 +213,16 @@ void ReadRTTBuffer()
 		{
 			glReadPixels(0, 0, w, h, GL_RGB, GL_UNSIGNED_SHORT_5_6_5, dst);
 		}
+#ifndef GLES2
+		else if (gl.readback.isEnabled())
+		{
+			const FB_W_CTRL_type fb_W_CTRL = pvrrc.fb_W_CTRL;
+			const ReadbackArea area = lockReadbackArea(tex_addr, std::max(linestride, w * 2) * h);
+			gl.readback.read(w, h, area, [w, h, dst, fb_W_CTRL, linestride](const u8 *pixels) {
+				WriteTextureToVRam(w, h, pixels, dst, fb_W_CTRL, linestride);
+			});
+		}
+#endif
 		else
 		{
 			PixelBuffer<u32> tmp_buf;
@@ -240,16 +250,119 @@ void ReadRTTBuffer()
 	glBindFramebuffer(GL_FRAMEBUFFER, gl.ofbo.origFbo);
 }
 
+#ifndef GLES2
+bool ReadbackQueue::isEnabled() const
+{
+	return config::ReadbackLatency > 0 && gl.gl_major >= 3;
+}
+
+void ReadbackQueue::read(u32 width, u32 height, const ReadbackArea& area, WriteFunc write)
+{
+	Readback readback;
+	readback.size = width * height * 4;
+	if (freeBuffers.empty())
+	{
+		readback.buffer = {};
+		glGenBuffers(1, &readback.buffer.name);
+	}
+	else
+	{
+		readback.buffer = freeBuffers.back();
+		freeBuffers.pop_back();
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer.name);
+	if (readback.buffer.size < readback.size)
+	{
+		glBufferData(GL_PIXEL_PACK_BUFFER, readback.size, nullptr, GL_STREAM_READ);
+		readback.buffer.size = readback.size;
+	}
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	readback.fence = (GLsync)glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	readback.frame = frame;
+	readback.area = area;
+	readback.write = std::move(write);
+	pending.push_back(std::move(readback));
+	glCheck();
+}
+
+void ReadbackQueue::newFrame()
+{
+	frame++;
+	// Everything is due if the latency has been reset to 0
+	const u64 latency = std::max(1, (int)config::ReadbackLatency);
+	size_t count = 0;
+	while (count < pending.size() && pending[count].frame + latency <= frame)
+		count++;
+	complete(count);
+}
+
+void ReadbackQueue::flush()
+{
+	complete(pending.size());
+}
+
+void ReadbackQueue::complete(size_t count)
+{
+	for (; count > 0; count--)
+	{
+		Readback& readback = pending.front();
+		GLenum status;
+		do {
+			status = glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+		} while (status == GL_TIMEOUT_EXPIRED);
+		glDeleteSync(readback.fence);
+
+		bool written = writeReadbackArea(readback.area, [&readback]() {
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, readback.buffer.name);
+			const u8 *pixels = (const u8 *)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, readback.size, GL_MAP_READ_BIT);
+			if (pixels != nullptr)
+			{
+				readback.write(pixels);
+				glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+			}
+			else
+			{
+				WARN_LOG(RENDERER, "Readback buffer mapping failed");
+			}
+			glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+		});
+		if (!written)
+			DEBUG_LOG(RENDERER, "Readback dropped: vram written since the frame was rendered");
+		freeBuffers.push_back(readback.buffer);
+		pending.pop_front();
+	}
+	glCheck();
+}
+
+void ReadbackQueue::term()
+{
+	for (Readback& readback : pending)
+	{
+		glDeleteSync(readback.fence);
+		unlockReadbackArea(readback.area);
+		freeBuffers.push_back(readback.buffer);
+	}
+	pending.clear();
+	for (const Buffer& buffer : freeBuffers)
+		glDeleteBuffers(1, &buffer.name);
+	freeBuffers.clear();
+}
+#endif
+
 BaseTextureCacheData *OpenGLRenderer::GetTexture(TSP tsp, TCW tcw)
 {
+	TextureCacheData* tf = TexCache.getMemoizedTexture(tsp, tcw);
+	if (tf != nullptr)
+		return tf;
 	//lookup texture
-	TextureCacheData* tf = TexCache.getTextureCacheData(tsp, tcw);
+	tf = TexCache.getTextureCacheData(tsp, tcw);
 
 	//update if needed
 	if (tf->NeedsUpdate())
 	{
 		if (!tf->Update())
-			tf = nullptr;
+			return nullptr;
 	}
 	else if (tf->IsCustomTextureAvailable())
 	{
@@ -257,6 +370,7 @@ BaseTextureCacheData *OpenGLRenderer::GetTexture(TSP tsp, TCW tcw)
 		tf->texID = glcache.GenTexture();
 		tf->CheckCustomTexture();
 	}
+	TexCache.memoizeTexture(tsp, tcw, tf);
 
 	return tf;
 }
@@ -36,13 +36,19 @@
 #include "log/LogManager.h"
 #include "emulator.h"
 #include "rend/mainui.h"
+#include "rend/TexCache.h"
+#include "rend/CustomTexture.h"
 #include "lua/lua.h"
 #include "gui_chat.h"
 #include "imgui_driver.h"
 #include "implot/implot.h"
 #include "boxart/boxart.h"
 #include "profiler/fc_profiler.h"
+#include "profiler/guest_profiler.h"
 #include "hw/naomi/card_reader.h"
+#include "hw/pvr/Renderer_if.h"
+#include "hw/pvr/ta.h"
+#include "hw/mem/addrspace.h"
 #if defined(USE_SDL)
 #include "sdl/sdl.h"
 #endif
@@ -1294,7 +1300,7 @@ static void contentpath_warning_popup()
         if (ImGui::BeginPopupModal("Incorrect Content Location?", NULL, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoMove))
         {
             ImGui::PushTextWrapPos(ImGui::GetCursorPos().x + 400.f * settings.display.uiScale);
-            ImGui::TextWrapped("  Scanned %d folders but no game can be found!  ", scanner.empty_folders_scanned);
+            ImGui::TextWrapped("  Scanned %d folders but no game can be found!  ", scanner.empty_folders_scanned.load());
             ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ScaledVec2(16, 3));
             float currentwidth = ImGui::GetContentRegionAvail().x;
             ImGui::SetCursorPosX((currentwidth - 100.f * settings.display.uiScale) / 2.f + ImGui::GetStyle().WindowPadding.x - 55.f * settings.display.uiScale);
@@ -1393,6 +1399,22 @@ static inline void gui_debug_tab()
 		        ImGui::PopStyleVar();
 			}
 	    }
+    	ImGui::Spacing();
+	    header("Tracing");
+	    {
+			if (fc_profiler::trace::isActive())
+			{
+				if (ImGui::Button("Stop Trace"))
+					fc_profiler::trace::stop();
+			}
+			else if (ImGui::Button("Start Trace"))
+			{
+				fc_profiler::trace::start(get_writable_data_path("flycast-trace.json"));
+			}
+			ImGui::SameLine();
+			ShowHelpMarker("Record the profiled scopes of all threads to flycast-trace.json in the data folder. "
+					"The file can be opened with chrome://tracing or ui.perfetto.dev");
+	    }
 #endif
 		ImGui::PopStyleVar();
 		ImGui::EndTabItem();
@@ -1974,6 +1996,10 @@ static void gui_display_settings()
 			    	ImGui::Unindent();
 		    	}
 #endif
+		    	if (isVulkan(config::RendererType))
+		    		OptionCheckbox("Asynchronous Pipeline Compilation", config::AsyncPipelines,
+		    				"Compile new rendering pipelines in the background to avoid stuttering. "
+		    				"Some polygons are drawn with simplified shading until their pipeline is ready.");
 		    	OptionCheckbox("Show FPS Counter", config::ShowFPS, "Show on-screen frame/sec counter");
 		    	OptionCheckbox("Show VMU In-game", config::FloatVMUs, "Show the VMU LCD screens while in-game");
 		    	OptionCheckbox("Rotate Screen 90°", config::Rotate90, "Rotate the screen 90° counterclockwise");
@@ -2139,6 +2165,12 @@ static void gui_display_settings()
 		    {
 		    	OptionCheckbox("Copy to VRAM", config::RenderToTextureBuffer,
 		    			"Copy rendered-to textures back to VRAM. Slower but accurate");
+		    	{
+		    		DisabledScope scope(renderApi != 0);
+		    		OptionSlider("Readback Latency", config::ReadbackLatency, 0, 2,
+		    				"Number of frames the copy of rendered-to textures and of the emulated framebuffer to VRAM is delayed. "
+		    				"Avoids GPU stalls but some games may read stale data. OpenGL only");
+		    	}
 		    }
 	    	ImGui::Spacing();
 		    header("Texture Upscaling");
@@ -2153,6 +2185,40 @@ static void gui_display_settings()
 #endif
 		    	OptionCheckbox("Load Custom Textures", config::CustomTextures,
 		    			"Load custom/high-res textures from data/textures/<game id>");
+		    	{
+		    		static std::string packStatus;
+		    		static std::future<int> packBuild;
+		    		static std::atomic<float> packProgress;
+		    		if (packBuild.valid() && packBuild.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready)
+		    		{
+		    			int count = packBuild.get();
+		    			packStatus = count < 0 ? "Failed" : std::to_string(count) + " textures";
+		    		}
+		    		{
+		    			DisabledScope scope(!game_started || packBuild.valid());
+		    			if (ImGui::Button("Build Texture Pack"))
+		    			{
+		    				packStatus.clear();
+		    				packProgress = 0.f;
+		    				// png decoding is slow
+		    				packBuild = std::async(std::launch::async, []() {
+		    					return CustomTexture::BuildGamePack(&packProgress);
+		    				});
+		    			}
+		    		}
+		    		ImGui::SameLine();
+		    		ShowHelpMarker("Pack the custom textures of the current game into a single file that loads faster. "
+		    				"It's used the next time the game is started");
+		    		if (packBuild.valid())
+		    			ImGui::ProgressBar(packProgress, ImVec2(-1, 0));
+		    		else if (!packStatus.empty())
+		    		{
+		    			ImGui::SameLine();
+		    			ImGui::TextUnformatted(packStatus.c_str());
+		    		}
+		    	}
+		    	OptionSlider("Texture Cache Size", config::TextureCacheBudget, 0, 4096,
+		    			"Unused textures are deleted when the texture cache exceeds this size. 0 for no limit", "%d MB");
 		    }
 #ifdef VIDEO_ROUTING
 #ifdef __APPLE__
@@ -2231,6 +2297,11 @@ static void gui_display_settings()
 				ImGui::SameLine();
 				ShowHelpMarker("Sets the maximum audio latency. Not supported by all audio drivers.");
             }
+			OptionCheckbox("Dynamic Rate Control", config::AudioDynamicRate,
+					"Slightly resample the audio to prevent crackling when the emulation and audio device clocks drift apart");
+			if (config::AudioDynamicRate)
+				OptionSlider("Target Latency", config::AudioTargetLatency, 20, 200,
+						"Amount of audio buffered before the audio driver when using dynamic rate control", "%d ms");
 
 			AudioBackend *backend = nullptr;
 			std::string backend_name = config::AudioBackend;
@@ -2333,6 +2404,12 @@ static void gui_display_settings()
 					"Use the interpreter. Very slow but may help in case of a dynarec problem");
 				ImGui::Columns(1, NULL, false);
 
+				{
+					DisabledScope scope(!config::DynarecEnabled);
+
+					OptionCheckbox("Skip Idle Loops", config::DynarecIdleSkip,
+							"Fast-forward to the next hardware event when the game is waiting in a loop. Disable if a game misbehaves");
+				}
 				OptionSlider("SH4 Clock", config::Sh4Clock, 100, 300,
 						"Over/Underclock the main SH4 CPU. Default is 200 MHz. Other values may crash, freeze or trigger unexpected nuclear reactions.",
 						"%d MHz");
@@ -2427,6 +2504,14 @@ static void gui_display_settings()
 	            		"Enable full MMU emulation and other Windows CE settings. Do not enable unless necessary");
 	            OptionCheckbox("Multi-threaded emulation", config::ThreadedRendering,
 	            		"Run the emulated CPU and GPU on different threads");
+#if defined(__linux__) && !defined(__ANDROID__)
+				{
+					DisabledScope scope(game_started);
+					OptionCheckbox("Bulk VRAM Tracking", config::BulkVramTracking,
+						"Let the kernel track texture updates (Linux 6.7+) instead of handling page faults. "
+						"Faster for games that update textures often. Not used with GGPO");
+				}
+#endif
 #ifndef __ANDROID
 	            OptionCheckbox("Serial Console", config::SerialConsole,
 	            		"Dump the Dreamcast serial console to stdout");
@@ -2438,6 +2523,21 @@ static void gui_display_settings()
 				}
 	            OptionCheckbox("Dump Textures", config::DumpTextures,
 	            		"Dump all textures into data/texdump/<game id>");
+				{
+					DisabledScope scope(!game_started);
+					if (guest_profiler::isActive())
+					{
+						if (ImGui::Button("Stop Guest Profiler"))
+							guest_profiler::stop();
+					}
+					else if (ImGui::Button("Start Guest Profiler"))
+					{
+						guest_profiler::start();
+					}
+					ImGui::SameLine();
+					ShowHelpMarker("Sample the emulated CPU while the game is running. When stopped, the call stacks are saved "
+							"to guest-profile.folded in the data folder for flamegraph.pl or speedscope");
+				}
 
 	            bool logToFile = cfgLoadBool("log", "LogToFile", false);
 	            bool newLogToFile = logToFile;
@@ -3053,8 +3153,14 @@ static std::string getFPSNotification()
 		if (fps >= 0.f && fps < 9999.f) {
 			char text[32];
 			snprintf(text, sizeof(text), "F:%.1f%s", fps, settings.input.fastForwardMode ? " >>" : "");
+			std::string notification(text);
+			if (renderer != nullptr)
+			{
+				notification += textureCacheStats.getOSDText();
+				notification += renderer->GetOSDStats();
+			}
 
-			return std::string(text);
+			return notification;
 		}
 	}
 	return std::string(settings.input.fastForwardMode ? ">>" : "");
@@ -3124,6 +3230,20 @@ void gui_display_profiler()
 		ImGui::Unindent();
 	}
 
+	{
+		char text[256];
+		std::snprintf(text, 256, "TA store queue: %u batched bursts, %u batches", taSqStats.lastBursts, taSqStats.lastBatches);
+		ImGui::TreeNode(text);
+	}
+
+	{
+		const addrspace::VramTrackingStats& stats = addrspace::vramTrackingStats;
+		char text[256];
+		std::snprintf(text, 256, "VRAM writes: %u trapped, %u found in bulk in %u us",
+				stats.lastTrappedWrites, stats.lastDirtyPages, stats.lastCheckTime);
+		ImGui::TreeNode(text);
+	}
+
 	ImGui::PopStyleColor();
 	
 	for (const fc_profiler::ProfileThread* profileThread : fc_profiler::ProfileThread::s_allThreads)
@@ -86,6 +86,7 @@ void mainui_term()
 void mainui_loop()
 {
 	mainui_enabled = true;
+	fc_profiler::setThreadName("main");
 	mainui_init();
 	RenderType currentRenderer = config::RendererType;
 
@@ -53,6 +53,85 @@ BufferData::BufferData(vk::DeviceSize size, vk::BufferUsageFlags usage, vk::Memo
 	allocation = context->GetAllocator().AllocateForBuffer(*buffer, allocInfo);
 }
 
+void StagingRing::Init(size_t chainSize, vk::DeviceSize size)
+{
+	if (bufferData && bufferData->bufferSize == size && frameUsed.size() == chainSize)
+		return;
+	Term();
+	bufferData = std::make_unique<BufferData>(size, vk::BufferUsageFlagBits::eTransferSrc);
+	mapped = (u8 *)bufferData->MapMemory();
+	frameUsed.assign(chainSize, 0);
+	head = 0;
+	frameStart = 0;
+	used = 0;
+	index = 0;
+}
+
+void StagingRing::Term()
+{
+	if (bufferData)
+	{
+		INFO_LOG(RENDERER, "Texture staging ring: peak usage %d KB / %d KB, %d overflows", (int)(peakUsage / 1024),
+				(int)(bufferData->bufferSize / 1024), overflows);
+		bufferData->UnmapMemory();
+		bufferData.reset();
+	}
+	mapped = nullptr;
+}
+
+void StagingRing::BeginFrame(int index)
+{
+	if (!bufferData)
+		return;
+	this->index = index;
+	lastFrameBytes = frameUsed[index];
+	used -= frameUsed[index];
+	frameUsed[index] = 0;
+	frameStart = head;
+}
+
+void StagingRing::Flush()
+{
+	if (!bufferData || frameUsed[index] == 0)
+		return;
+	if (head > frameStart) {
+		bufferData->allocation.FlushMemory(frameStart, head - frameStart);
+	}
+	else
+	{
+		// wrapped around
+		bufferData->allocation.FlushMemory(frameStart, bufferData->bufferSize - frameStart);
+		bufferData->allocation.FlushMemory(0, head);
+	}
+}
+
+void *StagingRing::Allocate(vk::DeviceSize size, vk::DeviceSize& offset)
+{
+	if (!bufferData)
+		return nullptr;
+	// Multiple of the texel size and of 4 for vkCmdCopyBufferToImage
+	constexpr vk::DeviceSize Alignment = 16;
+	const vk::DeviceSize capacity = bufferData->bufferSize;
+	vk::DeviceSize start = (head + Alignment - 1) & ~(Alignment - 1);
+	if (start + size > capacity)
+		// wrap around. The end of the buffer is skipped
+		start = 0;
+	// The memory in flight is the [head - used, head) range of the ring
+	const vk::DeviceSize consumed = (start >= head ? start - head : capacity - head) + size;
+	if (used + consumed > capacity)
+	{
+		overflows++;
+		return nullptr;
+	}
+	head = start + size;
+	used += consumed;
+	frameUsed[index] += consumed;
+	peakUsage = std::max(peakUsage, used);
+	offset = start;
+
+	return mapped + start;
+}
+
 BufferPacker::BufferPacker()
 {
 	uniformAlignment = VulkanContext::Instance()->GetUniformBufferAlignment();
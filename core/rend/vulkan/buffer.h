@@ -23,6 +23,9 @@
 #include "vmallocator.h"
 #include "utils.h"
 
+#include <memory>
+#include <vector>
+
 struct BufferData
 {
 	BufferData(vk::DeviceSize size, vk::BufferUsageFlags usage,
@@ -84,6 +87,38 @@ private:
 	vk::BufferUsageFlags    m_usage;
 };
 
+// Host-visible buffer shared by the texture uploads of the frames in flight.
+// Each frame allocates staging memory from the ring. It's reused once the fence of the frame has been waited on.
+class StagingRing
+{
+public:
+	void Init(size_t chainSize, vk::DeviceSize size);
+	void Term();
+	// Must be called once the fence of the given frame has been signaled
+	void BeginFrame(int index);
+	// Makes the data written during the current frame visible to the device. The ring stays mapped.
+	void Flush();
+	// Returns a pointer to size bytes of staging memory at the given offset of GetBuffer(), or nullptr if the ring is full
+	void *Allocate(vk::DeviceSize size, vk::DeviceSize& offset);
+	vk::Buffer GetBuffer() const { return *bufferData->buffer; }
+
+	// bytes allocated by the last frame
+	vk::DeviceSize lastFrameBytes = 0;
+	// max bytes in flight
+	vk::DeviceSize peakUsage = 0;
+	// uploads that didn't fit in the ring
+	u32 overflows = 0;
+
+private:
+	std::unique_ptr<BufferData> bufferData;
+	u8 *mapped = nullptr;
+	vk::DeviceSize head = 0;
+	vk::DeviceSize frameStart = 0;	// head at the beginning of the current frame
+	vk::DeviceSize used = 0;	// allocated by the frames in flight
+	std::vector<vk::DeviceSize> frameUsed;
+	int index = 0;
+};
+
 class BufferPacker
 {
 public:
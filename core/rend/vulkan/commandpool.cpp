@@ -45,6 +45,7 @@ void CommandPool::Init(size_t chainSize)
 void CommandPool::BeginFrame()
 {
 	index = (index + 1) % chainSize;
+	frameCount++;
 	VulkanContext::Instance()->GetDevice().waitForFences(fences[index].get(), true, UINT64_MAX);
 	VulkanContext::Instance()->GetDevice().resetFences(fences[index].get());
 	std::vector<vk::UniqueCommandBuffer>& inFlight = inFlightBuffers[index];
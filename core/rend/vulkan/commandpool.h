@@ -50,8 +50,20 @@ public:
 		return index;
 	}
 
+	size_t GetChainSize() const
+	{
+		return chainSize;
+	}
+
+	// Number of frames begun. The commands of a frame have completed once chainSize more frames have begun.
+	u64 GetFrameCount() const
+	{
+		return frameCount;
+	}
+
 private:
 	int index = 0;
+	u64 frameCount = 0;
 	std::vector<std::vector<vk::UniqueCommandBuffer>> freeBuffers;
 	std::vector<std::vector<vk::UniqueCommandBuffer>> inFlightBuffers;
 	std::vector<vk::UniqueCommandPool> commandPools;
@@ -126,6 +126,28 @@ void BaseDrawer::scaleAndWriteFramebuffer(vk::CommandBuffer commandBuffer, Frame
 		}
 	}
 
+	xClip.min = std::min(xClip.min, width - 1);
+	xClip.max = std::min(xClip.max, width - 1);
+	yClip.min = std::min(yClip.min, height - 1);
+	yClip.max = std::min(yClip.max, height - 1);
+	const u32 dstAddr = pvrrc.fb_W_SOF1 & VRAM_MASK;
+	const FB_W_CTRL_type fb_W_CTRL = pvrrc.fb_W_CTRL;
+	const u32 linestride = pvrrc.fb_W_LINESTRIDE * 8;
+
+	if (readbackQueue != nullptr && readbackQueue->IsEnabled())
+	{
+		const ReadbackArea area = lockFramebufferArea(width, height, dstAddr, fb_W_CTRL, linestride);
+		// The scaled image must live until the copy completes
+		std::shared_ptr<FramebufferAttachment> scaledImage(scaledFB);
+		readbackQueue->Read(commandBuffer, finalFB->GetImage(), width, height, area,
+				[width, height, dstAddr, fb_W_CTRL, linestride, xClip, yClip, scaledImage](const u8 *pixels) {
+			WriteFramebuffer(width, height, pixels, dstAddr, fb_W_CTRL, linestride, xClip, yClip);
+		});
+		commandBuffer.end();
+		commandPool->EndFrame();
+		return;
+	}
+
 	vk::BufferImageCopy copyRegion(0, width, height, vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1), vk::Offset3D(0, 0, 0),
 			vk::Extent3D(width, height, 1));
 	commandBuffer.copyImageToBuffer(finalFB->GetImage(), vk::ImageLayout::eTransferSrcOptimal,
@@ -151,12 +173,7 @@ void BaseDrawer::scaleAndWriteFramebuffer(vk::CommandBuffer commandBuffer, Frame
 	tmpBuf.init(width, height);
 	finalFB->GetBufferData()->download(width * height * 4, tmpBuf.data());
 
-	xClip.min = std::min(xClip.min, width - 1);
-	xClip.max = std::min(xClip.max, width - 1);
-	yClip.min = std::min(yClip.min, height - 1);
-	yClip.max = std::min(yClip.max, height - 1);
-	WriteFramebuffer(width, height, (u8 *)tmpBuf.data(), pvrrc.fb_W_SOF1 & VRAM_MASK,
-			pvrrc.fb_W_CTRL, pvrrc.fb_W_LINESTRIDE * 8, xClip, yClip);
+	WriteFramebuffer(width, height, (u8 *)tmpBuf.data(), dstAddr, fb_W_CTRL, linestride, xClip, yClip);
 
 	delete scaledFB;
 }
@@ -178,7 +195,9 @@ void Drawer::DrawPoly(const vk::CommandBuffer& cmdBuffer, u32 listType, bool sor
 			// Trilinear pass A
 			trilinearAlpha = 1.f - trilinearAlpha;
 	}
-	bool gpuPalette = poly.texture != nullptr ? poly.texture->gpuPalette : false;
+	int gpuPalette = 0;
+	if (poly.texture != nullptr && poly.texture->gpuPalette)
+		gpuPalette = Texture::IsFilteredGpuPalette(poly.tsp) ? 2 : 1;
 	float palette_index = 0.f;
 	if (gpuPalette)
 	{
@@ -553,7 +572,19 @@ void TextureDrawer::EndRenderPass()
 	u32 clippedWidth = pvrrc.getFramebufferWidth();
 	u32 clippedHeight = pvrrc.getFramebufferHeight();
 
-	if (config::RenderToTextureBuffer)
+	const bool async = config::RenderToTextureBuffer && readbackQueue != nullptr && readbackQueue->IsEnabled();
+	if (async)
+	{
+		const u32 linestride = pvrrc.fb_W_LINESTRIDE * 8;
+		const ReadbackArea area = lockReadbackArea(textureAddr, std::max(linestride, clippedWidth * 2) * clippedHeight);
+		u16 *dst = (u16 *)&vram[textureAddr];
+		const FB_W_CTRL_type fb_W_CTRL = pvrrc.fb_W_CTRL;
+		readbackQueue->Read(currentCommandBuffer, colorAttachment->GetImage(), clippedWidth, clippedHeight, area,
+				[clippedWidth, clippedHeight, dst, fb_W_CTRL, linestride](const u8 *pixels) {
+			WriteTextureToVRam(clippedWidth, clippedHeight, pixels, dst, fb_W_CTRL, linestride);
+		});
+	}
+	else if (config::RenderToTextureBuffer)
 	{
 		vk::BufferImageCopy copyRegion(0, clippedWidth, clippedHeight, vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1), vk::Offset3D(0, 0, 0),
 				vk::Extent3D(clippedWidth, clippedHeight, 1));
@@ -576,7 +607,7 @@ void TextureDrawer::EndRenderPass()
 	currentCommandBuffer = nullptr;
 	commandPool->EndFrame();
 
-	if (config::RenderToTextureBuffer)
+	if (config::RenderToTextureBuffer && !async)
 	{
 		vk::Fence fence = commandPool->GetCurrentFence();
 		GetContext()->GetDevice().waitForFences(fence, true, UINT64_MAX);
@@ -588,7 +619,7 @@ void TextureDrawer::EndRenderPass()
 		colorAttachment->GetBufferData()->download(clippedWidth * clippedHeight * 4, tmpBuf.data());
 		WriteTextureToVRam(clippedWidth, clippedHeight, (u8 *)tmpBuf.data(), dst, pvrrc.fb_W_CTRL, pvrrc.fb_W_LINESTRIDE * 8);
 	}
-	else
+	else if (!config::RenderToTextureBuffer)
 	{
 		//memset(&vram[fb_rtt.TexAddr << 3], '\0', size);
 
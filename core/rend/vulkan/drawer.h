@@ -25,6 +25,7 @@
 #include "buffer.h"
 #include "commandpool.h"
 #include "pipeline.h"
+#include "readback.h"
 #include "shaders.h"
 #include "texture.h"
 
@@ -36,6 +37,7 @@ class BaseDrawer
 {
 public:
 	void SetCommandPool(CommandPool *commandPool) { this->commandPool = commandPool; }
+	void SetReadbackQueue(ReadbackQueue *readbackQueue) { this->readbackQueue = readbackQueue; }
 
 protected:
 	VulkanContext *GetContext() const { return VulkanContext::Instance(); }
@@ -167,6 +169,7 @@ protected:
 	vk::Rect2D currentScissor;
 	TransformMatrix<COORD_VULKAN> matrices;
 	CommandPool *commandPool = nullptr;
+	ReadbackQueue *readbackQueue = nullptr;
 };
 
 class Drawer : public BaseDrawer
@@ -196,6 +199,7 @@ protected:
 			perStripSorting = config::PerStripSorting;
 			pipelineManager->Reset();
 		}
+		pipelineManager->PrecompilePipelines();
 		renderPass = 0;
 	}
 
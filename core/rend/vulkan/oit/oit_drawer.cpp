@@ -46,7 +46,9 @@ void OITDrawer::DrawPoly(const vk::CommandBuffer& cmdBuffer, u32 listType, bool
 
 	bool twoVolumes = poly.tsp1.full != (u32)-1 || poly.tcw1.full != (u32)-1;
 
-	bool gpuPalette = poly.texture != nullptr ? poly.texture->gpuPalette : false;
+	int gpuPalette = 0;
+	if (poly.texture != nullptr && poly.texture->gpuPalette)
+		gpuPalette = Texture::IsFilteredGpuPalette(poly.tsp) ? 2 : 1;
 
 	float palette_index = 0.f;
 	if (poly.tcw.PixelFmt == PixelPal4)
@@ -634,7 +636,19 @@ void OITTextureDrawer::EndFrame()
 	u32 clippedWidth = pvrrc.getFramebufferWidth();
 	u32 clippedHeight = pvrrc.getFramebufferHeight();
 
-	if (config::RenderToTextureBuffer)
+	const bool async = config::RenderToTextureBuffer && readbackQueue != nullptr && readbackQueue->IsEnabled();
+	if (async)
+	{
+		const u32 linestride = pvrrc.fb_W_LINESTRIDE * 8;
+		const ReadbackArea area = lockReadbackArea(textureAddr, std::max(linestride, clippedWidth * 2) * clippedHeight);
+		u16 *dst = (u16 *)&vram[textureAddr];
+		const FB_W_CTRL_type fb_W_CTRL = pvrrc.fb_W_CTRL;
+		readbackQueue->Read(currentCommandBuffer, colorAttachment->GetImage(), clippedWidth, clippedHeight, area,
+				[clippedWidth, clippedHeight, dst, fb_W_CTRL, linestride](const u8 *pixels) {
+			WriteTextureToVRam(clippedWidth, clippedHeight, pixels, dst, fb_W_CTRL, linestride);
+		});
+	}
+	else if (config::RenderToTextureBuffer)
 	{
 		vk::BufferImageCopy copyRegion(0, clippedWidth, clippedHeight,
 				vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1), vk::Offset3D(0, 0, 0),
@@ -659,7 +673,7 @@ void OITTextureDrawer::EndFrame()
 	currentCommandBuffer = nullptr;
 	commandPool->EndFrame();
 
-	if (config::RenderToTextureBuffer)
+	if (config::RenderToTextureBuffer && !async)
 	{
 		vk::Fence fence = commandPool->GetCurrentFence();
 		GetContext()->GetDevice().waitForFences(fence, true, UINT64_MAX);
@@ -671,7 +685,7 @@ void OITTextureDrawer::EndFrame()
 		colorAttachment->GetBufferData()->download(clippedWidth * clippedHeight * 4, tmpBuf.data());
 		WriteTextureToVRam(clippedWidth, clippedHeight, (u8 *)tmpBuf.data(), dst, pvrrc.fb_W_CTRL, pvrrc.fb_W_LINESTRIDE * 8);
 	}
-	else
+	else if (!config::RenderToTextureBuffer)
 	{
 		//memset(&vram[fb_rtt.TexAddr << 3], '\0', size);
 
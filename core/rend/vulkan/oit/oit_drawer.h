@@ -79,6 +79,7 @@ protected:
 	{
 		descriptorSets.nextFrame();
 		imageIndex = (imageIndex + 1) % GetSwapChainSize();
+		pipelineManager->PrecompilePipelines();
 		renderPass = 0;
 	}
 
@@ -20,9 +20,74 @@
 */
 #include "oit_pipeline.h"
 #include "../quad.h"
+#include "oslib/oslib.h"
 
-void OITPipelineManager::CreatePipeline(u32 listType, bool autosort, const PolyParam& pp, Pass pass, bool gpuPalette)
+vk::Pipeline OITPipelineManager::GetPipeline(u64 pipehash, const PipelineKey& key)
 {
+	compiler.collect(pipelines);
+	auto it = pipelines.find(pipehash);
+	if (it != pipelines.end())
+		return it->second.get();
+
+	pipelineStats.misses++;
+	manifest.record(key);
+	const PipelineState state = PipelineState::capture(renderPasses->GetRenderPass(true, true), *pipelineLayout);
+	PipelineKey syncKey = key;
+	if (config::AsyncPipelines)
+	{
+		// Draw with a pipeline with the same fixed-function state and simpler shaders until it's ready
+		PipelineKey genericKey = key.generic();
+		u64 genericHash = hash(genericKey);
+		if (genericHash != pipehash)
+		{
+			compiler.enqueue(pipehash, [this, key, state]() { return CreatePipeline(key, state); });
+			it = pipelines.find(genericHash);
+			if (it != pipelines.end())
+				return it->second.get();
+			// Generic pipelines are few and cheap to compile. Create it now rather than skipping the polygon.
+			pipehash = genericHash;
+			syncKey = genericKey;
+		}
+	}
+	double startTime = os_GetSeconds();
+	vk::UniquePipeline& pipeline = pipelines[pipehash];
+	pipeline = CreatePipeline(syncKey, state);
+	pipelineStats.compileTime += (u64)((os_GetSeconds() - startTime) * 1000000.0);
+
+	return pipeline.get();
+}
+
+void OITPipelineManager::PrecompilePipelines()
+{
+	manifest.save();
+	if (manifest.load(manifestName))
+		precompileNeeded = true;
+	if (!precompileNeeded)
+		return;
+	precompileNeeded = false;
+	const PipelineState state = PipelineState::capture(renderPasses->GetRenderPass(true, true), *pipelineLayout);
+	// Generic pipelines first so that they are ready when a specialized one is missing
+	for (const PipelineKey& key : manifest.getKeys())
+	{
+		PipelineKey genericKey = key.generic();
+		u64 pipehash = hash(genericKey);
+		if (pipelines.count(pipehash) == 0)
+			compiler.enqueue(pipehash, [this, genericKey, state]() { return CreatePipeline(genericKey, state); });
+	}
+	for (const PipelineKey& key : manifest.getKeys())
+	{
+		u64 pipehash = hash(key);
+		if (pipelines.count(pipehash) == 0)
+			compiler.enqueue(pipehash, [this, key, state]() { return CreatePipeline(key, state); });
+	}
+}
+
+vk::UniquePipeline OITPipelineManager::CreatePipeline(const PipelineKey& key, const PipelineState& state)
+{
+	const u32 listType = key.listType;
+	const bool autosort = key.sortTriangles;
+	const PolyParam pp = key.polyParam();
+	const Pass pass = (Pass)key.pass;
 	vk::PipelineVertexInputStateCreateInfo pipelineVertexInputStateCreateInfo = GetMainVertexInputStateCreateInfo();
 
 	// Input assembly state
@@ -138,15 +203,14 @@ void OITPipelineManager::CreatePipeline(u32 listType, bool autosort, const PolyP
 	vk::PipelineDynamicStateCreateInfo pipelineDynamicStateCreateInfo(vk::PipelineDynamicStateCreateFlags(), dynamicStates);
 
 	bool twoVolume = pp.tsp1.full != (u32)-1 || pp.tcw1.full != (u32)-1;
-	bool divPosZ = !settings.platform.isNaomi2() && config::NativeDepthInterpolation;
 	vk::ShaderModule vertex_module = shaderManager->GetVertexShader(
-			OITShaderManager::VertexShaderParams{ pp.pcw.Gouraud == 1, pp.isNaomi2(), pass != Pass::Depth, twoVolume, pp.pcw.Texture == 1, divPosZ });
+			OITShaderManager::VertexShaderParams{ pp.pcw.Gouraud == 1, pp.isNaomi2(), pass != Pass::Depth, twoVolume, pp.pcw.Texture == 1, state.divPosZ });
 	OITShaderManager::FragmentShaderParams params = {};
 	params.alphaTest = listType == ListType_Punch_Through;
 	params.bumpmap = pp.tcw.PixelFmt == PixelBumpMap;
-	params.clamping = pp.tsp.ColorClamp && (pvrrc.fog_clamp_min.full != 0 || pvrrc.fog_clamp_max.full != 0xffffffff);
+	params.clamping = key.clamping;
 	params.insideClipTest = (pp.tileclip >> 28) == 3;
-	params.fog = config::Fog ? pp.tsp.FogCtrl : 2;
+	params.fog = state.fog ? pp.tsp.FogCtrl : 2;
 	params.gouraud = pp.pcw.Gouraud;
 	params.ignoreTexAlpha = pp.tsp.IgnoreTexA || pp.tcw.PixelFmt == Pixel565;
 	params.offset = pp.pcw.Offset;
@@ -155,8 +219,8 @@ void OITPipelineManager::CreatePipeline(u32 listType, bool autosort, const PolyP
 	params.useAlpha = pp.tsp.UseAlpha;
 	params.pass = pass;
 	params.twoVolume = twoVolume;
-	params.palette = gpuPalette;
-	params.divPosZ = divPosZ;
+	params.palette = key.gpuPalette;
+	params.divPosZ = state.divPosZ;
 	vk::ShaderModule fragment_module = shaderManager->GetFragmentShader(params);
 
 	std::array<vk::PipelineShaderStageCreateInfo, 2> stages = {
@@ -176,12 +240,12 @@ void OITPipelineManager::CreatePipeline(u32 listType, bool autosort, const PolyP
 	  &pipelineDepthStencilStateCreateInfo,       // pDepthStencilState
 	  &pipelineColorBlendStateCreateInfo,         // pColorBlendState
 	  &pipelineDynamicStateCreateInfo,            // pDynamicState
-	  *pipelineLayout,                            // layout
-	  renderPasses->GetRenderPass(true, true),    // renderPass
+	  state.layout,                               // layout
+	  state.renderPass,                           // renderPass
 	  pass == Pass::Depth ? (listType == ListType_Translucent ? 2 : 0) : 1 // subpass
 	);
 
-	pipelines[hash(listType, autosort, &pp, pass, gpuPalette)] = GetContext()->GetDevice().createGraphicsPipelineUnique(GetContext()->GetPipelineCache(),
+	return GetContext()->GetDevice().createGraphicsPipelineUnique(GetContext()->GetPipelineCache(),
 			graphicsPipelineCreateInfo).value;
 }
 
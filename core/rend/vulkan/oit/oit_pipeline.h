@@ -25,6 +25,7 @@
 #include "oit_buffer.h"
 #include "../texture.h"
 #include "../desc_set.h"
+#include "../pipeline_compiler.h"
 
 #include <glm/glm.hpp>
 #include <unordered_map>
@@ -166,14 +167,16 @@ public:
 			vk::DescriptorImageInfo imageInfo0;
 			if (poly.texture != nullptr)
 			{
-				imageInfo0 = vk::DescriptorImageInfo{ samplerManager->GetSampler(poly.tsp, punchThrough), ((Texture *)poly.texture)->GetReadOnlyImageView(),
+				Texture *texture = (Texture *)poly.texture;
+				imageInfo0 = vk::DescriptorImageInfo{ samplerManager->GetSampler(poly.tsp, punchThrough, texture->gpuPalette), texture->GetReadOnlyImageView(),
 						vk::ImageLayout::eShaderReadOnlyOptimal };
 				writeDescriptorSets.emplace_back(perPolyDescSet, 0, 0, vk::DescriptorType::eCombinedImageSampler, imageInfo0);
 			}
 			vk::DescriptorImageInfo imageInfo1;
 			if (poly.texture1 != nullptr)
 			{
-				imageInfo1 = vk::DescriptorImageInfo{ samplerManager->GetSampler(poly.tsp1, punchThrough), ((Texture *)poly.texture1)->GetReadOnlyImageView(),
+				Texture *texture = (Texture *)poly.texture1;
+				imageInfo1 = vk::DescriptorImageInfo{ samplerManager->GetSampler(poly.tsp1, punchThrough, texture->gpuPalette), texture->GetReadOnlyImageView(),
 					vk::ImageLayout::eShaderReadOnlyOptimal };
 				writeDescriptorSets.emplace_back(perPolyDescSet, 1, 0, vk::DescriptorType::eCombinedImageSampler, imageInfo1);
 			}
@@ -269,8 +272,11 @@ private:
 class OITPipelineManager
 {
 public:
-	OITPipelineManager() : renderPasses(&ownRenderPasses) {}
-	virtual ~OITPipelineManager() = default;
+	OITPipelineManager(const char *manifestName = "vk_oit") : renderPasses(&ownRenderPasses), manifestName(manifestName) {}
+	virtual ~OITPipelineManager() {
+		compiler.term();
+		manifest.save();
+	}
 
 	virtual void Init(OITShaderManager *shaderManager, OITBuffers *oitBuffers)
 	{
@@ -319,26 +325,29 @@ public:
 					vk::PipelineLayoutCreateInfo(vk::PipelineLayoutCreateFlags(), layouts, pushConstants));
 		}
 
+		compiler.flush();
 		pipelines.clear();
 		modVolPipelines.clear();
 		trModVolPipelines.clear();
+		precompileNeeded = true;
 		finalPipelines[0].reset();
 		finalPipelines[1].reset();
 		clearPipeline.reset();
 	}
 
-	vk::Pipeline GetPipeline(u32 listType, bool autosort, const PolyParam& pp, Pass pass, bool gpuPalette)
+	vk::Pipeline GetPipeline(u32 listType, bool autosort, const PolyParam& pp, Pass pass, int gpuPalette)
 	{
-		u32 pipehash = hash(listType, autosort, &pp, pass, gpuPalette);
+		u64 pipehash = hash(listType, autosort, &pp, pass, gpuPalette);
 		const auto &pipeline = pipelines.find(pipehash);
 		if (pipeline != pipelines.end())
 			return pipeline->second.get();
 
-		CreatePipeline(listType, autosort, pp, pass, gpuPalette);
-
-		return *pipelines[pipehash];
+		return GetPipeline(pipehash, PipelineKey::make(listType, autosort, pp, gpuPalette, false, (int)pass));
 	}
 
+	// Compiles the pipelines recorded in the game manifest in the background
+	void PrecompilePipelines();
+
 	vk::Pipeline GetModifierVolumePipeline(ModVolMode mode, int cullMode, bool naomi2)
 	{
 		u32 pipehash = hash(mode, cullMode, naomi2);
@@ -386,18 +395,24 @@ public:
 	vk::RenderPass GetRenderPass(bool initial, bool last, bool loadClear = false) { return renderPasses->GetRenderPass(initial, last, loadClear); }
 
 private:
+	vk::Pipeline GetPipeline(u64 pipehash, const PipelineKey& key);
 	void CreateModVolPipeline(ModVolMode mode, int cullMode, bool naomi2);
 	void CreateTrModVolPipeline(ModVolMode mode, int cullMode, bool naomi2);
 
-	u32 hash(u32 listType, bool autosort, const PolyParam *pp, Pass pass, bool gpuPalette) const
+	u64 hash(const PipelineKey& key) const
 	{
-		u32 hash = pp->pcw.Gouraud | (pp->pcw.Offset << 1) | (pp->pcw.Texture << 2) | (pp->pcw.Shadow << 3)
+		PolyParam pp = key.polyParam();
+		return hash(key.listType, key.sortTriangles, &pp, (Pass)key.pass, key.gpuPalette);
+	}
+	u64 hash(u32 listType, bool autosort, const PolyParam *pp, Pass pass, int gpuPalette) const
+	{
+		u64 hash = pp->pcw.Gouraud | (pp->pcw.Offset << 1) | (pp->pcw.Texture << 2) | (pp->pcw.Shadow << 3)
 			| (((pp->tileclip >> 28) == 3) << 4);
 		hash |= ((listType >> 1) << 5);
 		if (pp->tcw1.full != (u32)-1 || pp->tsp1.full != (u32)-1)
 		{
 			// Two-volume mode
-			hash |= (1 << 31) | (pp->tsp.ColorClamp << 11);
+			hash |= (1u << 31) | (pp->tsp.ColorClamp << 11);
 		}
 		else
 		{
@@ -407,9 +422,10 @@ private:
 				| (pp->tsp.SrcInstr << 14) | (pp->tsp.DstInstr << 17);
 		}
 		hash |= (pp->isp.ZWriteDis << 20) | (pp->isp.CullMode << 21) | ((autosort ? 6 : pp->isp.DepthMode) << 23);
-		hash |= ((u32)gpuPalette << 26) | ((u32)pass << 27) | ((u32)pp->isNaomi2() << 29);
+		hash |= ((u32)(gpuPalette != 0) << 26) | ((u32)pass << 27) | ((u32)pp->isNaomi2() << 29);
 		hash |= (u32)(!settings.platform.isNaomi2() && config::NativeDepthInterpolation) << 30;
-		hash |= (u32)(pp->tcw.PixelFmt == PixelBumpMap) << 31;
+		hash |= (u64)(pp->tcw.PixelFmt == PixelBumpMap) << 32;
+		hash |= (u64)(gpuPalette == 2) << 33;
 
 		return hash;
 	}
@@ -448,11 +464,11 @@ private:
 				full ? vertexInputAttributeDescriptions : vertexInputLightAttributeDescriptions);
 	}
 
-	void CreatePipeline(u32 listType, bool autosort, const PolyParam& pp, Pass pass, bool gpuPalette);
+	vk::UniquePipeline CreatePipeline(const PipelineKey& key, const PipelineState& state);
 	void CreateFinalPipeline(bool dithering);
 	void CreateClearPipeline();
 
-	std::map<u32, vk::UniquePipeline> pipelines;
+	std::map<u64, vk::UniquePipeline> pipelines;
 	std::map<u32, vk::UniquePipeline> modVolPipelines;
 	std::map<u32, vk::UniquePipeline> trModVolPipelines;
 	vk::UniquePipeline finalPipelines[2];
@@ -464,9 +480,14 @@ private:
 	vk::UniqueDescriptorSetLayout perPolyLayout;
 	RenderPasses ownRenderPasses;
 	int maxLayers = 0;
+	const char *manifestName;
+	PipelineManifest manifest;
+	bool precompileNeeded = true;
+	AsyncPipelineCompiler compiler;
 
 protected:
 	VulkanContext *GetContext() const { return VulkanContext::Instance(); }
+	void CancelPipelines() { compiler.flush(); }
 
 	RenderPasses *renderPasses;
 	OITShaderManager *shaderManager = nullptr;
@@ -475,7 +496,11 @@ protected:
 class RttOITPipelineManager : public OITPipelineManager
 {
 public:
-	RttOITPipelineManager() { renderPasses = &rttRenderPasses; }
+	RttOITPipelineManager() : OITPipelineManager("vk_oit_rtt") { renderPasses = &rttRenderPasses; }
+	~RttOITPipelineManager() override {
+		// pending pipelines use the rtt render passes
+		CancelPipelines();
+	}
 	void Init(OITShaderManager *shaderManager, OITBuffers *oitBuffers) override
 	{
 		this->oitBuffers = oitBuffers;
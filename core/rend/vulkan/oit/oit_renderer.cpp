@@ -34,9 +34,11 @@ public:
 			oitBuffers.Init(viewport.width, viewport.height);
 			textureDrawer.Init(&samplerManager, &oitShaderManager, &textureCache, &oitBuffers);
 			textureDrawer.SetCommandPool(&texCommandPool);
+			textureDrawer.SetReadbackQueue(&readbackQueue);
 
 			screenDrawer.Init(&samplerManager, &oitShaderManager, &oitBuffers, viewport);
 			screenDrawer.SetCommandPool(&texCommandPool);
+			screenDrawer.SetReadbackQueue(&readbackQueue);
 			BaseInit(screenDrawer.GetRenderPass(), 2);
 			emulateFramebuffer = config::EmulateFramebuffer;
 
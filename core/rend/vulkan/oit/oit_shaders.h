@@ -24,6 +24,7 @@
 #include "cfg/option.h"
 
 #include <map>
+#include <mutex>
 
 enum class Pass { Depth, Color, OIT };
 
@@ -58,7 +59,7 @@ public:
 		bool bumpmap;
 		bool clamping;
 		bool twoVolume;
-		bool palette;
+		int palette;		// 0: none, 1: nearest, 2: bilinear
 		bool divPosZ;
 		Pass pass;
 
@@ -68,7 +69,7 @@ public:
 				| ((u32)texture << 3) | ((u32)ignoreTexAlpha << 4) | (shaderInstr << 5)
 				| ((u32)offset << 7) | ((u32)fog << 8) | ((u32)gouraud << 10)
 				| ((u32)bumpmap << 11) | ((u32)clamping << 12) | ((u32)twoVolume << 13)
-				| ((u32)palette << 14) | ((int)pass << 15) | ((u32)divPosZ << 17);
+				| ((u32)palette << 14) | ((int)pass << 16) | ((u32)divPosZ << 18);
 		}
 	};
 
@@ -148,6 +149,8 @@ private:
 	template<typename T>
 	vk::ShaderModule getShader(std::map<u32, vk::UniqueShaderModule>& map, T params)
 	{
+		// pipelines can be compiled in the background
+		std::lock_guard<std::mutex> _(mutex);
 		u32 h = params.hash();
 		auto it = map.find(h);
 		if (it != map.end())
@@ -164,6 +167,7 @@ private:
 	vk::UniqueShaderModule compileFinalVertexShader();
 	vk::UniqueShaderModule compileClearShader();
 
+	std::mutex mutex;
 	std::map<u32, vk::UniqueShaderModule> vertexShaders;
 	std::map<u32, vk::UniqueShaderModule> fragmentShaders;
 	std::map<u32, vk::UniqueShaderModule> modVolVertexShaders;
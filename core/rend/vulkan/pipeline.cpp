@@ -21,6 +21,7 @@
 #include "pipeline.h"
 #include "hw/pvr/Renderer_if.h"
 #include "rend/osd.h"
+#include "oslib/oslib.h"
 
 void PipelineManager::CreateModVolPipeline(ModVolMode mode, int cullMode, bool naomi2)
 {
@@ -260,13 +261,76 @@ void PipelineManager::CreateDepthPassPipeline(int cullMode, bool naomi2)
 					graphicsPipelineCreateInfo).value;
 }
 
-void PipelineManager::CreatePipeline(u32 listType, bool sortTriangles, const PolyParam& pp, bool gpuPalette, bool dithering)
+vk::Pipeline PipelineManager::GetPipeline(u64 pipehash, const PipelineKey& key)
 {
+	compiler.collect(pipelines);
+	auto it = pipelines.find(pipehash);
+	if (it != pipelines.end())
+		return it->second.get();
+
+	pipelineStats.misses++;
+	manifest.record(key);
+	const PipelineState state = PipelineState::capture(renderPass, *pipelineLayout);
+	PipelineKey syncKey = key;
+	if (config::AsyncPipelines)
+	{
+		// Draw with a pipeline with the same fixed-function state and simpler shaders until it's ready
+		PipelineKey genericKey = key.generic();
+		u64 genericHash = hash(genericKey);
+		if (genericHash != pipehash)
+		{
+			compiler.enqueue(pipehash, [this, key, state]() { return CreatePipeline(key, state); });
+			it = pipelines.find(genericHash);
+			if (it != pipelines.end())
+				return it->second.get();
+			// Generic pipelines are few and cheap to compile. Create it now rather than skipping the polygon.
+			pipehash = genericHash;
+			syncKey = genericKey;
+		}
+	}
+	double startTime = os_GetSeconds();
+	vk::UniquePipeline& pipeline = pipelines[pipehash];
+	pipeline = CreatePipeline(syncKey, state);
+	pipelineStats.compileTime += (u64)((os_GetSeconds() - startTime) * 1000000.0);
+
+	return pipeline.get();
+}
+
+void PipelineManager::PrecompilePipelines()
+{
+	manifest.save();
+	if (manifest.load(manifestName))
+		precompileNeeded = true;
+	if (!precompileNeeded)
+		return;
+	precompileNeeded = false;
+	const PipelineState state = PipelineState::capture(renderPass, *pipelineLayout);
+	// Generic pipelines first so that they are ready when a specialized one is missing
+	for (const PipelineKey& key : manifest.getKeys())
+	{
+		PipelineKey genericKey = key.generic();
+		u64 pipehash = hash(genericKey);
+		if (pipelines.count(pipehash) == 0)
+			compiler.enqueue(pipehash, [this, genericKey, state]() { return CreatePipeline(genericKey, state); });
+	}
+	for (const PipelineKey& key : manifest.getKeys())
+	{
+		u64 pipehash = hash(key);
+		if (pipelines.count(pipehash) == 0)
+			compiler.enqueue(pipehash, [this, key, state]() { return CreatePipeline(key, state); });
+	}
+}
+
+vk::UniquePipeline PipelineManager::CreatePipeline(const PipelineKey& key, const PipelineState& state)
+{
+	const u32 listType = key.listType;
+	const bool sortTriangles = key.sortTriangles;
+	const PolyParam pp = key.polyParam();
 	vk::PipelineVertexInputStateCreateInfo pipelineVertexInputStateCreateInfo = GetMainVertexInputStateCreateInfo();
 
 	// Input assembly state
 	vk::PipelineInputAssemblyStateCreateInfo pipelineInputAssemblyStateCreateInfo;
-	if (sortTriangles && !config::PerStripSorting) {
+	if (sortTriangles && !state.perStripSorting) {
 		pipelineInputAssemblyStateCreateInfo.topology = vk::PrimitiveTopology::eTriangleList;
 	}
 	else
@@ -387,14 +451,13 @@ void PipelineManager::CreatePipeline(u32 listType, bool sortTriangles, const Pol
 	vk::DynamicState dynamicStates[2] = { vk::DynamicState::eViewport, vk::DynamicState::eScissor };
 	vk::PipelineDynamicStateCreateInfo pipelineDynamicStateCreateInfo(vk::PipelineDynamicStateCreateFlags(), 2, dynamicStates);
 
-	bool divPosZ = !settings.platform.isNaomi2() && config::NativeDepthInterpolation;
-	vk::ShaderModule vertex_module = shaderManager->GetVertexShader(VertexShaderParams { pp.pcw.Gouraud == 1, pp.isNaomi2(), divPosZ });
+	vk::ShaderModule vertex_module = shaderManager->GetVertexShader(VertexShaderParams { pp.pcw.Gouraud == 1, pp.isNaomi2(), state.divPosZ });
 	FragmentShaderParams params = {};
 	params.alphaTest = listType == ListType_Punch_Through;
 	params.bumpmap = pp.tcw.PixelFmt == PixelBumpMap;
-	params.clamping = pp.tsp.ColorClamp && (pvrrc.fog_clamp_min.full != 0 || pvrrc.fog_clamp_max.full != 0xffffffff);
+	params.clamping = key.clamping;
 	params.insideClipTest = (pp.tileclip >> 28) == 3;
-	params.fog = config::Fog ? pp.tsp.FogCtrl : 2;
+	params.fog = state.fog ? pp.tsp.FogCtrl : 2;
 	params.gouraud = pp.pcw.Gouraud;
 	params.ignoreTexAlpha = pp.tsp.IgnoreTexA || pp.tcw.PixelFmt == Pixel565;
 	params.offset = pp.pcw.Offset;
@@ -402,9 +465,9 @@ void PipelineManager::CreatePipeline(u32 listType, bool sortTriangles, const Pol
 	params.texture = pp.pcw.Texture;
 	params.trilinear = pp.pcw.Texture && pp.tsp.FilterMode > 1 && listType != ListType_Punch_Through && pp.tcw.MipMapped == 1;
 	params.useAlpha = pp.tsp.UseAlpha;
-	params.palette = gpuPalette;
-	params.divPosZ = divPosZ;
-	params.dithering = dithering;
+	params.palette = key.gpuPalette;
+	params.divPosZ = state.divPosZ;
+	params.dithering = key.dithering;
 	vk::ShaderModule fragment_module = shaderManager->GetFragmentShader(params);
 
 	std::array<vk::PipelineShaderStageCreateInfo, 2> stages = {
@@ -424,11 +487,11 @@ void PipelineManager::CreatePipeline(u32 listType, bool sortTriangles, const Pol
 	  &pipelineDepthStencilStateCreateInfo,       // pDepthStencilState
 	  &pipelineColorBlendStateCreateInfo,         // pColorBlendState
 	  &pipelineDynamicStateCreateInfo,            // pDynamicState
-	  *pipelineLayout,                            // layout
-	  renderPass                                  // renderPass
+	  state.layout,                               // layout
+	  state.renderPass                            // renderPass
 	);
 
-	pipelines[hash(listType, sortTriangles, &pp, gpuPalette, dithering)] = GetContext()->GetDevice().createGraphicsPipelineUnique(GetContext()->GetPipelineCache(),
+	return GetContext()->GetDevice().createGraphicsPipelineUnique(GetContext()->GetPipelineCache(),
 			graphicsPipelineCreateInfo).value;
 }
 
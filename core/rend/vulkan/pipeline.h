@@ -25,6 +25,7 @@
 #include "utils.h"
 #include "vulkan_context.h"
 #include "desc_set.h"
+#include "pipeline_compiler.h"
 #include <array>
 #include <unordered_map>
 
@@ -89,8 +90,9 @@ public:
 			vk::DescriptorImageInfo imageInfo;
 			if (poly.texture != nullptr)
 			{
-				imageInfo = vk::DescriptorImageInfo(samplerManager->GetSampler(poly.tsp, punchThrough),
-						((Texture *)poly.texture)->GetReadOnlyImageView(), vk::ImageLayout::eShaderReadOnlyOptimal);
+				Texture *texture = (Texture *)poly.texture;
+				imageInfo = vk::DescriptorImageInfo(samplerManager->GetSampler(poly.tsp, punchThrough, texture->gpuPalette),
+						texture->GetReadOnlyImageView(), vk::ImageLayout::eShaderReadOnlyOptimal);
 				writeDescriptorSets.emplace_back(perPolyDescSet, 0, 0, vk::DescriptorType::eCombinedImageSampler, imageInfo);
 			}
 
@@ -174,7 +176,11 @@ private:
 class PipelineManager
 {
 public:
-	virtual ~PipelineManager() = default;
+	PipelineManager(const char *manifestName = "vk") : manifestName(manifestName) {}
+	virtual ~PipelineManager() {
+		compiler.term();
+		manifest.save();
+	}
 
 	void Init(ShaderManager *shaderManager, vk::RenderPass renderPass)
 	{
@@ -211,16 +217,14 @@ public:
 		}
 	}
 
-	vk::Pipeline GetPipeline(u32 listType, bool sortTriangles, const PolyParam& pp, bool gpuPalette, bool dithering)
+	vk::Pipeline GetPipeline(u32 listType, bool sortTriangles, const PolyParam& pp, int gpuPalette, bool dithering)
 	{
-		u32 pipehash = hash(listType, sortTriangles, &pp, gpuPalette, dithering);
+		u64 pipehash = hash(listType, sortTriangles, &pp, gpuPalette, dithering);
 		const auto &pipeline = pipelines.find(pipehash);
 		if (pipeline != pipelines.end())
 			return pipeline->second.get();
 
-		CreatePipeline(listType, sortTriangles, pp, gpuPalette, dithering);
-
-		return *pipelines[pipehash];
+		return GetPipeline(pipehash, PipelineKey::make(listType, sortTriangles, pp, gpuPalette, dithering));
 	}
 
 	vk::Pipeline GetModifierVolumePipeline(ModVolMode mode, int cullMode, bool naomi2)
@@ -247,22 +251,33 @@ public:
 
 	void Reset()
 	{
+		compiler.flush();
 		pipelines.clear();
 		modVolPipelines.clear();
+		precompileNeeded = true;
 	}
 
+	// Compiles the pipelines recorded in the game manifest in the background
+	void PrecompilePipelines();
+
 	vk::PipelineLayout GetPipelineLayout() const { return *pipelineLayout; }
 	vk::DescriptorSetLayout GetPerFrameDSLayout() const { return *perFrameLayout; }
 	vk::DescriptorSetLayout GetPerPolyDSLayout() const { return *perPolyLayout; }
 	vk::RenderPass GetRenderPass() const { return renderPass; }
 
 private:
+	vk::Pipeline GetPipeline(u64 pipehash, const PipelineKey& key);
 	void CreateModVolPipeline(ModVolMode mode, int cullMode, bool naomi2);
 	void CreateDepthPassPipeline(int cullMode, bool naomi2);
 
-	u32 hash(u32 listType, bool sortTriangles, const PolyParam *pp, bool gpuPalette, bool dithering) const
+	u64 hash(const PipelineKey& key) const
+	{
+		PolyParam pp = key.polyParam();
+		return hash(key.listType, key.sortTriangles, &pp, key.gpuPalette, key.dithering);
+	}
+	u64 hash(u32 listType, bool sortTriangles, const PolyParam *pp, int gpuPalette, bool dithering) const
 	{
-		u32 hash = pp->pcw.Gouraud | (pp->pcw.Offset << 1) | (pp->pcw.Texture << 2) | (pp->pcw.Shadow << 3)
+		u64 hash = pp->pcw.Gouraud | (pp->pcw.Offset << 1) | (pp->pcw.Texture << 2) | (pp->pcw.Shadow << 3)
 			| (((pp->tileclip >> 28) == 3) << 4);
 		hash |= ((listType >> 1) << 5);
 		bool ignoreTexAlpha = pp->tsp.IgnoreTexA || pp->tcw.PixelFmt == Pixel565;
@@ -270,10 +285,11 @@ private:
 			| (pp->tsp.ColorClamp << 11) | ((config::Fog ? pp->tsp.FogCtrl : 2) << 12) | (pp->tsp.SrcInstr << 14)
 			| (pp->tsp.DstInstr << 17);
 		hash |= (pp->isp.ZWriteDis << 20) | (pp->isp.CullMode << 21) | (pp->isp.DepthMode << 23);
-		hash |= ((u32)sortTriangles << 26) | ((u32)gpuPalette << 27) | ((u32)pp->isNaomi2() << 28);
+		hash |= ((u32)sortTriangles << 26) | ((u32)(gpuPalette != 0) << 27) | ((u32)pp->isNaomi2() << 28);
 		hash |= (u32)(!settings.platform.isNaomi2() && config::NativeDepthInterpolation) << 29;
 		hash |= (u32)(pp->tcw.PixelFmt == PixelBumpMap) << 30;
 		hash |= (u32)dithering << 31;
+		hash |= (u64)(gpuPalette == 2) << 32;
 
 		return hash;
 	}
@@ -313,9 +329,9 @@ private:
 				full ? vertexInputAttributeDescriptions : vertexInputLightAttributeDescriptions);
 	}
 
-	void CreatePipeline(u32 listType, bool sortTriangles, const PolyParam& pp, bool gpuPalette, bool dithering);
+	vk::UniquePipeline CreatePipeline(const PipelineKey& key, const PipelineState& state);
 
-	std::map<u32, vk::UniquePipeline> pipelines;
+	std::map<u64, vk::UniquePipeline> pipelines;
 	std::map<u32, vk::UniquePipeline> modVolPipelines;
 	std::map<u32, vk::UniquePipeline> depthPassPipelines;
 
@@ -323,6 +339,11 @@ private:
 	vk::UniqueDescriptorSetLayout perFrameLayout;
 	vk::UniqueDescriptorSetLayout perPolyLayout;
 
+	const char *manifestName;
+	PipelineManifest manifest;
+	bool precompileNeeded = true;
+	AsyncPipelineCompiler compiler;
+
 protected:
 	VulkanContext *GetContext() const { return VulkanContext::Instance(); }
 
@@ -333,6 +354,12 @@ protected:
 class RttPipelineManager : public PipelineManager
 {
 public:
+	RttPipelineManager() : PipelineManager("vk_rtt") {}
+	~RttPipelineManager() override {
+		// pending pipelines use the rtt render pass
+		Reset();
+	}
+
 	void Init(ShaderManager *shaderManager)
 	{
 		// RTT render pass
@@ -0,0 +1,261 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "pipeline_compiler.h"
+#include "hw/pvr/Renderer_if.h"
+#include "oslib/oslib.h"
+#include "cfg/option.h"
+
+PipelineStats pipelineStats;
+
+constexpr u32 MANIFEST_MAGIC = 0x4c505646;	// FVPL
+constexpr u32 MANIFEST_VERSION = 1;
+
+PipelineKey PipelineKey::make(u32 listType, bool sortTriangles, const PolyParam& pp, int gpuPalette, bool dithering, int pass)
+{
+	PipelineKey key{};
+	key.listType = listType;
+	key.pcw = pp.pcw.full;
+	key.isp = pp.isp.full;
+	key.tsp = pp.tsp.full;
+	key.tcw = pp.tcw.full;
+	key.tileclip = pp.tileclip;
+	key.tsp1 = pp.tsp1.full;
+	key.tcw1 = pp.tcw1.full;
+	key.sortTriangles = sortTriangles;
+	key.pass = (u8)pass;
+	key.gpuPalette = (u8)gpuPalette;
+	key.dithering = dithering;
+	key.naomi2 = pp.isNaomi2();
+	key.clamping = pp.tsp.ColorClamp && (pvrrc.fog_clamp_min.full != 0 || pvrrc.fog_clamp_max.full != 0xffffffff);
+
+	return key;
+}
+
+PipelineKey PipelineKey::generic() const
+{
+	PipelineKey key = *this;
+	PCW pcw;
+	pcw.full = key.pcw;
+	pcw.Texture = 0;
+	pcw.Offset = 0;
+	key.pcw = pcw.full;
+	TSP tsp;
+	tsp.full = key.tsp;
+	tsp.ShadInstr = 0;
+	tsp.IgnoreTexA = 0;
+	tsp.FogCtrl = 2;
+	tsp.ColorClamp = 0;
+	tsp.FilterMode = 0;
+	key.tsp = tsp.full;
+	key.tcw = 0;
+	key.gpuPalette = 0;
+	key.dithering = false;
+	key.clamping = false;
+
+	return key;
+}
+
+PolyParam PipelineKey::polyParam() const
+{
+	PolyParam pp;
+	pp.init();
+	pp.pcw.full = pcw;
+	pp.isp.full = isp;
+	pp.tsp.full = tsp;
+	pp.tcw.full = tcw;
+	pp.tileclip = tileclip;
+	pp.tsp1.full = tsp1;
+	pp.tcw1.full = tcw1;
+	if (naomi2)
+		pp.projMatrix = 0;
+
+	return pp;
+}
+
+bool PipelineManifest::load(const std::string& name)
+{
+	if (loaded && settings.content.gameId == gameId)
+		return false;
+	save();
+	loaded = true;
+	gameId = settings.content.gameId;
+	keys.clear();
+	path.clear();
+	if (gameId.empty())
+		return true;
+	path = hostfs::getShaderCachePath(gameId + "_" + name + ".pipelines");
+	FILE *f = nowide::fopen(path.c_str(), "rb");
+	if (f == nullptr)
+		return true;
+	u32 header[2];
+	if (std::fread(header, sizeof(header), 1, f) != 1 || header[0] != MANIFEST_MAGIC || header[1] != MANIFEST_VERSION)
+	{
+		WARN_LOG(RENDERER, "Ignoring invalid pipeline manifest %s", path.c_str());
+		std::fclose(f);
+		nowide::remove(path.c_str());
+		return true;
+	}
+	PipelineKey key;
+	while (std::fread(&key, sizeof(key), 1, f) == 1)
+		keys.insert(key);
+	std::fclose(f);
+	INFO_LOG(RENDERER, "Pipeline manifest %s: %d pipelines", path.c_str(), (int)keys.size());
+
+	return true;
+}
+
+void PipelineManifest::record(const PipelineKey& key)
+{
+	if (!path.empty() && keys.insert(key).second)
+		unsaved.push_back(key);
+}
+
+void PipelineManifest::save()
+{
+	if (unsaved.empty())
+		return;
+	FILE *f = nowide::fopen(path.c_str(), "ab");
+	if (f != nullptr)
+	{
+		if (std::ftell(f) == 0)
+		{
+			const u32 header[] { MANIFEST_MAGIC, MANIFEST_VERSION };
+			std::fwrite(header, sizeof(header), 1, f);
+		}
+		std::fwrite(unsaved.data(), sizeof(PipelineKey), unsaved.size(), f);
+		std::fclose(f);
+	}
+	unsaved.clear();
+}
+
+PipelineState PipelineState::capture(vk::RenderPass renderPass, vk::PipelineLayout layout)
+{
+	PipelineState state;
+	state.renderPass = renderPass;
+	state.layout = layout;
+	state.perStripSorting = config::PerStripSorting;
+	state.divPosZ = !settings.platform.isNaomi2() && config::NativeDepthInterpolation;
+	state.fog = config::Fog;
+
+	return state;
+}
+
+std::string PipelineStats::getOSDText() const
+{
+	char text[64];
+	snprintf(text, sizeof(text), " P:%d %.1fms%s", lastMisses, lastCompileTime / 1000.0,
+			pending != 0 ? " *" : "");
+	return text;
+}
+
+void AsyncPipelineCompiler::start()
+{
+	int threadCount = std::max(1, std::min(4, (int)std::thread::hardware_concurrency() - 2));
+	stopping = false;
+	for (int i = 0; i < threadCount; i++)
+		workers.emplace_back(&AsyncPipelineCompiler::run, this);
+}
+
+void AsyncPipelineCompiler::enqueue(u64 hash, Task task)
+{
+	std::lock_guard<std::mutex> _(mutex);
+	if (!pendingHashes.insert(hash).second)
+		return;
+	if (workers.empty())
+		start();
+	queue.emplace_back(hash, std::move(task));
+	pipelineStats.pending++;
+	workAvailable.notify_one();
+}
+
+void AsyncPipelineCompiler::collect(std::map<u64, vk::UniquePipeline>& pipelines)
+{
+	if (!hasCompiled)
+		return;
+	std::lock_guard<std::mutex> _(mutex);
+	for (auto& pair : compiled)
+	{
+		// keep the existing pipeline if it was created synchronously in the meantime
+		pipelines.emplace(pair.first, std::move(pair.second));
+		pendingHashes.erase(pair.first);
+	}
+	compiled.clear();
+	hasCompiled = false;
+}
+
+void AsyncPipelineCompiler::flush()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	pipelineStats.pending -= (u32)queue.size();
+	queue.clear();
+	idle.wait(lock, [this]() { return running == 0; });
+	compiled.clear();
+	pendingHashes.clear();
+	hasCompiled = false;
+}
+
+void AsyncPipelineCompiler::term()
+{
+	flush();
+	{
+		std::lock_guard<std::mutex> _(mutex);
+		stopping = true;
+		workAvailable.notify_all();
+	}
+	for (auto& thread : workers)
+		thread.join();
+	workers.clear();
+}
+
+void AsyncPipelineCompiler::run()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true)
+	{
+		workAvailable.wait(lock, [this]() { return stopping || !queue.empty(); });
+		if (stopping)
+			break;
+		std::pair<u64, Task> work = std::move(queue.front());
+		queue.pop_front();
+		running++;
+		lock.unlock();
+
+		vk::UniquePipeline pipeline;
+		try {
+			pipeline = work.second();
+		} catch (const vk::SystemError& e) {
+			WARN_LOG(RENDERER, "Pipeline compilation failed: %s", e.what());
+		}
+
+		lock.lock();
+		running--;
+		pipelineStats.pending--;
+		if (pipeline)
+		{
+			compiled.emplace_back(work.first, std::move(pipeline));
+			hasCompiled = true;
+		}
+		else
+		{
+			pendingHashes.erase(work.first);
+		}
+		if (running == 0)
+			idle.notify_all();
+	}
+}
@@ -0,0 +1,156 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#pragma once
+#include "vulkan.h"
+#include "hw/pvr/ta_ctx.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Polygon state needed to build a pipeline without a live PolyParam.
+// Keys are recorded in a per-game manifest and compiled ahead of time on the next boot.
+struct PipelineKey
+{
+	u32 listType;
+	u32 pcw;
+	u32 isp;
+	u32 tsp;
+	u32 tcw;
+	u32 tileclip;
+	u32 tsp1;
+	u32 tcw1;
+	u8 sortTriangles;	// autosort for OIT pipelines
+	u8 pass;			// OIT pass
+	u8 gpuPalette;		// 0: none, 1: nearest, 2: bilinear
+	u8 dithering;
+	u8 naomi2;
+	u8 clamping;		// fog clamping registers in use
+	u8 padding[2];
+
+	static PipelineKey make(u32 listType, bool sortTriangles, const PolyParam& pp, int gpuPalette, bool dithering, int pass = 0);
+
+	// Same fixed-function state (blending, depth, stencil, culling, topology) with the simplest shaders.
+	// Used while the specialized pipeline is being compiled.
+	PipelineKey generic() const;
+
+	PolyParam polyParam() const;
+
+	bool operator<(const PipelineKey& other) const {
+		return memcmp(this, &other, sizeof(PipelineKey)) < 0;
+	}
+	bool operator==(const PipelineKey& other) const {
+		return memcmp(this, &other, sizeof(PipelineKey)) == 0;
+	}
+};
+static_assert(sizeof(PipelineKey) == 40, "PipelineKey must be packed");
+
+// List of the pipelines used by a game, saved in the data directory
+class PipelineManifest
+{
+public:
+	// Loads the manifest of the current game. Returns true if the game has changed since the last call.
+	bool load(const std::string& name);
+	// Adds a key to the manifest if it's new. New keys are written to the file by save().
+	void record(const PipelineKey& key);
+	// Appends the keys recorded since the last call to the file
+	void save();
+	const std::set<PipelineKey>& getKeys() const { return keys; }
+
+private:
+	bool loaded = false;
+	std::string gameId;
+	std::string path;
+	std::set<PipelineKey> keys;
+	std::vector<PipelineKey> unsaved;
+};
+
+// Render state a pipeline depends on besides its key.
+// Captured on the render thread when the pipeline is queued so that worker threads
+// don't read the settings or the pipeline manager.
+struct PipelineState
+{
+	vk::RenderPass renderPass;
+	vk::PipelineLayout layout;
+	bool perStripSorting;
+	bool divPosZ;
+	bool fog;
+
+	static PipelineState capture(vk::RenderPass renderPass, vk::PipelineLayout layout);
+};
+
+struct PipelineStats
+{
+	void newFrame()
+	{
+		lastMisses = misses.exchange(0);
+		lastCompileTime = compileTime.exchange(0);
+	}
+	std::string getOSDText() const;
+
+	// current frame
+	std::atomic<u32> misses { 0 };
+	std::atomic<u64> compileTime { 0 };	// synchronous compilation, in microseconds
+	// last frame
+	u32 lastMisses = 0;
+	u64 lastCompileTime = 0;
+	std::atomic<u32> pending { 0 };
+};
+extern PipelineStats pipelineStats;
+
+// Compiles pipelines on worker threads. Compiled pipelines are handed back to the render thread
+// by collect() so that the pipeline maps are only ever accessed by the render thread.
+class AsyncPipelineCompiler
+{
+public:
+	using Task = std::function<vk::UniquePipeline()>;
+
+	~AsyncPipelineCompiler() { term(); }
+
+	// Does nothing if a pipeline with the same hash is already queued
+	void enqueue(u64 hash, Task task);
+	// Moves the pipelines compiled so far into the given map
+	void collect(std::map<u64, vk::UniquePipeline>& pipelines);
+	// Cancels the queued tasks, waits for the running ones to complete and discards the results
+	void flush();
+	void term();
+
+private:
+	void start();
+	void run();
+
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable workAvailable;
+	std::condition_variable idle;
+	std::deque<std::pair<u64, Task>> queue;
+	std::set<u64> pendingHashes;
+	std::vector<std::pair<u64, vk::UniquePipeline>> compiled;
+	std::atomic<bool> hasCompiled { false };
+	int running = 0;
+	bool stopping = false;
+};
@@ -0,0 +1,102 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "readback.h"
+#include "vulkan_context.h"
+
+void ReadbackQueue::Read(vk::CommandBuffer commandBuffer, vk::Image image, u32 width, u32 height, const ReadbackArea& area, WriteFunc write)
+{
+	Readback readback;
+	readback.size = width * height * 4;
+	for (auto it = freeBuffers.begin(); it != freeBuffers.end(); ++it)
+	{
+		if ((*it)->bufferSize >= readback.size)
+		{
+			readback.buffer = std::move(*it);
+			freeBuffers.erase(it);
+			break;
+		}
+	}
+	if (!readback.buffer)
+		readback.buffer = std::make_unique<BufferData>(readback.size, vk::BufferUsageFlagBits::eTransferDst,
+				vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCached | vk::MemoryPropertyFlagBits::eHostCoherent);
+
+	vk::BufferImageCopy copyRegion(0, width, height, vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1), vk::Offset3D(0, 0, 0),
+			vk::Extent3D(width, height, 1));
+	commandBuffer.copyImageToBuffer(image, vk::ImageLayout::eTransferSrcOptimal, *readback.buffer->buffer, copyRegion);
+
+	vk::BufferMemoryBarrier bufferMemoryBarrier(
+			vk::AccessFlagBits::eTransferWrite,
+			vk::AccessFlagBits::eHostRead,
+			VK_QUEUE_FAMILY_IGNORED,
+			VK_QUEUE_FAMILY_IGNORED,
+			*readback.buffer->buffer,
+			0,
+			VK_WHOLE_SIZE);
+	commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer,
+					vk::PipelineStageFlagBits::eHost, {}, nullptr, bufferMemoryBarrier, nullptr);
+
+	// Signaled when the current frame of the command pool completes
+	readback.fence = commandPool->GetCurrentFence();
+	readback.poolFrame = commandPool->GetFrameCount();
+	readback.frame = frame;
+	readback.area = area;
+	readback.write = std::move(write);
+	pending.push_back(std::move(readback));
+}
+
+void ReadbackQueue::NewFrame()
+{
+	frame++;
+	// Everything is due if the latency has been reset to 0
+	const u64 latency = std::max(1, (int)config::ReadbackLatency);
+	size_t count = 0;
+	while (count < pending.size() && pending[count].frame + latency <= frame)
+		count++;
+	Complete(count);
+}
+
+void ReadbackQueue::Complete(size_t count)
+{
+	for (; count > 0; count--)
+	{
+		Readback& readback = pending.front();
+		// The fence is reset and reused once the command pool has cycled through its chain,
+		// after waiting for it.
+		if (commandPool->GetFrameCount() - readback.poolFrame < commandPool->GetChainSize())
+			VulkanContext::Instance()->GetDevice().waitForFences(readback.fence, true, UINT64_MAX);
+
+		bool written = writeReadbackArea(readback.area, [&readback]() {
+			const u8 *pixels = (const u8 *)readback.buffer->MapMemory();
+			readback.write(pixels);
+			readback.buffer->UnmapMemory();
+		});
+		if (!written)
+			DEBUG_LOG(RENDERER, "Readback dropped: vram written since the frame was rendered");
+		freeBuffers.push_back(std::move(readback.buffer));
+		pending.pop_front();
+	}
+}
+
+void ReadbackQueue::Term()
+{
+	for (const Readback& readback : pending)
+		unlockReadbackArea(readback.area);
+	pending.clear();
+	freeBuffers.clear();
+}
@@ -0,0 +1,72 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+#include "vulkan.h"
+#include "buffer.h"
+#include "commandpool.h"
+#include "rend/TexCache.h"
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+//
+// Asynchronous render-to-texture and framebuffer readbacks.
+// The image is copied to a host-visible buffer by the frame command buffer. The pixels are written to vram
+// when the frame rendered config::ReadbackLatency frames later is processed, unless the destination area
+// has been written in the meantime.
+//
+class ReadbackQueue
+{
+public:
+	using WriteFunc = std::function<void(const u8 *pixels)>;
+
+	void Init(CommandPool *commandPool) {
+		this->commandPool = commandPool;
+	}
+	bool IsEnabled() const {
+		return config::ReadbackLatency > 0;
+	}
+	// Copies the image, which must be in the transfer source layout, in RGBA8 format.
+	// write is called once the pixels are available. area is the vram area written by write.
+	void Read(vk::CommandBuffer commandBuffer, vk::Image image, u32 width, u32 height, const ReadbackArea& area, WriteFunc write);
+	// Writes the readbacks that are due to vram
+	void NewFrame();
+	// Drops the pending readbacks. The device must be idle.
+	void Term();
+
+private:
+	void Complete(size_t count);
+
+	struct Readback
+	{
+		std::unique_ptr<BufferData> buffer;
+		u32 size;
+		vk::Fence fence;
+		u64 poolFrame;
+		u64 frame;
+		ReadbackArea area;
+		WriteFunc write;
+	};
+	std::deque<Readback> pending;
+	std::vector<std::unique_ptr<BufferData>> freeBuffers;
+	CommandPool *commandPool = nullptr;
+	u64 frame = 0;
+};
@@ -89,7 +89,7 @@ layout (push_constant) uniform pushBlock
 #if pp_Texture == 1
 layout (set = 1, binding = 0) uniform sampler2D tex;
 #endif
-#if pp_Palette == 1
+#if pp_Palette != 0
 layout (set = 0, binding = 3) uniform sampler2D palette;
 #endif
 
@@ -127,19 +127,48 @@ vec4 colorClamp(vec4 col)
 #endif
 }
 
+#if pp_Palette != 0
+
+vec4 paletteEntry(float colIdx)
+{
+	vec4 c = vec4(colIdx * 255.0 / 1023.0 + pushConstants.palette_index, 0.5, 0.0, 0.0);
+	return texture(palette, c.xy);
+}
+
 #if pp_Palette == 1
 
 vec4 palettePixel(sampler2D tex, vec3 coords)
 {
 #if DIV_POS_Z == 1
-	float texIdx = texture(tex, coords.xy).r;
+	return paletteEntry(texture(tex, coords.xy).r);
 #else
-	float texIdx = textureProj(tex, coords).r;
+	return paletteEntry(textureProj(tex, coords).r);
 #endif
-	vec4 c = vec4(texIdx * 255.0 / 1023.0 + pushConstants.palette_index, 0.5, 0.0, 0.0);
-	return texture(palette, c.xy);
 }
 
+#else
+
+// Bilinear filtering of the palette colors. The index texture uses nearest filtering.
+vec4 palettePixel(sampler2D tex, vec3 coords)
+{
+#if DIV_POS_Z == 1
+	vec2 uv = coords.xy;
+#else
+	vec2 uv = coords.xy / coords.z;
+#endif
+	vec2 texSize = vec2(textureSize(tex, 0));
+	vec2 pos = uv * texSize - 0.5;
+	vec2 f = fract(pos);
+	vec2 texel = 1.0 / texSize;
+	uv = (floor(pos) + 0.5) * texel;
+	vec4 c00 = paletteEntry(texture(tex, uv).r);
+	vec4 c10 = paletteEntry(texture(tex, uv + vec2(texel.x, 0.0)).r);
+	vec4 c01 = paletteEntry(texture(tex, uv + vec2(0.0, texel.y)).r);
+	vec4 c11 = paletteEntry(texture(tex, uv + texel).r);
+	return mix(mix(c00, c10, f.x), mix(c01, c11, f.x), f.y);
+}
+
+#endif
 #endif
 
 void main()
@@ -24,6 +24,7 @@
 
 #include <glm/glm.hpp>
 #include <map>
+#include <mutex>
 
 struct VertexShaderParams
 {
@@ -49,7 +50,7 @@ struct FragmentShaderParams
 	bool bumpmap;
 	bool clamping;
 	bool trilinear;
-	bool palette;
+	int palette;		// 0: none, 1: nearest, 2: bilinear
 	bool divPosZ;
 	bool dithering;
 
@@ -59,7 +60,7 @@ struct FragmentShaderParams
 			| ((u32)texture << 3) | ((u32)ignoreTexAlpha << 4) | (shaderInstr << 5)
 			| ((u32)offset << 7) | ((u32)fog << 8) | ((u32)gouraud << 10)
 			| ((u32)bumpmap << 11) | ((u32)clamping << 12) | ((u32)trilinear << 13)
-			| ((u32)palette << 14) | ((u32)divPosZ << 15) | ((u32)dithering << 16);
+			| ((u32)palette << 14) | ((u32)divPosZ << 16) | ((u32)dithering << 17);
 	}
 };
 
@@ -179,6 +180,8 @@ private:
 	template<typename T>
 	vk::ShaderModule getShader(std::map<u32, vk::UniqueShaderModule>& map, T params)
 	{
+		// pipelines can be compiled in the background
+		std::lock_guard<std::mutex> _(mutex);
 		u32 h = params.hash();
 		auto it = map.find(h);
 		if (it != map.end())
@@ -195,6 +198,7 @@ private:
 	vk::UniqueShaderModule compileOSDVertexShader();
 	vk::UniqueShaderModule compileOSDFragmentShader();
 
+	std::mutex mutex;
 	std::map<u32, vk::UniqueShaderModule> vertexShaders;
 	std::map<u32, vk::UniqueShaderModule> fragmentShaders;
 	std::map<u32, vk::UniqueShaderModule> modVolVertexShaders;
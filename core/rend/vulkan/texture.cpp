@@ -214,7 +214,7 @@ void Texture::Init(u32 width, u32 height, vk::Format format, u32 dataSize, bool
 	vk::ImageUsageFlags usageFlags = vk::ImageUsageFlagBits::eSampled;
 	if (needsStaging)
 	{
-		stagingBufferData = std::make_unique<BufferData>(dataSize, vk::BufferUsageFlagBits::eTransferSrc);
+		// The staging buffer is allocated when uploading
 		usageFlags |= vk::ImageUsageFlagBits::eTransferDst;
 		initialLayout = vk::ImageLayout::eUndefined;
 	}
@@ -255,13 +255,28 @@ void Texture::SetImage(u32 srcSize, const void *srcData, bool isNew, bool genMip
 	if (!isNew && !needsStaging)
 		setImageLayout(commandBuffer, image.get(), format, mipmapLevels, vk::ImageLayout::eShaderReadOnlyOptimal, vk::ImageLayout::eGeneral);
 
-	void* data;
+	void* data = nullptr;
+	vk::Buffer stagingBuffer;
+	vk::DeviceSize stagingOffset = 0;
+	bool ringStaging = false;
 	if (needsStaging)
 	{
-		if (!stagingBufferData)
-			// This can happen if a texture is first created for RTT, then later updated
-			stagingBufferData = std::make_unique<BufferData>(srcSize, vk::BufferUsageFlagBits::eTransferSrc);
-		data = stagingBufferData->MapMemory();
+		if (stagingRing != nullptr)
+		{
+			data = stagingRing->Allocate(srcSize, stagingOffset);
+			ringStaging = data != nullptr;
+		}
+		if (ringStaging)
+		{
+			stagingBuffer = stagingRing->GetBuffer();
+		}
+		else
+		{
+			if (!stagingBufferData || stagingBufferData->bufferSize < srcSize)
+				stagingBufferData = std::make_unique<BufferData>(srcSize, vk::BufferUsageFlagBits::eTransferSrc);
+			data = stagingBufferData->MapMemory();
+			stagingBuffer = *stagingBufferData->buffer;
+		}
 	}
 	else
 		data = allocation.MapMemory();
@@ -305,28 +320,29 @@ void Texture::SetImage(u32 srcSize, const void *srcData, bool isNew, bool genMip
 
 	if (needsStaging)
 	{
-		stagingBufferData->UnmapMemory();
+		if (!ringStaging)
+			stagingBufferData->UnmapMemory();
 		// Since we're going to blit to the texture image, set its layout to eTransferDstOptimal
 		setImageLayout(commandBuffer, image.get(), format, mipmapLevels, isNew ? vk::ImageLayout::eUndefined : vk::ImageLayout::eShaderReadOnlyOptimal,
 				vk::ImageLayout::eTransferDstOptimal);
 
 		if (mipmapLevels > 1 && !genMipmaps)
 		{
-			vk::DeviceSize bufferOffset = 0;
+			vk::DeviceSize bufferOffset = stagingOffset;
 			for (u32 i = 0; i < mipmapLevels; i++)
 			{
 				vk::BufferImageCopy copyRegion(bufferOffset, 1 << i, 1 << i, vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, mipmapLevels - i - 1, 0, 1),
 						vk::Offset3D(0, 0, 0), vk::Extent3D(1 << i, 1 << i, 1));
-				commandBuffer.copyBufferToImage(stagingBufferData->buffer.get(), image.get(), vk::ImageLayout::eTransferDstOptimal, copyRegion);
+				commandBuffer.copyBufferToImage(stagingBuffer, image.get(), vk::ImageLayout::eTransferDstOptimal, copyRegion);
 				const u32 size = (1 << (2 * i)) * (tex_type == TextureType::_8888 ? 4 : 2);
 				bufferOffset += ((size + 3) >> 2) << 2;
 			}
 		}
 		else
 		{
-			vk::BufferImageCopy copyRegion(0, extent.width, extent.height, vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1),
+			vk::BufferImageCopy copyRegion(stagingOffset, extent.width, extent.height, vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1),
 					vk::Offset3D(0, 0, 0), vk::Extent3D(extent, 1));
-			commandBuffer.copyBufferToImage(stagingBufferData->buffer.get(), image.get(), vk::ImageLayout::eTransferDstOptimal, copyRegion);
+			commandBuffer.copyBufferToImage(stagingBuffer, image.get(), vk::ImageLayout::eTransferDstOptimal, copyRegion);
 			if (mipmapLevels > 1)
 				GenerateMipmaps();
 		}
@@ -435,22 +451,5 @@ void FramebufferAttachment::Init(u32 width, u32 height, vk::Format format, const
 
 void TextureCache::Cleanup()
 {
-	std::vector<u64> list;
-
-	u32 TargetFrame = std::max((u32)120, FrameCount) - 120;
-
-	for (const auto& [id, texture] : cache)
-	{
-		if (texture.dirty && texture.dirty < TargetFrame)
-			list.push_back(id);
-
-		if (list.size() > 5)
-			break;
-	}
-
-	for (u64 id : list)
-	{
-		if (clearTexture(&cache[id]))
-			cache.erase(id);
-	}
+	CollectCleanup([this](Texture *texture) { return clearTexture(texture); });
 }
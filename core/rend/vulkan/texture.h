@@ -47,6 +47,7 @@ public:
 		std::swap(needsStaging, other.needsStaging);
 		std::swap(stagingBufferData, other.stagingBufferData);
 		std::swap(commandBuffer, other.commandBuffer);
+		std::swap(stagingRing, other.stagingRing);
 		std::swap(allocation, other.allocation);
 		std::swap(image, other.image);
 		std::swap(imageView, other.imageView);
@@ -61,7 +62,12 @@ public:
 	vk::ImageView GetImageView() const { return *imageView; }
 	vk::Image GetImage() const { return *image; }
 	vk::ImageView GetReadOnlyImageView() const { return readOnlyImageView ? readOnlyImageView : *imageView; }
-	void SetCommandBuffer(vk::CommandBuffer commandBuffer) { this->commandBuffer = commandBuffer; }
+	// Uploads use the staging ring if any, or a staging buffer owned by the texture.
+	// The ring must be recycled with the command buffer's pool.
+	void SetCommandBuffer(vk::CommandBuffer commandBuffer, StagingRing *stagingRing = nullptr) {
+		this->commandBuffer = commandBuffer;
+		this->stagingRing = stagingRing;
+	}
 	bool Force32BitTexture(TextureType type) const override { return !VulkanContext::Instance()->IsFormatSupported(type); }
 	vk::Extent2D getSize() const { return extent; }
 
@@ -78,6 +84,7 @@ private:
 	bool needsStaging = false;
 	std::unique_ptr<BufferData> stagingBufferData;
 	vk::CommandBuffer commandBuffer;
+	StagingRing *stagingRing = nullptr;
 
 	Allocation allocation;
 	vk::UniqueImage image;
@@ -99,14 +106,17 @@ public:
 		samplers.clear();
 	}
 
-	vk::Sampler GetSampler(TSP tsp, bool punchThrough = false)
+	// Palette index textures (gpuPalette) are always sampled with nearest filtering
+	vk::Sampler GetSampler(TSP tsp, bool punchThrough = false, bool gpuPalette = false)
 	{
-		const u32 samplerHash = (tsp.full & TSP_Mask) | punchThrough;	// MipMapD, FilterMode, ClampU, ClampV, FlipU, FlipV
+		const u32 samplerHash = (tsp.full & TSP_Mask) | punchThrough | ((u32)gpuPalette << 1);	// MipMapD, FilterMode, ClampU, ClampV, FlipU, FlipV
 		const auto& it = samplers.find(samplerHash);
 		if (it != samplers.end())
 			return it->second.get();
 		vk::Filter filter;
-		if (config::TextureFiltering == 0) {
+		if (gpuPalette) {
+			filter = vk::Filter::eNearest;
+		} else if (config::TextureFiltering == 0) {
 			filter = tsp.FilterMode == 0 ? vk::Filter::eNearest : vk::Filter::eLinear;
 		} else if (config::TextureFiltering == 1) {
 			filter = vk::Filter::eNearest;
@@ -175,6 +185,7 @@ class TextureCache final : public BaseTextureCache<Texture>
 public:
 	TextureCache() {
 		Texture::SetDirectXColorOrder(false);
+		Texture::SetGpuPaletteFiltering(true);
 	}
 	void SetCurrentIndex(int index) {
 		if (currentIndex < inFlightTextures.size())
@@ -71,6 +71,14 @@ public:
 			vmaInvalidateAllocation(allocator, allocation, allocInfo.offset, allocInfo.size);
 		return p;
 	}
+	// Makes the host writes to a mapped range visible to the device
+	void FlushMemory(VkDeviceSize offset, VkDeviceSize size) const
+	{
+		VkMemoryPropertyFlags flags;
+		vmaGetMemoryTypeProperties(allocator, allocInfo.memoryType, &flags);
+		if ((flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) == 0)
+			vmaFlushAllocation(allocator, allocation, offset, size);
+	}
 	void UnmapMemory() const
 	{
 		if (allocInfo.pMappedData != nullptr)
@@ -31,9 +31,11 @@ public:
 
 		textureDrawer.Init(&samplerManager, &shaderManager, &textureCache);
 		textureDrawer.SetCommandPool(&texCommandPool);
+		textureDrawer.SetReadbackQueue(&readbackQueue);
 
 		screenDrawer.Init(&samplerManager, &shaderManager, viewport);
 		screenDrawer.SetCommandPool(&texCommandPool);
+		screenDrawer.SetReadbackQueue(&readbackQueue);
 		BaseInit(screenDrawer.GetRenderPass());
 		emulateFramebuffer = config::EmulateFramebuffer;
 
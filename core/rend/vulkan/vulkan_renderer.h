@@ -21,6 +21,7 @@
 #include "hw/pvr/ta.h"
 #include "commandpool.h"
 #include "pipeline.h"
+#include "readback.h"
 #include "rend/osd.h"
 #include "rend/transform_matrix.h"
 #ifndef LIBRETRO
@@ -37,6 +38,9 @@ protected:
 	{
 		texCommandPool.Init();
 		fbCommandPool.Init();
+		// One region per frame in flight of the texture command buffers
+		stagingRing.Init(texCommandPool.GetChainSize(), 32_MB);
+		readbackQueue.Init(&texCommandPool);
 
 #if defined(__ANDROID__) && !defined(LIBRETRO)
 		if (!vjoyTexture)
@@ -83,8 +87,10 @@ public:
 		textureCache.Clear();
 		fogTexture = nullptr;
 		paletteTexture = nullptr;
+		readbackQueue.Term();
 		texCommandPool.Term();
 		fbCommandPool.Term();
+		stagingRing.Term();
 		framebufferTextures.clear();
 		framebufferTexIndex = 0;
 		shaderManager.term();
@@ -92,7 +98,11 @@ public:
 
 	BaseTextureCacheData *GetTexture(TSP tsp, TCW tcw) override
 	{
-		Texture* tf = textureCache.getTextureCacheData(tsp, tcw);
+		// Already marked in flight if memoized in the current frame
+		Texture* tf = textureCache.getMemoizedTexture(tsp, tcw);
+		if (tf != nullptr)
+			return tf;
+		tf = textureCache.getTextureCacheData(tsp, tcw);
 
 		//update if needed
 		if (tf->NeedsUpdate())
@@ -100,7 +110,7 @@ public:
 			// This kills performance when a frame is skipped and lots of texture updated each frame
 			//if (textureCache.IsInFlight(tf))
 			//	textureCache.DestroyLater(tf);
-			tf->SetCommandBuffer(texCommandBuffer);
+			tf->SetCommandBuffer(texCommandBuffer, &stagingRing);
 			if (!tf->Update())
 			{
 				tf->SetCommandBuffer(nullptr);
@@ -110,21 +120,26 @@ public:
 		else if (tf->IsCustomTextureAvailable())
 		{
 			textureCache.DestroyLater(tf);
-			tf->SetCommandBuffer(texCommandBuffer);
+			tf->SetCommandBuffer(texCommandBuffer, &stagingRing);
 			tf->CheckCustomTexture();
 		}
 		tf->SetCommandBuffer(nullptr);
 		textureCache.SetInFlight(tf);
+		textureCache.memoizeTexture(tsp, tcw, tf);
 
 		return tf;
 	}
 
 	void Process(TA_context* ctx) override
 	{
+		pipelineStats.newFrame();
+		// Write the due readbacks before their textures are used
+		readbackQueue.NewFrame();
 		if (KillTex)
 			textureCache.Clear();
 
 		texCommandPool.BeginFrame();
+		stagingRing.BeginFrame(texCommandPool.GetIndex());
 		textureCache.SetCurrentIndex(texCommandPool.GetIndex());
 		textureCache.Cleanup();
 
@@ -135,13 +150,23 @@ public:
 
 		CheckFogTexture();
 		CheckPaletteTexture();
+		stagingRing.Flush();
 		texCommandBuffer.end();
 	}
 
+	std::string GetOSDStats() override
+	{
+		std::string stats = pipelineStats.getOSDText();
+		if (stagingRing.lastFrameBytes != 0)
+			stats += " S:" + std::to_string(stagingRing.lastFrameBytes / 1024) + "KB";
+		return stats;
+	}
+
 	void ReInitOSD()
 	{
 		texCommandPool.Init();
 		fbCommandPool.Init();
+		stagingRing.Init(texCommandPool.GetChainSize(), 32_MB);
 #if defined(__ANDROID__) && !defined(LIBRETRO)
 		osdPipeline.Init(&shaderManager, vjoyTexture->GetImageView(), GetContext()->GetRenderPass());
 #endif
@@ -276,7 +301,7 @@ protected:
 		fog_needs_update = false;
 		u8 texData[256];
 		MakeFogTexture(texData);
-		fogTexture->SetCommandBuffer(texCommandBuffer);
+		fogTexture->SetCommandBuffer(texCommandBuffer, &stagingRing);
 
 		fogTexture->UploadToGPU(128, 2, texData, false);
 
@@ -295,7 +320,7 @@ protected:
 			return;
 		palette_updated = false;
 
-		paletteTexture->SetCommandBuffer(texCommandBuffer);
+		paletteTexture->SetCommandBuffer(texCommandBuffer, &stagingRing);
 
 		paletteTexture->UploadToGPU(1024, 1, (u8 *)palette32_ram, false);
 
@@ -319,6 +344,9 @@ protected:
 	std::unique_ptr<Texture> fogTexture;
 	std::unique_ptr<Texture> paletteTexture;
 	CommandPool texCommandPool;
+	// Staging memory of texCommandPool uploads
+	StagingRing stagingRing;
+	ReadbackQueue readbackQueue;
 	std::vector<std::unique_ptr<Texture>> framebufferTextures;
 	int framebufferTexIndex = 0;
 	OSDPipeline osdPipeline;
@@ -292,4 +292,19 @@ void flush_cache(void *icache_start, void *icache_end, void *dcache_start, void
 }
 #endif
 
+bool renew_shared_memory(void *start, size_t size) {
+	return false;
+}
+
+bool dirty_tracking_init() {
+	return false;
+}
+bool dirty_tracking_start(void *start, size_t len) {
+	return false;
+}
+void dirty_tracking_stop(void *start, size_t len) {
+}
+void dirty_tracking_query(void *start, size_t len, u64 *dirty) {
+}
+
 }	// namespace virtmem
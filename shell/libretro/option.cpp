@@ -24,6 +24,8 @@ namespace config {
 // Dynarec
 
 Option<bool> DynarecEnabled("", true);
+Option<bool> DynarecIdleSkip("", true);
+Option<bool> DynarecPerfMap("");
 IntOption Sh4Clock(CORE_OPTION_NAME "_sh4clock", 200);
 
 // General
@@ -59,10 +61,12 @@ Option<bool> Widescreen(CORE_OPTION_NAME "_widescreen_hack");
 Option<bool> SuperWidescreen("");
 Option<bool> ShowFPS("");
 Option<bool> RenderToTextureBuffer(CORE_OPTION_NAME "_enable_rttb");
+Option<int> ReadbackLatency("", 0);
 Option<bool> TranslucentPolygonDepthMask("");
 Option<bool> ModifierVolumes(CORE_OPTION_NAME "_volume_modifier_enable", true);
 IntOption TextureUpscale(CORE_OPTION_NAME "_texupscale", 1);
 IntOption MaxFilteredTextureSize(CORE_OPTION_NAME "_texupscale_max_filtered_texture_size", 256);
+Option<int> TextureCacheBudget("", 1024);
 Option<float> ExtraDepthScale("", 1.f);
 Option<bool> CustomTextures(CORE_OPTION_NAME "_custom_textures");
 Option<bool> DumpTextures(CORE_OPTION_NAME "_dump_textures");
@@ -92,6 +96,8 @@ Option<int64_t> PixelBufferSize("", 512_MB);
 IntOption PerPixelLayers(CORE_OPTION_NAME "_oit_layers");
 Option<bool> NativeDepthInterpolation(CORE_OPTION_NAME "_native_depth_interpolation");
 Option<bool> EmulateFramebuffer(CORE_OPTION_NAME "_emulate_framebuffer", false);
+Option<bool> AsyncPipelines("", false);
+Option<bool> BulkVramTracking("", false);
 
 // Misc
 
@@ -0,0 +1,92 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "gtest/gtest.h"
+#include "types.h"
+#include "hw/mem/addrspace.h"
+#include "hw/arm7/arm7.h"
+#include "hw/aica/aica_if.h"
+#include "hw/arm7/arm7_rec.h"
+#include "emulator.h"
+#include <chrono>
+
+namespace aica::arm::recompiler {
+
+extern void (*EntryPoints[])();
+
+// Measures the throughput of the ARM7 recompiler on a small sound driver-like program
+class AicaArmBenchmark : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		if (!addrspace::reserve())
+			die("addrspace::reserve failed");
+		emu.init();
+		dc_reset(true);
+		Arm7Enabled = true;
+	}
+
+	static u32 branch(u32 opcode, u32 pc, u32 target) {
+		return opcode | (((target - pc - 8) >> 2) & 0xffffff);
+	}
+};
+
+// Benchmark, run with --gtest_also_run_disabled_tests
+TEST_F(AicaArmBenchmark, DISABLED_CyclesPerSecond)
+{
+	const u32 program[] {
+		0xe3a00000,							// 1000: mov r0, #0
+		branch(0xeb000000, 0x1004, 0x1100),	// 1004: bl 1100
+		0xe2800001,							// 1008: add r0, r0, #1
+		0xe3500c01,							// 100c: cmp r0, #0x100
+		branch(0x1a000000, 0x1010, 0x1004),	// 1010: bne 1004
+		branch(0xea000000, 0x1014, 0x1000),	// 1014: b 1000
+	};
+	const u32 subroutine[] {
+		0xe0811000,							// 1100: add r1, r1, r0
+		branch(0xea000000, 0x1104, 0x110c),	// 1104: b 110c
+		0xe3a01000,							// 1108: mov r1, #0
+		0xe0222001,							// 110c: eor r2, r2, r1
+		0xe1a0f00e,							// 1110: mov pc, lr
+	};
+	memcpy(&aica_ram[0x1000], program, sizeof(program));
+	memcpy(&aica_ram[0x1100], subroutine, sizeof(subroutine));
+	arm_Reg[R15_ARM_NEXT].I = 0x1000;
+	arm_Reg[INTR_PEND].I = 0;
+	arm_Reg[CYCL_CNT].I = 0;
+	flush();
+
+	// 10 seconds of emulated time
+	const u32 samples = 441000;
+	auto start = std::chrono::steady_clock::now();
+	for (u32 i = 0; i < samples; i++)
+	{
+		arm_Reg[CYCL_CNT].I += ARM_CYCLES_PER_SAMPLE;
+		arm_mainloop(arm_Reg, EntryPoints);
+	}
+	std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+
+	ASSERT_LE(arm_Reg[0].I, 0x100u);
+	ASSERT_GE(arm_Reg[R15_ARM_NEXT].I, 0x1000u);
+	ASSERT_LE(arm_Reg[R15_ARM_NEXT].I, 0x1110u);
+	printf("ARM7 recompiler: %.1f M cycles/s (%.1fx real time)\n",
+			(double)samples * ARM_CYCLES_PER_SAMPLE / duration.count() / 1e6,
+			samples / 44100.0 / duration.count());
+}
+
+}
@@ -957,6 +957,8 @@ TEST_F(AicaArmTest, ConditionalTest)
 
 TEST_F(AicaArmTest, JumpTest)
 {
+	// unconditional branches are followed by the compiler: end the block at the target
+	*(u32*)&aica_ram[0x1100] = 0xeafffffe;	// b .
 	PrepareOp(0xea00003e);	// b +248
 	RunOp();
 	ASSERT_EQ(arm_Reg[R15_ARM_NEXT].I, 0x1100);
@@ -0,0 +1,111 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "gtest/gtest.h"
+#include "types.h"
+#include "oslib/audiostream.h"
+#include "oslib/resampler.h"
+#include <cmath>
+
+static std::vector<s16> sine(u32 frames, float frequency, float amplitude)
+{
+	const double pi = std::acos(-1.0);
+	std::vector<s16> samples(frames * 2);
+	for (u32 i = 0; i < frames; i++)
+	{
+		samples[i * 2] = (s16)std::round(amplitude * std::sin(2 * pi * frequency * i / 44100.0));
+		samples[i * 2 + 1] = -samples[i * 2];
+	}
+	return samples;
+}
+
+TEST(AudioStreamTest, ResamplerDC)
+{
+	Resampler resampler;
+	std::vector<s16> input(1024 * 2, 10000);
+	std::vector<s16> output(1024 * 2);
+	resampler.setRatio(1.003);
+	resampler.write(input.data(), 1024);
+	u32 produced = resampler.read(output.data(), 1024);
+	ASSERT_GT(produced, 1000u);
+	// skip the initial transient
+	for (u32 i = Resampler::TAPS; i < produced * 2; i++)
+		ASSERT_NEAR(10000, output[i], 1) << "sample " << i;
+}
+
+TEST(AudioStreamTest, ResamplerRatio)
+{
+	Resampler resampler;
+	const u32 inFrames = 512 * 86;
+	std::vector<s16> input = sine(inFrames, 1000.f, 16000.f);
+	std::vector<s16> output(inFrames * 2 * 2);
+	resampler.setRatio(0.995);
+	u32 produced = 0;
+	for (u32 i = 0; i < inFrames; i += 512)
+	{
+		resampler.write(&input[i * 2], 512);
+		produced += resampler.read(&output[produced * 2], 1024);
+	}
+	ASSERT_NEAR(inFrames / 0.995, produced, Resampler::TAPS);
+
+	// peak amplitude is preserved
+	s16 peak = 0;
+	for (u32 i = 1000; i < produced; i++)
+	{
+		peak = std::max<s16>(peak, output[i * 2]);
+		ASSERT_EQ(output[i * 2], -output[i * 2 + 1]);
+	}
+	ASSERT_NEAR(16000, peak, 160);
+}
+
+TEST(AudioStreamTest, InputNeeded)
+{
+	Resampler resampler;
+	resampler.setRatio(1.005);
+	std::vector<s16> input(2048 * 2);
+	std::vector<s16> output(512 * 2);
+	for (int i = 0; i < 20; i++)
+	{
+		u32 needed = resampler.inputNeeded(512);
+		resampler.write(input.data(), needed);
+		ASSERT_EQ(512u, resampler.read(output.data(), 512));
+		ASSERT_EQ(0u, resampler.inputNeeded(0));
+	}
+}
+
+TEST(AudioStreamTest, NullBackend)
+{
+	AudioBackend *backend = AudioBackend::getBackend("null");
+	ASSERT_NE(nullptr, backend);
+	ASSERT_TRUE(backend->init());
+	AudioStream stream;
+	const u32 target = 44100 * 40 / 1000;
+	stream.start(backend, target);
+	// about 300 ms of audio
+	std::vector<s16> samples = sine(SAMPLE_COUNT, 440.f, 8000.f);
+	for (int i = 0; i < 26; i++)
+		stream.write(samples.data(), SAMPLE_COUNT, true);
+	AudioStats stats = stream.getStats();
+	stream.stop();
+	backend->term();
+
+	ASSERT_EQ(0u, stats.overruns);
+	ASSERT_LE(stats.fifoDepth, target * 2 + SAMPLE_COUNT);
+	ASSERT_GT(stats.latency, 0.f);
+	ASSERT_NEAR(1.f, stats.ratio, 0.0051f);
+}
@@ -0,0 +1,121 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "gtest/gtest.h"
+#include "types.h"
+#include "hw/pvr/elan_batch.h"
+#include "hw/pvr/ta_structs.h"
+#include "hw/pvr/elan_struct.h"
+#include <glm/gtc/matrix_transform.hpp>
+#include <cmath>
+#include <random>
+
+class ElanBatchTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		modelMatrix = glm::translate(glm::mat4(1), glm::vec3(1.5f, -2.f, -10.f));
+		modelMatrix = glm::rotate(modelMatrix, 0.7f, glm::vec3(0.3f, 1.f, 0.2f));
+	}
+
+	template<typename T>
+	void compare(const std::vector<T>& vertices, u32 count)
+	{
+		elan::VertexBatch batch;
+		elan::VertexBatch reference;
+		batch.process(vertices.data(), count, modelMatrix, nearPlane);
+		reference.processScalar(&vertices.data()->x, sizeof(T), count, modelMatrix, nearPlane);
+
+		for (int i = 0; i < 3; i++)
+		{
+			ASSERT_EQ(reference.getMin()[i], batch.getMin()[i]);
+			ASSERT_EQ(reference.getMax()[i], batch.getMax()[i]);
+		}
+		ASSERT_EQ(reference.isBehindNearPlane(), batch.isBehindNearPlane());
+		for (u32 i = 0; i < count; i++)
+		{
+			if (std::isnan(reference.getNearDistance(i)))
+				ASSERT_TRUE(std::isnan(batch.getNearDistance(i))) << "vertex " << i;
+			else
+				// the compiler may contract the scalar code into fused multiply-adds
+				ASSERT_FLOAT_EQ(reference.getNearDistance(i), batch.getNearDistance(i)) << "vertex " << i;
+		}
+	}
+
+	glm::mat4 modelMatrix;
+	const float nearPlane = 0.001f;
+};
+
+TEST_F(ElanBatchTest, Empty)
+{
+	elan::VertexBatch batch;
+	std::vector<elan::N2_VERTEX> vertices(1);
+	batch.process(vertices.data(), 0, modelMatrix, nearPlane);
+	ASSERT_EQ(1e38f, batch.getMin().x);
+	ASSERT_EQ(-1e38f, batch.getMax().z);
+	ASSERT_FALSE(batch.isBehindNearPlane());
+}
+
+TEST_F(ElanBatchTest, RandomVertices)
+{
+	std::mt19937 gen(42);
+	std::uniform_real_distribution<float> dist(-20.f, 20.f);
+	std::vector<elan::N2_VERTEX_VUR> vertices(67);
+	for (auto& v : vertices)
+	{
+		v.x = dist(gen);
+		v.y = dist(gen);
+		v.z = dist(gen);
+	}
+	for (u32 count = 0; count <= vertices.size(); count++)
+		compare(vertices, count);
+}
+
+TEST_F(ElanBatchTest, InFront)
+{
+	std::vector<elan::N2_VERTEX> vertices(9);
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		vertices[i].x = (float)i;
+		vertices[i].y = -(float)i;
+		vertices[i].z = -1.f;
+	}
+	compare(vertices, vertices.size());
+	elan::VertexBatch batch;
+	batch.process(vertices.data(), vertices.size(), glm::mat4(1), nearPlane);
+	ASSERT_FALSE(batch.isBehindNearPlane());
+	ASSERT_EQ(8.f, batch.getMax().x);
+	ASSERT_EQ(-8.f, batch.getMin().y);
+
+	// last vertex (not part of a group of 4) behind the near plane
+	vertices.back().z = 1.f;
+	batch.process(vertices.data(), vertices.size(), glm::mat4(1), nearPlane);
+	ASSERT_TRUE(batch.isBehindNearPlane());
+}
+
+TEST_F(ElanBatchTest, NaN)
+{
+	std::vector<elan::N2_VERTEX> vertices(8);
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		vertices[i].x = (float)i;
+		vertices[i].y = i == 2 ? std::nanf("") : (float)i;
+		vertices[i].z = -(float)i;
+	}
+	compare(vertices, vertices.size());
+}
@@ -0,0 +1,230 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "gtest/gtest.h"
+#include "types.h"
+#include "rend/TexCache.h"
+#include "rend/fb_convert.h"
+#include <chrono>
+#include <random>
+
+class FramebufferConvertTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		std::mt19937 gen(42);
+		std::uniform_int_distribution<int> dist(0, 255);
+		pixels.resize(PixelCount * 4);
+		for (u32 i = 0; i < PixelCount; i++)
+		{
+			if (i < 256)
+			{
+				// every value of every component
+				pixels[i * 4] = i;
+				pixels[i * 4 + 1] = i * 7;
+				pixels[i * 4 + 2] = i * 13;
+				pixels[i * 4 + 3] = i * 29;
+			}
+			else
+			{
+				for (int c = 0; c < 4; c++)
+					pixels[i * 4 + c] = dist(gen);
+			}
+		}
+		// every 16-bit value followed by random bytes
+		framebuffer.resize(65536 * 2 + 4096);
+		for (u32 i = 0; i < 65536; i++)
+			*(u16 *)&framebuffer[i * 2] = i;
+		for (u32 i = 65536 * 2; i < framebuffer.size(); i++)
+			framebuffer[i] = dist(gen);
+	}
+
+	template<int Red, int Green, int Blue, int Alpha, bool Round>
+	void comparePack(FB_W_CTRL_type fb_w_ctrl, u32 offset, u32 count)
+	{
+		std::vector<u8> ref(count * 4 + 16, 0xcd);
+		std::vector<u8> out(count * 4 + 16, 0xcd);
+		const u8 *src = &pixels[offset * 4];
+		u32 refCount = fbconv::packScalar<Red, Green, Blue, Alpha, Round>(src, ref.data(), count, fb_w_ctrl);
+		u32 outCount = fbconv::pack<Red, Green, Blue, Alpha, Round>(src, out.data(), count, fb_w_ctrl);
+		ASSERT_EQ(refCount, outCount) << "packmode " << fb_w_ctrl.fb_packmode << " count " << count;
+		for (size_t i = 0; i < ref.size(); i++)
+			ASSERT_EQ(ref[i], out[i]) << "packmode " << fb_w_ctrl.fb_packmode << " offset " << offset << " count " << count << " byte " << i;
+	}
+
+	template<int Red, int Green, int Blue, int Alpha, bool Round>
+	void comparePack(FB_W_CTRL_type fb_w_ctrl)
+	{
+		for (u32 count = 0; count <= 40; count++)
+			comparePack<Red, Green, Blue, Alpha, Round>(fb_w_ctrl, count & 3, count);
+		comparePack<Red, Green, Blue, Alpha, Round>(fb_w_ctrl, 0, PixelCount);
+		comparePack<Red, Green, Blue, Alpha, Round>(fb_w_ctrl, 1, PixelCount - 1);
+	}
+
+	template<int Red, int Green, int Blue, int Alpha, bool Round>
+	void comparePackModes()
+	{
+		FB_W_CTRL_type fb_w_ctrl{};
+		for (u32 packmode = 0; packmode <= 6; packmode++)
+		{
+			fb_w_ctrl.fb_packmode = packmode;
+			for (u32 kval : { 0x00, 0x7f, 0x80, 0xff })
+			{
+				fb_w_ctrl.fb_kval = kval;
+				comparePack<Red, Green, Blue, Alpha, Round>(fb_w_ctrl);
+			}
+		}
+		fb_w_ctrl.fb_packmode = 3;
+		for (u32 threshold = 0; threshold < 256; threshold++)
+		{
+			fb_w_ctrl.fb_alpha_threshold = threshold;
+			comparePack<Red, Green, Blue, Alpha, Round>(fb_w_ctrl, 0, 256);
+		}
+	}
+
+	template<typename Packer>
+	void compareUnpack(FB_R_CTRL_type fb_r_ctrl, u32 offset, u32 count)
+	{
+		std::vector<u32> ref(count + 4, 0xcdcdcdcd);
+		std::vector<u32> out(count + 4, 0xcdcdcdcd);
+		const u8 *src = &framebuffer[offset];
+		fbconv::unpackScalar<Packer>(src, ref.data(), count, fb_r_ctrl);
+		fbconv::unpack<Packer>(src, out.data(), count, fb_r_ctrl);
+		for (size_t i = 0; i < ref.size(); i++)
+			ASSERT_EQ(ref[i], out[i]) << "fb_depth " << fb_r_ctrl.fb_depth << " offset " << offset << " count " << count << " pixel " << i;
+	}
+
+	template<typename Packer>
+	void compareUnpack()
+	{
+		FB_R_CTRL_type fb_r_ctrl{};
+		for (u32 depth = 0; depth < 4; depth++)
+		{
+			fb_r_ctrl.fb_depth = depth;
+			const u32 bpp = depth == fbde_888 ? 3 : depth == fbde_C888 ? 4 : 2;
+			for (u32 concat = 0; concat < 8; concat++)
+			{
+				fb_r_ctrl.fb_concat = concat;
+				for (u32 count = 0; count <= 40; count++)
+					compareUnpack<Packer>(fb_r_ctrl, (count & 3) * 4, count);
+				compareUnpack<Packer>(fb_r_ctrl, 0, (framebuffer.size() - 16) / bpp);
+			}
+		}
+	}
+
+	template<typename F>
+	static double megapixelsPerSecond(F f)
+	{
+		constexpr int Frames = 50;
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < Frames; i++)
+			f();
+		auto end = std::chrono::steady_clock::now();
+		return 640.0 * 480.0 * Frames / std::chrono::duration<double, std::micro>(end - start).count();
+	}
+
+	void benchmarkPack(const char *name, u32 packmode)
+	{
+		std::vector<u8> src(640 * 480 * 4);
+		std::vector<u8> dst(640 * 480 * 4);
+		for (size_t i = 0; i < src.size(); i++)
+			src[i] = pixels[i % pixels.size()];
+		FB_W_CTRL_type fb_w_ctrl{};
+		fb_w_ctrl.fb_packmode = packmode;
+		double scalar = megapixelsPerSecond([&]() {
+			for (u32 y = 0; y < 480; y++)
+				fbconv::packScalar<0, 1, 2, 3, true>(&src[y * 640 * 4], &dst[y * 640 * 4], 640, fb_w_ctrl);
+		});
+		double vector = megapixelsPerSecond([&]() {
+			for (u32 y = 0; y < 480; y++)
+				fbconv::pack<0, 1, 2, 3, true>(&src[y * 640 * 4], &dst[y * 640 * 4], 640, fb_w_ctrl);
+		});
+		printf("write %-5s scalar %7.1f MP/s  vector %7.1f MP/s\n", name, scalar, vector);
+	}
+
+	void benchmarkUnpack(const char *name, u32 depth)
+	{
+		std::vector<u32> dst(640 * 480);
+		FB_R_CTRL_type fb_r_ctrl{};
+		fb_r_ctrl.fb_depth = depth;
+		double scalar = megapixelsPerSecond([&]() {
+			for (u32 y = 0; y < 480; y++)
+				fbconv::unpackScalar<RGBAPacker>(&framebuffer[(y & 31) * 640 * 4], &dst[y * 640], 640, fb_r_ctrl);
+		});
+		double vector = megapixelsPerSecond([&]() {
+			for (u32 y = 0; y < 480; y++)
+				fbconv::unpack<RGBAPacker>(&framebuffer[(y & 31) * 640 * 4], &dst[y * 640], 640, fb_r_ctrl);
+		});
+		printf("read  %-5s scalar %7.1f MP/s  vector %7.1f MP/s\n", name, scalar, vector);
+	}
+
+	static constexpr u32 PixelCount = 1027;
+	std::vector<u8> pixels;
+	std::vector<u8> framebuffer;
+};
+
+TEST_F(FramebufferConvertTest, PackRGBA)
+{
+	comparePackModes<0, 1, 2, 3, false>();
+	comparePackModes<0, 1, 2, 3, true>();
+}
+
+TEST_F(FramebufferConvertTest, PackBGRA)
+{
+	comparePackModes<2, 1, 0, 3, false>();
+	comparePackModes<2, 1, 0, 3, true>();
+}
+
+TEST_F(FramebufferConvertTest, Unpack)
+{
+	compareUnpack<RGBAPacker>();
+	compareUnpack<BGRAPacker>();
+}
+
+TEST_F(FramebufferConvertTest, Rounding)
+{
+	FB_W_CTRL_type fb_w_ctrl{};
+	fb_w_ctrl.fb_packmode = 1;	// 565
+	const u8 src[8 * 4] {
+		0xff, 0xff, 0xff, 0xff,		// saturated
+		0x04, 0x02, 0x03, 0,		// rounded up
+		0x03, 0x01, 0x04, 0,		// rounded down / up
+	};
+	u16 dst[8];
+	fbconv::pack<0, 1, 2, 3, true>(src, (u8 *)dst, 8, fb_w_ctrl);
+	ASSERT_EQ(0xffff, dst[0]);
+	ASSERT_EQ((1 << 11) | (1 << 5) | 0, dst[1]);
+	ASSERT_EQ((0 << 11) | (0 << 5) | 1, dst[2]);
+	fbconv::pack<0, 1, 2, 3, false>(src, (u8 *)dst, 8, fb_w_ctrl);
+	ASSERT_EQ(0xffff, dst[0]);
+	ASSERT_EQ(0, dst[1]);
+}
+
+// Benchmark, run with --gtest_also_run_disabled_tests
+TEST_F(FramebufferConvertTest, DISABLED_Benchmark)
+{
+	benchmarkPack("0555", 0);
+	benchmarkPack("565", 1);
+	benchmarkPack("1555", 3);
+	benchmarkPack("888", 4);
+	benchmarkPack("8888", 6);
+	benchmarkUnpack("0555", fbde_0555);
+	benchmarkUnpack("565", fbde_565);
+	benchmarkUnpack("888", fbde_888);
+	benchmarkUnpack("C888", fbde_C888);
+}
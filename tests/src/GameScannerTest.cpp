@@ -0,0 +1,154 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "gtest/gtest.h"
+#include "types.h"
+#include "rend/game_scanner.h"
+#include "oslib/directory.h"
+#include <chrono>
+#ifdef _MSC_VER
+#include <direct.h>
+#include <sys/utime.h>
+#define rmdir _rmdir
+#else
+#include <utime.h>
+#endif
+
+// Synthetic content tree: 10 folders of 10 sub-folders with 100 files each
+class GameScannerTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		flycast::mkdir(root.c_str(), 0755);
+		for (int i = 0; i < 10; i++)
+		{
+			std::string dir = root + "/dir" + std::to_string(i);
+			flycast::mkdir(dir.c_str(), 0755);
+			for (int j = 0; j < 10; j++)
+			{
+				std::string subdir = dir + "/sub" + std::to_string(j);
+				flycast::mkdir(subdir.c_str(), 0755);
+				for (int k = 0; k < 100; k++)
+				{
+					std::string name = subdir + "/file" + std::to_string(k);
+					if (k % 10 == 0)
+						name += ".cdi";
+					else if (k == 55)
+						name = subdir + "/" + Games[0].name + ".zip";
+					else
+						name += ".txt";
+					files.push_back(name);
+					touch(name);
+				}
+				dirs.push_back(subdir);
+			}
+			dirs.push_back(dir);
+		}
+		dirs.push_back(root);
+		// make the directories look older than the current second
+		for (const auto& dir : dirs)
+			setOld(dir);
+		config::ContentPath.get() = { root };
+		scanner.setIndexPath(root + ".idx");
+	}
+
+	void TearDown() override
+	{
+		scanner.stop();
+		for (const auto& file : files)
+			std::remove(file.c_str());
+		for (const auto& dir : dirs)
+			rmdir(dir.c_str());
+		std::remove((root + ".idx").c_str());
+		config::ContentPath.get().clear();
+	}
+
+	static void touch(const std::string& path)
+	{
+		FILE *f = fopen(path.c_str(), "w");
+		ASSERT_NE(nullptr, f);
+		fclose(f);
+	}
+
+	static void setOld(const std::string& path)
+	{
+		utimbuf times;
+		times.actime = times.modtime = time(nullptr) - 60;
+		utime(path.c_str(), &times);
+	}
+
+	double scan()
+	{
+		auto start = std::chrono::steady_clock::now();
+		scanner.refresh();
+		scanner.fetch_game_list();
+		scanner.wait();
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	const std::string root = "gamescanner_test";
+	std::vector<std::string> dirs;
+	std::vector<std::string> files;
+	GameScanner scanner;
+};
+
+TEST_F(GameScannerTest, ScanTree)
+{
+	scan();
+	ASSERT_EQ(1100u, scanner.get_game_list().size());
+	const GameMedia& first = scanner.get_game_list().front();
+	ASSERT_EQ("file0.cdi", first.name);
+	const GameMedia& last = scanner.get_game_list().back();
+	ASSERT_EQ(std::string(Games[0].name) + ".zip", last.fileName);
+
+	// from the index
+	scan();
+	ASSERT_EQ(1100u, scanner.get_game_list().size());
+
+	// new file in an indexed directory
+	files.push_back(root + "/dir3/sub7/new.gdi");
+	touch(files.back());
+	scan();
+	ASSERT_EQ(1101u, scanner.get_game_list().size());
+	ASSERT_EQ("new.gdi", scanner.get_game_list()[1000].fileName);
+}
+
+TEST_F(GameScannerTest, IndexedFilesAreFiltered)
+{
+	files.push_back(root + "/dir1/sub1/legacy.bin");
+	touch(files.back());
+	setOld(root + "/dir1/sub1");
+	const bool hideLegacy = config::HideLegacyNaomiRoms;
+	config::HideLegacyNaomiRoms = true;
+	scan();
+	ASSERT_EQ(1100u, scanner.get_game_list().size());
+
+	// the directory is unchanged but the filter is applied again
+	config::HideLegacyNaomiRoms = false;
+	scan();
+	config::HideLegacyNaomiRoms = hideLegacy;
+	ASSERT_EQ(1101u, scanner.get_game_list().size());
+}
+
+// Benchmark, run with --gtest_also_run_disabled_tests
+TEST_F(GameScannerTest, DISABLED_Benchmark)
+{
+	double coldTime = scan();
+	double warmTime = scan();
+	printf("Scanned %d files: %.1f ms without index, %.1f ms with index\n", (int)files.size(), coldTime, warmTime);
+}
@@ -0,0 +1,208 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "gtest/gtest.h"
+#include "log/LogQueue.h"
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+class LogQueueTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		queue = std::make_unique<LogQueue>();
+	}
+
+	bool push(const char *format, ...)
+#if defined(__GNUC__) && !defined(__MINGW32__)
+	__attribute__((format(printf, 2, 3)))
+#endif
+	{
+		va_list args;
+		va_start(args, format);
+		bool rc = queue->push(LogTypes::LINFO, LogTypes::COMMON, __FILE__, __LINE__, 0.0, format, args);
+		va_end(args);
+		return rc;
+	}
+
+	std::string pop()
+	{
+		LogQueue::Record record;
+		if (!queue->pop(record))
+			return "<empty>";
+		char buf[1024];
+		record.formatMessage(buf, sizeof(buf));
+		return buf;
+	}
+
+	// Formats with the queue and with snprintf
+	template<typename... Args>
+	void compare(const char *format, Args... args)
+	{
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+#pragma GCC diagnostic ignored "-Wformat-security"
+#endif
+		char expected[1024];
+		snprintf(expected, sizeof(expected), format, args...);
+		ASSERT_TRUE(push(format, args...));
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+		ASSERT_EQ(std::string(expected), pop()) << format;
+	}
+
+	std::unique_ptr<LogQueue> queue;
+};
+
+TEST_F(LogQueueTest, Integers)
+{
+	compare("%d %i %u %x %X %o", -1, 42, 3000000000u, 0xbeef, 0xcafe, 8);
+	compare("[%08X] [%-5d] [%+d] [% d] [%#x]", 0x1234, 7, 5, 6, 255);
+	compare("%hhd %hd %ld %lu %lld %llu", 200, 70000, -5L, 6UL, -(1LL << 40), 1ULL << 63);
+	compare("%zu %zd %jd %td", (size_t)123456789, (ssize_t)-3, (intmax_t)-9, (ptrdiff_t)12);
+	compare("%c%c%c", 'a', 'b', 'c');
+	compare("%*d|%-*d|", 6, 42, 4, 1);
+}
+
+TEST_F(LogQueueTest, FloatsAndPointers)
+{
+	compare("%f %.3f %e %g %10.2f", 1.5, 3.14159, 1e-10, 0.0001, -2.5);
+	compare("%.*f %Lf", 2, 2.71828, 1.25L);
+	compare("%p %p", (void *)this, (void *)nullptr);
+}
+
+TEST_F(LogQueueTest, Strings)
+{
+	compare("%s", "hello");
+	compare("[%10s] [%-10s] [%.2s]", "right", "left", "truncated");
+	compare("100%% %s %d%%", "done", 50);
+	compare("no arguments");
+	std::string temp = "temporary";
+	ASSERT_TRUE(push("%s", temp.c_str()));
+	// the string is copied
+	temp = "overwritten";
+	ASSERT_EQ("temporary", pop());
+}
+
+TEST_F(LogQueueTest, StringPrecision)
+{
+	// strings with a precision don't need to be null-terminated
+	const char unterminated[4] = { 'a', 'b', 'c', 'd' };
+	ASSERT_TRUE(push("[%.4s]", unterminated));
+	ASSERT_EQ("[abcd]", pop());
+	ASSERT_TRUE(push("[%.*s]", 3, unterminated));
+	ASSERT_EQ("[abc]", pop());
+	compare("[%.0s] [%8.3s] [%.20s]", "empty", "truncated", "short");
+	// only the printed part is captured
+	std::string big(LogQueue::MaxArgSize * 2, 'x');
+	ASSERT_TRUE(push("%.10s", big.c_str()));
+	ASSERT_EQ(big.substr(0, 10), pop());
+}
+
+TEST_F(LogQueueTest, Preformatted)
+{
+	// arguments too large to be captured
+	std::string big(LogQueue::MaxArgSize * 2, 'x');
+	ASSERT_TRUE(push("%s!", big.c_str()));
+	ASSERT_EQ(big + "!", pop());
+	// truncated to the maximum message size
+	std::string huge(LogQueue::MaxMessageSize * 2, 'y');
+	ASSERT_TRUE(push("%s", huge.c_str()));
+	ASSERT_EQ(huge.substr(0, LogQueue::MaxMessageSize - 1), pop());
+}
+
+TEST_F(LogQueueTest, Full)
+{
+	ASSERT_EQ("<empty>", pop());
+	for (size_t i = 0; i < LogQueue::Capacity; i++)
+		ASSERT_TRUE(push("%d", (int)i));
+	ASSERT_FALSE(push("dropped"));
+	ASSERT_EQ(1u, queue->takeDropped());
+	ASSERT_EQ(0u, queue->takeDropped());
+	for (size_t i = 0; i < LogQueue::Capacity; i++)
+		ASSERT_EQ(std::to_string(i), pop());
+	ASSERT_EQ("<empty>", pop());
+	ASSERT_TRUE(push("again"));
+	ASSERT_EQ("again", pop());
+}
+
+TEST_F(LogQueueTest, MultipleProducers)
+{
+	constexpr int Threads = 4;
+	constexpr int PerThread = 20000;
+	std::vector<std::thread> threads;
+	for (int t = 0; t < Threads; t++)
+		threads.emplace_back([this, t]() {
+			for (int i = 0; i < PerThread; i++)
+				while (!push("%d %d", t, i))
+					std::this_thread::yield();
+		});
+	std::vector<int> next(Threads);
+	int received = 0;
+	LogQueue::Record record;
+	char buf[64];
+	while (received < Threads * PerThread)
+	{
+		if (!queue->pop(record))
+			continue;
+		record.formatMessage(buf, sizeof(buf));
+		int t, i;
+		ASSERT_EQ(2, sscanf(buf, "%d %d", &t, &i));
+		// messages from the same thread are in order
+		ASSERT_EQ(next[t], i);
+		next[t]++;
+		received++;
+	}
+	for (auto& thread : threads)
+		thread.join();
+	ASSERT_EQ("<empty>", pop());
+}
+
+TEST_F(LogQueueTest, Cost)
+{
+	using clock = std::chrono::steady_clock;
+	constexpr int Rounds = 200;
+	clock::duration pushTime{};
+	clock::duration formatTime{};
+	LogQueue::Record record;
+	char buf[1024];
+	for (int round = 0; round < Rounds; round++)
+	{
+		auto start = clock::now();
+		for (size_t i = 0; i < LogQueue::Capacity; i++)
+			push("%s:%d value %08x %f", "PVR", (int)i, 0xdeadbeef, 1.5);
+		pushTime += clock::now() - start;
+
+		start = clock::now();
+		for (size_t i = 0; i < LogQueue::Capacity; i++)
+			snprintf(buf, sizeof(buf), "%s:%d value %08x %f", "PVR", (int)i, 0xdeadbeef, 1.5);
+		formatTime += clock::now() - start;
+
+		while (queue->pop(record))
+			;
+	}
+	const double calls = Rounds * LogQueue::Capacity;
+	printf("LogQueue::push: %.1f ns/call, snprintf: %.1f ns/call\n",
+			std::chrono::duration<double, std::nano>(pushTime).count() / calls,
+			std::chrono::duration<double, std::nano>(formatTime).count() / calls);
+}
@@ -0,0 +1,112 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "gtest/gtest.h"
+#include "types.h"
+#include "hw/mem/addrspace.h"
+#include "emulator.h"
+#include <chrono>
+
+// Compares the throughput of register accesses going through the handler tables
+// with the region functions returned by readConst/writeConst
+class MmioBenchmark : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		if (!addrspace::reserve())
+			die("addrspace::reserve failed");
+		emu.init();
+		dc_reset(true);
+	}
+
+	static addrspace::ReadMem32FP *readHandler(u32 addr)
+	{
+		bool isMem;
+		void *p = addrspace::readConst(addr, isMem, 4);
+		EXPECT_FALSE(isMem);
+		return (addrspace::ReadMem32FP *)p;
+	}
+
+	static addrspace::WriteMem32FP *writeHandler(u32 addr)
+	{
+		bool isMem;
+		void *p = addrspace::writeConst(addr, isMem, 4);
+		EXPECT_FALSE(isMem);
+		return (addrspace::WriteMem32FP *)p;
+	}
+
+	template<typename F>
+	static double nsPerAccess(F f)
+	{
+		auto start = std::chrono::steady_clock::now();
+		for (u32 i = 0; i < Iterations; i++)
+			f();
+		auto end = std::chrono::steady_clock::now();
+		return std::chrono::duration<double, std::nano>(end - start).count() / Iterations;
+	}
+
+	void readBenchmark(const char *name, u32 addr)
+	{
+		addrspace::ReadMem32FP *read = readHandler(addr);
+		ASSERT_EQ(addrspace::read32(addr), read(addr)) << name;
+		u32 sum = 0;
+		double generic = nsPerAccess([&]() { sum += addrspace::read32(addr); });
+		double direct = nsPerAccess([&]() { sum += read(addr); });
+		printf("%-12s read  generic %5.2f ns  direct %5.2f ns  (%x)\n", name, generic, direct, sum);
+	}
+
+	static constexpr u32 Iterations = 10000000;
+};
+
+// Benchmark, run with --gtest_also_run_disabled_tests
+TEST_F(MmioBenchmark, DISABLED_Read)
+{
+	readBenchmark("SB_ISTNRM", 0xA05F6900);
+	readBenchmark("SB_G2ID", 0xA05F7880);
+	readBenchmark("SPG_STATUS", 0xA05F810C);
+	readBenchmark("AICA", 0xA0700000);
+	readBenchmark("TMU_TCOR0", 0xFFD80008);
+	readBenchmark("INTC_IPRA", 0xFFD00004);
+	readBenchmark("DMAC_DMAOR", 0xFFA00040);
+}
+
+// Benchmark, run with --gtest_also_run_disabled_tests
+TEST_F(MmioBenchmark, DISABLED_Write)
+{
+	const u32 addr = 0xFFD80008;	// TMU_TCOR0
+	addrspace::WriteMem32FP *write = writeHandler(addr);
+	write(addr, 0x12345678);
+	ASSERT_EQ(0x12345678u, addrspace::read32(addr));
+	double generic = nsPerAccess([&]() { addrspace::write32(addr, 0xffffffff); });
+	double direct = nsPerAccess([&]() { write(addr, 0xffffffff); });
+	printf("%-12s write generic %5.2f ns  direct %5.2f ns\n", "TMU_TCOR0", generic, direct);
+	ASSERT_EQ(0xffffffffu, addrspace::read32(addr));
+}
+
+// Benchmark, run with --gtest_also_run_disabled_tests
+TEST_F(MmioBenchmark, DISABLED_Fallback)
+{
+	// PVR registers have no 8-bit region function
+	bool isMem;
+	void *generic = addrspace::readConst(0xA05F8000, isMem, 1);
+	ASSERT_EQ(generic, addrspace::readConst(0xA0400000, isMem, 1));
+	ASSERT_NE((void *)readHandler(0xA05F8000), addrspace::readConst(0xA0400000, isMem, 4));
+	// RAM is still returned as memory
+	addrspace::readConst(0x8C000000, isMem, 4);
+	ASSERT_TRUE(isMem);
+}
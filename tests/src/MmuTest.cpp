@@ -22,6 +22,7 @@
 #include "emulator.h"
 #include "hw/sh4/modules/mmu.h"
 #include "hw/sh4/sh4_core.h"
+#include "oslib/oslib.h"
 
 class MmuTest : public ::testing::Test {
 protected:
@@ -234,3 +235,106 @@ TEST_F(MmuTest, TestErrors)
 	ASSERT_EQ(MmuError::FIRSTWRITE, err);
 #endif
 }
+
+TEST_F(MmuTest, TestCacheInvalidation)
+{
+	u32 pa;
+	UTLB[0].Address.VPN = 0x02000000 >> 10;
+	UTLB[0].Data.SZ1 = 1;	// 64 KB
+	UTLB[0].Data.V = 1;
+	UTLB[0].Data.PR = 3;
+	UTLB[0].Data.D = 1;
+	UTLB[0].Data.PPN = 0x0C000000 >> 10;
+	UTLB_Sync(0);
+	MmuError err = mmu_data_translation<MMU_TT_DREAD>(0x0200F044, pa);
+	ASSERT_EQ(MmuError::NONE, err);
+	ASSERT_EQ(0x0C00F044u, pa);
+
+	// entry replaced
+	UTLB[0].Data.PPN = 0x0C100000 >> 10;
+	UTLB_Sync(0);
+	err = mmu_data_translation<MMU_TT_DREAD>(0x0200F048, pa);
+	ASSERT_EQ(MmuError::NONE, err);
+	ASSERT_EQ(0x0C10F048u, pa);
+
+	// other ASID
+	UTLB[1].Address.VPN = 0x02000000 >> 10;
+	UTLB[1].Address.ASID = 1;
+	UTLB[1].Data.SZ1 = 1;
+	UTLB[1].Data.V = 1;
+	UTLB[1].Data.PR = 3;
+	UTLB[1].Data.D = 1;
+	UTLB[1].Data.PPN = 0x0C200000 >> 10;
+	UTLB_Sync(1);
+	CCN_PTEH.ASID = 1;
+	err = mmu_data_translation<MMU_TT_DREAD>(0x0200F04C, pa);
+	ASSERT_EQ(MmuError::NONE, err);
+	ASSERT_EQ(0x0C20F04Cu, pa);
+	CCN_PTEH.ASID = 0;
+	err = mmu_data_translation<MMU_TT_DREAD>(0x0200F04C, pa);
+	ASSERT_EQ(MmuError::NONE, err);
+	ASSERT_EQ(0x0C10F04Cu, pa);
+
+	// slot reused for another page
+	UTLB[2].Address.VPN = 0x03000000 >> 10;
+	UTLB[2].Data.SZ0 = 1;
+	UTLB[2].Data.V = 1;
+	UTLB[2].Data.PR = 3;
+	UTLB[2].Data.D = 1;
+	UTLB[2].Data.PPN = 0x0C300000 >> 10;
+	UTLB_Sync(2);
+	err = mmu_data_translation<MMU_TT_DREAD>(0x03000010, pa);
+	ASSERT_EQ(MmuError::NONE, err);
+	UTLB[2].Address.VPN = 0x03100000 >> 10;
+	UTLB[2].Data.PR = 0;
+	UTLB[2].Data.PPN = 0x0C400000 >> 10;
+	UTLB_Sync(2);
+	const TLB_Entry *entry;
+	err = mmu_full_lookup(0x03000010, &entry, pa);
+	// The old translation may still be found but not with the new entry
+	if (err == MmuError::NONE)
+	{
+		ASSERT_EQ(0x0C300010u, pa);
+		ASSERT_EQ(3u, entry->Data.PR);
+	}
+
+	// full flush
+	mmu_flush_table();
+	err = mmu_data_translation<MMU_TT_DREAD>(0x0200F04C, pa);
+	ASSERT_EQ(MmuError::TLB_MISS, err);
+}
+
+// Benchmark, run with --gtest_also_run_disabled_tests
+TEST_F(MmuTest, DISABLED_TestLookupPerformance)
+{
+	// 64 4 KB pages in 2 address spaces
+	for (u32 i = 0; i < 64; i++)
+	{
+		UTLB[i].Address.VPN = (0x00400000 + (i & 31) * 4_KB) >> 10;
+		UTLB[i].Address.ASID = i / 32;
+		UTLB[i].Data.SZ0 = 1;
+		UTLB[i].Data.V = 1;
+		UTLB[i].Data.PR = 3;
+		UTLB[i].Data.D = 1;
+		UTLB[i].Data.PPN = (0x0C000000 + i * 4_KB) >> 10;
+		UTLB_Sync(i);
+	}
+	constexpr int loops = 100000;
+	u32 sum = 0;
+	double start = os_GetSeconds();
+	for (int loop = 0; loop < loops; loop++)
+	{
+		// context switch
+		CCN_PTEH.ASID = (loop / 1000) & 1;
+		for (u32 page = 0; page < 32; page++)
+		{
+			u32 pa;
+			MmuError err = mmu_data_translation<MMU_TT_DREAD>(0x00400000 + page * 4_KB + (loop & 0xffc), pa);
+			ASSERT_EQ(MmuError::NONE, err);
+			sum += pa;
+		}
+	}
+	double duration = os_GetSeconds() - start;
+	std::cout << "MMU lookup: " << duration * 1e9 / loops / 32 << " ns" << std::endl;
+	ASSERT_NE(0u, sum);
+}
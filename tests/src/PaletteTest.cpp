@@ -0,0 +1,101 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "gtest/gtest.h"
+#include "types.h"
+#include "hw/pvr/pvr_mem.h"
+#include "hw/pvr/pvr_regs.h"
+#include "rend/TexCache.h"
+#include <array>
+
+class PaletteTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		for (u32 i = 0; i < 1024; i++)
+			PALETTE_RAM[i] = i * 0x9E3779B1u;
+		PAL_RAM_CTRL = 0;
+		forcePaletteUpdate();
+		palette_update();
+	}
+
+	struct State
+	{
+		State() {
+			std::copy(std::begin(pal_hash_16), std::end(pal_hash_16), hash16.begin());
+			std::copy(std::begin(pal_hash_256), std::end(pal_hash_256), hash256.begin());
+			std::copy(std::begin(palette32_ram), std::end(palette32_ram), pal32.begin());
+			std::copy(std::begin(palette16_ram), std::end(palette16_ram), pal16.begin());
+		}
+		bool operator==(const State& other) const {
+			return hash16 == other.hash16 && hash256 == other.hash256
+					&& pal32 == other.pal32 && pal16 == other.pal16;
+		}
+
+		std::array<u32, 64> hash16;
+		std::array<u32, 4> hash256;
+		std::array<u32, 1024> pal32;
+		std::array<u32, 1024> pal16;
+	};
+};
+
+TEST_F(PaletteTest, BankUpdate)
+{
+	State before;
+	pvr_WriteReg(PALETTE_RAM_START_addr + 37 * 4, 0x8000ffff);
+	palette_update();
+	State after;
+
+	for (u32 i = 0; i < 64; i++)
+	{
+		if (i == 37 / 16)
+			ASSERT_NE(before.hash16[i], after.hash16[i]);
+		else
+			ASSERT_EQ(before.hash16[i], after.hash16[i]) << "bank " << i;
+	}
+	ASSERT_NE(before.hash256[0], after.hash256[0]);
+	for (u32 i = 1; i < 4; i++)
+		ASSERT_EQ(before.hash256[i], after.hash256[i]);
+	for (u32 i = 0; i < 1024; i++)
+		if (i != 37)
+			ASSERT_EQ(before.pal32[i], after.pal32[i]) << "entry " << i;
+	ASSERT_EQ(Unpacker1555_32<RGBAPacker>::unpack(0xffff), after.pal32[37]);
+
+	// Same result as a full update
+	forcePaletteUpdate();
+	palette_update();
+	ASSERT_TRUE(after == State());
+}
+
+TEST_F(PaletteTest, FormatChange)
+{
+	pvr_WriteReg(PAL_RAM_CTRL_addr, 1);
+	palette_update();
+	for (u32 i = 0; i < 1024; i++)
+		ASSERT_EQ(Unpacker565_32<RGBAPacker>::unpack(PALETTE_RAM[i]), palette32_ram[i]) << "entry " << i;
+}
+
+TEST_F(PaletteTest, UnchangedWrite)
+{
+	State before;
+	pvr_WriteReg(PALETTE_RAM_START_addr + 100 * 4, PALETTE_RAM[100]);
+	palette_updated = false;
+	palette_update();
+	ASSERT_FALSE(palette_updated);
+	ASSERT_TRUE(before == State());
+}
@@ -0,0 +1,110 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "gtest/gtest.h"
+#include "types.h"
+#include "emulator.h"
+#include "hw/mem/addrspace.h"
+#include "rend/TexCache.h"
+
+class TestTexture final : public BaseTextureCacheData
+{
+public:
+	TestTexture(TSP tsp, TCW tcw) : BaseTextureCacheData(tsp, tcw) {}
+
+	std::string GetId() override { return "test"; }
+	void UploadToGPU(int width, int height, const u8 *temp_tex_buffer, bool mipmapped, bool mipmapsIncluded = false) override {}
+};
+
+class TestTextureCache final : public BaseTextureCache<TestTexture>
+{
+public:
+	bool erase(u64 id)
+	{
+		auto deleteTexture = [](TestTexture *texture) { return texture->Delete(); };
+		return BaseTextureCache::erase(id, deleteTexture);
+	}
+};
+
+class TextureMemoTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		if (!addrspace::reserve())
+			die("addrspace::reserve failed");
+		emu.init();
+
+		tcw.TexAddr = 0x10000 >> 3;
+		tcw.PixelFmt = Pixel565;
+		tsp.TexU = 3;
+		tsp.TexV = 3;
+		texture = cache.getTextureCacheData(tsp, tcw);
+		texture->protectVRam();
+		cache.memoizeTexture(tsp, tcw, texture);
+		ASSERT_EQ(texture, cache.getMemoizedTexture(tsp, tcw));
+	}
+	void TearDown() override
+	{
+		cache.Clear();
+	}
+
+	TSP tsp{};
+	TCW tcw{};
+	TestTextureCache cache;
+	TestTexture *texture = nullptr;
+};
+
+TEST_F(TextureMemoTest, OtherTexture)
+{
+	TCW other = tcw;
+	other.TexAddr += 0x1000 >> 3;
+	ASSERT_EQ(nullptr, cache.getMemoizedTexture(tsp, other));
+	ASSERT_EQ(texture, cache.getMemoizedTexture(tsp, tcw));
+}
+
+TEST_F(TextureMemoTest, Invalidate)
+{
+	texture->invalidate();
+	ASSERT_EQ(nullptr, cache.getMemoizedTexture(tsp, tcw));
+}
+
+TEST_F(TextureMemoTest, VramWrite)
+{
+	// The texture is invalidated by the lookup
+	VramLockedWriteOffset(0x10000);
+	ASSERT_EQ(nullptr, cache.getMemoizedTexture(tsp, tcw));
+}
+
+TEST_F(TextureMemoTest, PaletteUpdate)
+{
+	forcePaletteUpdate();
+	palette_update();
+	ASSERT_EQ(nullptr, cache.getMemoizedTexture(tsp, tcw));
+}
+
+TEST_F(TextureMemoTest, Erase)
+{
+	ASSERT_TRUE(cache.erase(texture->cacheKey));
+	ASSERT_EQ(nullptr, cache.getMemoizedTexture(tsp, tcw));
+}
+
+TEST_F(TextureMemoTest, NewFrame)
+{
+	cache.CollectCleanup();
+	ASSERT_EQ(nullptr, cache.getMemoizedTexture(tsp, tcw));
+}
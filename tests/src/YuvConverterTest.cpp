@@ -0,0 +1,61 @@
+/*
+	Copyright 2026 flyinghead
+
+	This file is part of Flycast.
+
+    Flycast is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 2 of the License, or
+    (at your option) any later version.
+
+    Flycast is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with Flycast.  If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "gtest/gtest.h"
+#include "types.h"
+#include "hw/pvr/pvr_mem.h"
+#include <random>
+
+TEST(YuvConverterTest, MacroBlock)
+{
+	std::mt19937 gen(42);
+	std::uniform_int_distribution<int> dist(0, 255);
+	u8 block[384];
+	for (u32 stride : { 32, 64, 640 * 2, 1024 * 2 })
+	{
+		for (int i = 0; i < 8; i++)
+		{
+			for (u8& b : block)
+				b = dist(gen);
+			std::vector<u8> ref(stride * 16, 0xcd);
+			std::vector<u8> out(stride * 16, 0xcd);
+			YUV_Block384Scalar(block, ref.data(), stride);
+			YUV_Block384(block, out.data(), stride);
+			ASSERT_EQ(ref, out) << "stride " << stride;
+		}
+	}
+}
+
+TEST(YuvConverterTest, Layout)
+{
+	u8 block[384];
+	for (int i = 0; i < 384; i++)
+		block[i] = i;
+	u8 out[32 * 16];
+	YUV_Block384(block, out, 32);
+	// first texel pair: U0 Y0 V0 Y1
+	ASSERT_EQ(0, out[0]);
+	ASSERT_EQ(128, out[1]);
+	ASSERT_EQ(64, out[2]);
+	ASSERT_EQ(129, out[3]);
+	// last texel pair of the last line: bottom right luma block
+	ASSERT_EQ(63, out[32 * 15 + 28]);
+	ASSERT_EQ((u8)(128 + 192 + 62), out[32 * 15 + 29]);
+	ASSERT_EQ(127, out[32 * 15 + 30]);
+	ASSERT_EQ((u8)(128 + 192 + 63), out[32 * 15 + 31]);
+}